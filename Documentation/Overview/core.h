@@ -64,6 +64,9 @@
 
 	<ul>
 		<li>uicore::JsonValue - JSON parse and stringify</li>
+		<li>uicore::JsonDocument, uicore::JsonView - Compact read-only JSON document for large inputs</li>
+		<li>uicore::JsonReader - Streaming pull parser for JSON</li>
+		<li>uicore::JsonWriter - Writes JSON to memory or an output stream</li>
 	</ul>
 		
 	<h2>I/O devices</h2>
@@ -72,6 +75,8 @@
 		<li>uicore::IODevice - Input/Output stream abstraction</li>
 		<li>uicore::File - Class for opening files</li>
 		<li>uicore::MemoryDevice - IODevice for memory buffers</li>
+		<li>uicore::BufferedIODevice - Read-ahead and write-behind buffering for another IODevice</li>
+		<li>uicore::MappedFile - Read-only IODevice for memory mapped files</li>
 	</ul>
 		
 	<h2>File systems</h2>
@@ -86,6 +91,9 @@
 
 	<ul>
 		<li>uicore::ZLibCompression - Deflate algorithm compressor / decompressor</li>
+		<li>uicore::DeflateWriter - Streaming deflate compressor</li>
+		<li>uicore::InflateReader - Streaming deflate decompressor</li>
+		<li>uicore::ZipArchive - Indexed read-only access to zip archives</li>
 	</ul>
 		
 	<h2>Crypto</h2>
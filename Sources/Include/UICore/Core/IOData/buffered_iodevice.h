@@ -0,0 +1,53 @@
+/*
+**  UICore
+**  Copyright (c) 1997-2015 The UICore Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries UICore may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+#pragma once
+
+#include "iodevice.h"
+
+namespace uicore
+{
+	/// \brief Adds read-ahead and write-behind buffering to another IODevice.
+	///
+	/// Small reads, such as the read_uint32 family, are served from the read buffer instead of calling into the
+	/// underlying device every time. Writes are collected until the write buffer is full, flush() is called or the
+	/// device is closed. Transfers larger than the buffers bypass them.
+	class BufferedIODevice : public IODevice
+	{
+	public:
+		static std::shared_ptr<BufferedIODevice> create(const IODevicePtr &device, int read_buffer_size = 64 * 1024, int write_buffer_size = 64 * 1024);
+
+		/// \brief The device being buffered
+		virtual const IODevicePtr &device() const = 0;
+
+		/// \brief Writes any buffered data to the underlying device
+		virtual void flush() = 0;
+	};
+
+	typedef std::shared_ptr<BufferedIODevice> BufferedIODevicePtr;
+}
@@ -46,10 +46,16 @@ namespace uicore
 		virtual long long seek_from_current(long long offset) = 0;
 		virtual long long seek_from_end(long long offset) = 0;
 
+		/// \brief Reads up to size bytes. Returns the number of bytes read, which is only less than size at the end of the device.
 		virtual int try_read(void *data, int size) = 0;
-		void read(void *data, int size) { int bytes = try_read(data, size); if (bytes != size) throw Exception("Could not read all bytes"); }
 		virtual void write(const void *data, int size) = 0;
 
+		/// \brief Transfers that may be larger than 2 GB. The default implementations split them into try_read and write calls.
+		virtual long long try_read_64(void *data, long long size);
+		virtual void write_64(const void *data, long long size);
+
+		void read(void *data, long long size) { long long bytes = try_read_64(data, size); if (bytes != size) throw Exception("Could not read all bytes"); }
+
 		virtual void close() { }
 
 		bool is_big_endian_mode() const { return swap_bytes; }
@@ -82,5 +88,30 @@ namespace uicore
 		bool swap_bytes = false;
 	};
 
+	inline long long IODevice::try_read_64(void *data, long long size)
+	{
+		long long pos = 0;
+		while (pos < size)
+		{
+			int amount = (int)(size - pos < 0x40000000LL ? size - pos : 0x40000000LL);
+			int bytes = try_read(static_cast<char*>(data) + pos, amount);
+			pos += bytes;
+			if (bytes != amount)
+				break;
+		}
+		return pos;
+	}
+
+	inline void IODevice::write_64(const void *data, long long size)
+	{
+		long long pos = 0;
+		while (pos < size)
+		{
+			int amount = (int)(size - pos < 0x40000000LL ? size - pos : 0x40000000LL);
+			write(static_cast<const char*>(data) + pos, amount);
+			pos += amount;
+		}
+	}
+
 	typedef std::shared_ptr<IODevice> IODevicePtr;
 }
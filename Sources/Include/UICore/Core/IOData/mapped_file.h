@@ -0,0 +1,73 @@
+/*
+**  UICore
+**  Copyright (c) 1997-2015 The UICore Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries UICore may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+#pragma once
+
+#include <string>
+#include <memory>
+#include "iodevice.h"
+#include "../System/databuffer.h"
+
+namespace uicore
+{
+	/// \brief Access pattern hint for a memory mapped file
+	enum class MappedFileUsage
+	{
+		normal,
+		sequential,
+		random
+	};
+
+	/// \brief Read-only IODevice for a file mapped into memory
+	///
+	/// Reads are plain memory copies from a read-only mapping. The buffer and view functions return DataBuffer objects
+	/// with their own copy-on-write mapping of the range, or a plain copy for small ranges. Writing to such a buffer
+	/// changes neither the file nor any other buffer, and growing it beyond its original size moves it into a normal
+	/// heap allocation.
+	class MappedFile : public IODevice
+	{
+	public:
+		static std::shared_ptr<MappedFile> open(const std::string &filename, MappedFileUsage usage = MappedFileUsage::normal);
+
+		/// \brief Pointer to the start of the mapping
+		virtual const char *data() const = 0;
+
+		/// \brief DataBuffer referencing the entire file
+		virtual DataBufferPtr buffer() = 0;
+
+		/// \brief DataBuffer referencing part of the file
+		virtual DataBufferPtr view(long long offset, long long size) = 0;
+
+		/// \brief Tells the operating system how the mapping is going to be accessed (madvise)
+		///
+		/// Applies to data(), reads, and buffers or views created after the call.
+		virtual void set_usage(MappedFileUsage usage) = 0;
+	};
+
+	typedef std::shared_ptr<MappedFile> MappedFilePtr;
+}
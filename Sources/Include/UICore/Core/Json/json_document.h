@@ -0,0 +1,199 @@
+/*
+**  UICore
+**  Copyright (c) 1997-2015 The UICore Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries UICore may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+#pragma once
+
+#include "json_value.h"
+#include "../System/exception.h"
+#include <memory>
+#include <string>
+#include <cstring>
+#include <cstdint>
+
+namespace uicore
+{
+	class JsonDocumentProperty;
+
+	/// \brief Compact JSON node stored in the memory arena of a JsonDocument.
+	class JsonDocumentNode
+	{
+	public:
+		JsonType type;
+
+		/// \brief String length, array item count or object property count.
+		uint32_t count;
+
+		union
+		{
+			double number;
+			bool boolean;
+			const char *string;
+			const JsonDocumentNode *items;
+			const JsonDocumentProperty *properties;
+		};
+	};
+
+	/// \brief Object property stored in a JsonDocument. Properties of an object are sorted by name.
+	class JsonDocumentProperty
+	{
+	public:
+		const char *name;
+		uint32_t name_length;
+		JsonDocumentNode value;
+	};
+
+	class JsonView;
+
+	/// \brief Property name/value pair of an object in a JsonDocument.
+	class JsonViewProperty
+	{
+	public:
+		JsonViewProperty(const JsonDocumentProperty *property) : property(property) { }
+
+		std::string name() const { return std::string(property->name, property->name_length); }
+		const char *name_data() const { return property->name; }
+		size_t name_length() const { return property->name_length; }
+		JsonView value() const;
+
+	private:
+		const JsonDocumentProperty *property;
+	};
+
+	/// \brief Iterator range over the items or properties of a JsonView.
+	template<typename StorageType, typename ValueType>
+	class JsonViewRange
+	{
+	public:
+		class iterator
+		{
+		public:
+			iterator(const StorageType *pos) : pos(pos) { }
+			ValueType operator*() const { return ValueType(pos); }
+			iterator &operator++() { pos++; return *this; }
+			bool operator==(const iterator &other) const { return pos == other.pos; }
+			bool operator!=(const iterator &other) const { return pos != other.pos; }
+
+		private:
+			const StorageType *pos;
+		};
+
+		JsonViewRange(const StorageType *data, size_t count) : data(data), count(count) { }
+
+		iterator begin() const { return iterator(data); }
+		iterator end() const { return iterator(data + count); }
+		size_t size() const { return count; }
+		bool empty() const { return count == 0; }
+
+	private:
+		const StorageType *data;
+		size_t count;
+	};
+
+	typedef JsonViewRange<JsonDocumentNode, JsonView> JsonViewItems;
+	typedef JsonViewRange<JsonDocumentProperty, JsonViewProperty> JsonViewProperties;
+
+	/// \brief Read-only view of a node in a JsonDocument.
+	///
+	/// A view does not keep the document alive. It is only valid as long as the JsonDocument it came from.
+	class JsonView
+	{
+	public:
+		JsonView() { }
+		JsonView(const JsonDocumentNode *node) : node(node) { }
+
+		JsonType type() const { return node ? node->type : JsonType::undefined; }
+		bool is_undefined() const { return type() == JsonType::undefined; }
+		bool is_null() const { return type() == JsonType::null; }
+		bool is_object() const { return type() == JsonType::object; }
+		bool is_array() const { return type() == JsonType::array; }
+		bool is_number() const { return type() == JsonType::number; }
+		bool is_boolean() const { return type() == JsonType::boolean; }
+		bool is_string() const { return type() == JsonType::string; }
+
+		/// \brief Finds a property by name using a binary search. Returns an undefined view if not found.
+		JsonView prop(const char *name, size_t length) const;
+		JsonView prop(const std::string &name) const { return prop(name.data(), name.length()); }
+		JsonView prop(const char *name) const { return prop(name, strlen(name)); }
+
+		size_t size() const { return is_array() ? node->count : 0; }
+		JsonView at(size_t index) const { if (index >= size()) throw Exception("JSON array index out of bounds"); return JsonView(node->items + index); }
+
+		JsonViewItems items() const { return is_array() ? JsonViewItems(node->items, node->count) : JsonViewItems(nullptr, 0); }
+		JsonViewProperties properties() const { return is_object() ? JsonViewProperties(node->properties, node->count) : JsonViewProperties(nullptr, 0); }
+
+		double to_number() const { return is_number() ? node->number : 0.0; }
+		bool to_boolean() const { return is_boolean() ? node->boolean : false; }
+		std::string to_string() const { return is_string() ? std::string(node->string, node->count) : std::string(); }
+
+		/// \brief Returns the null terminated string data without copying it.
+		const char *string_data() const { return is_string() ? node->string : ""; }
+		size_t string_length() const { return is_string() ? node->count : 0; }
+
+		double to_double() const { return to_number(); }
+		float to_float() const { return static_cast<float>(to_number()); }
+		int to_int() const { return static_cast<int>(to_number()); }
+		unsigned int to_uint() const { return static_cast<unsigned int>(to_number()); }
+		short to_short() const { return static_cast<short>(to_number()); }
+		unsigned short to_ushort() const { return static_cast<unsigned short>(to_number()); }
+		char to_char() const { return static_cast<char>(to_number()); }
+		unsigned char to_uchar() const { return static_cast<unsigned char>(to_number()); }
+
+		/// \brief Creates a mutable JsonValue copy of this node and all its children.
+		JsonValue to_value() const;
+
+		JsonView operator[](const std::string &name) const { return prop(name); }
+		JsonView operator[](const char *name) const { return prop(name); }
+		JsonView operator[](size_t index) const { return at(index); }
+
+	private:
+		const JsonDocumentNode *node = nullptr;
+	};
+
+	inline JsonView JsonViewProperty::value() const { return JsonView(&property->value); }
+
+	/// \brief Read-only JSON document with all nodes and strings stored in a memory arena.
+	///
+	/// Parsing into a JsonDocument only allocates memory for the arena blocks, rather than for every node, making it well suited for large documents.
+	class JsonDocument
+	{
+	public:
+		static std::shared_ptr<JsonDocument> parse(const std::string &json) { return parse(json.data(), json.length()); }
+		static std::shared_ptr<JsonDocument> parse(const char *json, size_t length);
+
+		/// \brief Returns the root node of the document.
+		virtual JsonView root() const = 0;
+
+		/// \brief Returns the number of bytes allocated by the arena.
+		virtual size_t memory_usage() const = 0;
+
+		/// \brief Converts the document into a mutable JsonValue.
+		JsonValue to_value() const { return root().to_value(); }
+	};
+
+	typedef std::shared_ptr<JsonDocument> JsonDocumentPtr;
+}
@@ -0,0 +1,96 @@
+/*
+**  UICore
+**  Copyright (c) 1997-2015 The UICore Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries UICore may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+#pragma once
+
+#include "json_value.h"
+#include <memory>
+#include <string>
+
+namespace uicore
+{
+	class IODevice;
+	typedef std::shared_ptr<IODevice> IODevicePtr;
+
+	enum class JsonReaderToken
+	{
+		end_of_document,
+		start_object,
+		end_object,
+		start_array,
+		end_array,
+		property_name,
+		string,
+		number,
+		boolean,
+		null
+	};
+
+	/// \brief Pull parser reading JSON one token at a time.
+	///
+	/// The reader never builds a tree unless read_value is called. When reading from an IODevice only a fixed size window of the
+	/// input is kept in memory, which only grows if a single string or number is larger than the window.
+	/// Concatenated top-level values, such as JSON lines, are read one after another.
+	class JsonReader
+	{
+	public:
+		/// \brief Constructs a reader for an input stream.
+		static std::shared_ptr<JsonReader> create(const IODevicePtr &input, size_t buffer_size = 64 * 1024);
+
+		/// \brief Constructs a reader for a memory range. The data is not copied and must stay valid while reading.
+		static std::shared_ptr<JsonReader> create(const char *data, size_t length);
+		static std::shared_ptr<JsonReader> create(const std::string &json) { return create(json.data(), json.length()); }
+
+		/// \brief Advances to the next token and returns its type.
+		virtual JsonReaderToken next() = 0;
+
+		/// \brief The current token type.
+		virtual JsonReaderToken token() const = 0;
+
+		/// \brief Number of objects and arrays currently open.
+		virtual size_t depth() const = 0;
+
+		/// \brief Unescaped text of the current property_name or string token.
+		virtual const std::string &text() const = 0;
+
+		/// \brief Value of the current number token.
+		virtual double number() const = 0;
+
+		/// \brief Value of the current boolean token.
+		virtual bool boolean() const = 0;
+
+		/// \brief Skips the current object or array, or the value of the current property name, without decoding it.
+		/// Afterwards the reader is positioned at the last token of what was skipped.
+		virtual void skip() = 0;
+
+		/// \brief Reads the value starting at the current token, or the value of the current property name, into a JsonValue.
+		virtual JsonValue read_value() = 0;
+	};
+
+	typedef std::shared_ptr<JsonReader> JsonReaderPtr;
+}
@@ -30,9 +30,13 @@
 
 #include <map>
 #include <vector>
+#include <string>
+#include <memory>
 
 namespace uicore
 {
+	class JsonDocument;
+
 	enum class JsonType
 	{
 		undefined,
@@ -63,6 +67,10 @@ namespace uicore
 		static JsonValue string(const std::string &value) { JsonValue v; v._type = JsonType::string; v._string = value; return v; }
 
 		static JsonValue parse(const std::string &json);
+
+		/// \brief Parses into a compact read-only JsonDocument. Use this for large documents.
+		static std::shared_ptr<JsonDocument> parse_document(const std::string &json);
+
 		std::string to_json() const;
 
 		const JsonValue &prop(const std::string &name) const { auto it = _properties.find(name); if (it != _properties.end()) return it->second; static JsonValue undef; return undef; }
@@ -0,0 +1,86 @@
+/*
+**  UICore
+**  Copyright (c) 1997-2015 The UICore Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries UICore may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+#pragma once
+
+#include "json_value.h"
+#include <memory>
+#include <string>
+
+namespace uicore
+{
+	class IODevice;
+	typedef std::shared_ptr<IODevice> IODevicePtr;
+
+	/// \brief Writes JSON text, either from a JsonValue or one token at a time.
+	///
+	/// Numbers are written with the fewest digits that still read back as the same double. Non-finite numbers are written as null.
+	class JsonWriter
+	{
+	public:
+		/// \brief Constructs a writer that collects the output in memory. Use result() to retrieve it.
+		static std::shared_ptr<JsonWriter> create();
+
+		/// \brief Constructs a writer that writes to an output stream. The output is written in blocks as the internal buffer fills up.
+		static std::shared_ptr<JsonWriter> create(const IODevicePtr &output);
+
+		/// \brief Returns the insert whitespace flag.
+		virtual bool insert_whitespace() const = 0;
+
+		/// \brief Inserts newlines and indentation if enabled.
+		virtual void set_insert_whitespace(bool enable = true) = 0;
+
+		/// \brief Preallocates the internal buffer.
+		virtual void reserve(size_t size) = 0;
+
+		/// \brief Writes a complete value.
+		virtual void value(const JsonValue &value) = 0;
+
+		virtual void begin_object() = 0;
+		virtual void end_object() = 0;
+		virtual void begin_array() = 0;
+		virtual void end_array() = 0;
+
+		/// \brief Writes the name of the next property in an object.
+		virtual void name(const std::string &name) = 0;
+
+		virtual void string(const std::string &value) = 0;
+		virtual void string(const char *value, size_t length) = 0;
+		virtual void number(double value) = 0;
+		virtual void boolean(bool value) = 0;
+		virtual void null() = 0;
+
+		/// \brief Returns the output written so far, if the writer has no output stream.
+		virtual const std::string &result() const = 0;
+
+		/// \brief Writes any buffered output to the output stream.
+		virtual void flush() = 0;
+	};
+
+	typedef std::shared_ptr<JsonWriter> JsonWriterPtr;
+}
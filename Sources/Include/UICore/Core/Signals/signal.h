@@ -32,6 +32,7 @@
 #include <memory>
 #include <functional>
 #include <vector>
+#include <algorithm>
 
 namespace uicore
 {
@@ -60,57 +61,116 @@ namespace uicore
 		virtual ~SlotImpl() { }
 	};
 
-	template<typename SlotImplType>
-	class SignalImpl
+	template<typename FuncType>
+	class SignalCallback
 	{
 	public:
-		std::vector<std::weak_ptr<SlotImplType>> slots;
+		SignalCallback(const std::function<FuncType> &callback) : callback(callback) { }
+
+		std::function<FuncType> callback;
+		bool connected = true;
 	};
 
 	template<typename FuncType>
-	class SlotImplT : public SlotImpl
+	class SignalImpl
 	{
 	public:
-		SlotImplT(const std::weak_ptr<SignalImpl<SlotImplT>> &signal, const std::function<FuncType> &callback) : signal(signal), callback(callback)
-		{
-		}
+		// Callbacks are heap allocated so that they stay put while the vector grows during emission
+		std::vector<std::unique_ptr<SignalCallback<FuncType>>> slots;
 
-		~SlotImplT()
+		// Disconnecting while emitting only marks the callback, it is removed when the outermost emission completes
+		int emit_depth = 0;
+		bool has_disconnected = false;
+
+		void disconnect(SignalCallback<FuncType> *callback)
 		{
-			std::shared_ptr<SignalImpl<SlotImplT>> sig = signal.lock();
-			if (sig)
+			callback->connected = false;
+			if (emit_depth > 0)
 			{
-				for (auto it = sig->slots.begin(); it != sig->slots.end(); ++it)
+				has_disconnected = true;
+			}
+			else
+			{
+				for (auto it = slots.begin(); it != slots.end(); ++it)
 				{
-					// todo: investigate if "it->lock().get() == this" is required
-					if (it->expired() || it->lock().get() == this)
+					if (it->get() == callback)
 					{
-						it = sig->slots.erase(it);
-						if (it == sig->slots.end())
-							break;
+						slots.erase(it);
+						break;
 					}
 				}
 			}
 		}
 
-		std::weak_ptr<SignalImpl<SlotImplT>> signal;
-		std::function<FuncType> callback;
+		void remove_disconnected()
+		{
+			slots.erase(std::remove_if(slots.begin(), slots.end(), [](const std::unique_ptr<SignalCallback<FuncType>> &slot) { return !slot->connected; }), slots.end());
+			has_disconnected = false;
+		}
+	};
+
+	template<typename FuncType>
+	class SignalEmitScope
+	{
+	public:
+		SignalEmitScope(SignalImpl<FuncType> &signal) : signal(signal) { signal.emit_depth++; }
+
+		~SignalEmitScope()
+		{
+			signal.emit_depth--;
+			if (signal.emit_depth == 0 && signal.has_disconnected)
+				signal.remove_disconnected();
+		}
+
+		SignalEmitScope(const SignalEmitScope &) = delete;
+		SignalEmitScope &operator=(const SignalEmitScope &) = delete;
+
+	private:
+		SignalImpl<FuncType> &signal;
+	};
+
+	template<typename FuncType>
+	class SlotImplT : public SlotImpl
+	{
+	public:
+		SlotImplT(const std::weak_ptr<SignalImpl<FuncType>> &signal, SignalCallback<FuncType> *callback) : signal(signal), callback(callback)
+		{
+		}
+
+		~SlotImplT()
+		{
+			// The callback is owned by the signal and is gone if the signal is
+			std::shared_ptr<SignalImpl<FuncType>> sig = signal.lock();
+			if (sig)
+				sig->disconnect(callback);
+		}
+
+		std::weak_ptr<SignalImpl<FuncType>> signal;
+		SignalCallback<FuncType> *callback;
 	};
 
 	template<typename FuncType>
 	class Signal
 	{
 	public:
-		Signal() : impl(std::make_shared<SignalImpl<SlotImplT<FuncType>>>()) { }
+		Signal() : impl(std::make_shared<SignalImpl<FuncType>>()) { }
 
 		template<typename... Args>
 		void operator()(Args&&... args)
 		{
-			std::vector<std::weak_ptr<SlotImplT<FuncType>>> slots = impl->slots;
-			for (std::weak_ptr<SlotImplT<FuncType>> &weak_slot : slots)
+			if (impl->slots.empty())
+				return;
+
+			// A callback may destroy the signal itself
+			std::shared_ptr<SignalImpl<FuncType>> signal = impl;
+			SignalEmitScope<FuncType> scope(*signal);
+
+			// Slots connected during emission are not called until the next emission
+			size_t count = signal->slots.size();
+			for (size_t i = 0; i < count; i++)
 			{
-				std::shared_ptr<SlotImplT<FuncType>> slot = weak_slot.lock();
-				if (slot)
+				SignalCallback<FuncType> *slot = signal->slots[i].get();
+				if (slot->connected)
 				{
 					slot->callback(std::forward<Args>(args)...);
 				}
@@ -119,9 +179,8 @@ namespace uicore
 
 		Slot connect(const std::function<FuncType> &func)
 		{
-			auto slot_impl = std::make_shared<SlotImplT<FuncType>>(impl, func);
-			impl->slots.push_back(slot_impl);
-			return Slot(slot_impl);
+			impl->slots.push_back(std::unique_ptr<SignalCallback<FuncType>>(new SignalCallback<FuncType>(func)));
+			return Slot(std::make_shared<SlotImplT<FuncType>>(impl, impl->slots.back().get()));
 		}
 
 		template<typename InstanceType, typename MemberFuncType>
@@ -131,7 +190,7 @@ namespace uicore
 		}
 
 	private:
-		std::shared_ptr<SignalImpl<SlotImplT<FuncType>>> impl;
+		std::shared_ptr<SignalImpl<FuncType>> impl;
 	};
 
 	class SlotContainer
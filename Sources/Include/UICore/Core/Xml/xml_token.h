@@ -30,6 +30,8 @@
 
 #include <vector>
 #include <utility>
+#include <string>
+#include <cstring>
 
 namespace uicore
 {
@@ -73,4 +75,62 @@ namespace uicore
 		/// \brief All the attributes attached to the token.
 		std::vector<Attribute> attributes;
 	};
+
+	/// \brief Range of characters in the XML source data.
+	class XmlStringRef
+	{
+	public:
+		XmlStringRef() { }
+		XmlStringRef(const char *data, size_t length, bool has_entities = false) : data(data), length(length), has_entities(has_entities) { }
+
+		/// \brief First character of the range. The range is not null terminated.
+		const char *data = nullptr;
+
+		/// \brief Number of characters in the range.
+		size_t length = 0;
+
+		/// \brief True if the range contains entity references that to_string has to replace.
+		bool has_entities = false;
+
+		bool empty() const { return length == 0; }
+
+		/// \brief Returns the characters as they appear in the source data.
+		std::string raw() const { return std::string(data, length); }
+
+		/// \brief Returns the text with entity references replaced.
+		std::string to_string() const { std::string text; append_to(text); return text; }
+
+		/// \brief Appends the text with entity references replaced.
+		void append_to(std::string &text) const;
+
+		bool operator==(const char *str) const { size_t str_length = strlen(str); return str_length == length && memcmp(data, str, length) == 0; }
+		bool operator==(const std::string &str) const { return str.length() == length && memcmp(data, str.data(), length) == 0; }
+		bool operator!=(const char *str) const { return !(*this == str); }
+		bool operator!=(const std::string &str) const { return !(*this == str); }
+	};
+
+	/// \brief XML token referencing the source data of a XmlTokenizer rather than copying it.
+	///
+	/// The ranges stay valid for as long as the tokenizer that produced them.
+	class XmlTokenRef
+	{
+	public:
+		/// Attribute name/value pair.
+		typedef std::pair<XmlStringRef, XmlStringRef> Attribute;
+
+		/// \brief The token type.
+		XmlTokenType type = XmlTokenType::null;
+
+		/// \brief The token variant.
+		XmlTokenVariant variant = XmlTokenVariant::single;
+
+		/// \brief The name of the token.
+		XmlStringRef name;
+
+		/// \brief The value of the token.
+		XmlStringRef value;
+
+		/// \brief All the attributes attached to the token.
+		std::vector<Attribute> attributes;
+	};
 }
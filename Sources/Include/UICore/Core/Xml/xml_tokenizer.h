@@ -29,6 +29,7 @@
 #pragma once
 
 #include "xml_token.h"
+#include "../System/databuffer.h"
 #include <memory>
 
 namespace uicore
@@ -44,6 +45,9 @@ namespace uicore
 		/// \brief Constructs a XmlTokenizer
 		static std::shared_ptr<XmlTokenizer> create(const IODevicePtr &input);
 
+		/// \brief Constructs a XmlTokenizer that tokenizes the buffer in place, without copying it.
+		static std::shared_ptr<XmlTokenizer> create(const DataBufferPtr &buffer);
+
 		/// \brief Returns true if eat whitespace flag is set.
 		virtual bool eat_whitespace() const = 0;
 
@@ -53,6 +57,10 @@ namespace uicore
 		/// \brief Returns the next token available in input stream.
 		XmlToken next() { XmlToken token; next(&token); return token; }
 		virtual void next(XmlToken *out_token) = 0;
+
+		/// \brief Returns the next token as ranges of the source data.
+		/// This does not allocate memory once out_token has enough attribute capacity, and entity references are only replaced when the ranges are converted to strings.
+		virtual void next(XmlTokenRef *out_token) = 0;
 	};
 
 	typedef std::shared_ptr<XmlTokenizer> XmlTokenizerPtr;
@@ -0,0 +1,52 @@
+/*
+**  UICore
+**  Copyright (c) 1997-2015 The UICore Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries UICore may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+#pragma once
+
+#include "../IOData/iodevice.h"
+
+namespace uicore
+{
+	/// \brief IODevice that decompresses data read from another IODevice
+	///
+	/// Data is decompressed as it is read, so memory use stays fixed no matter how large the stream is.
+	/// Input beyond the end of the compressed stream is returned to the input device if it supports seeking.
+	class InflateReader : public IODevice
+	{
+	public:
+		// \brief Creates a decompressing reader
+		// \param input Device supplying the compressed data
+		// \param raw Skips header if true
+		static std::shared_ptr<InflateReader> create(const IODevicePtr &input, bool raw = true);
+
+		/// \brief True when the end of the compressed stream has been reached
+		virtual bool is_end_of_stream() const = 0;
+	};
+
+	typedef std::shared_ptr<InflateReader> InflateReaderPtr;
+}
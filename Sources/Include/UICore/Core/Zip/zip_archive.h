@@ -0,0 +1,85 @@
+/*
+**  UICore
+**  Copyright (c) 1997-2015 The UICore Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries UICore may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+#pragma once
+
+#include <string>
+#include <vector>
+#include <memory>
+#include "../IOData/iodevice.h"
+#include "../System/databuffer.h"
+
+namespace uicore
+{
+	class ZipArchive;
+	typedef std::shared_ptr<ZipArchive> ZipArchivePtr;
+
+	/// \brief Read-only access to the files in a zip archive
+	///
+	/// The central directory is read once when the archive is opened and indexed by file name.
+	/// Stored files are returned as views into the memory mapped archive, while deflated files are
+	/// decompressed as they are read.
+	class ZipArchive
+	{
+	public:
+		/// \brief Opens a zip archive
+		static ZipArchivePtr open(const std::string &filename);
+
+		/// \brief Makes the files of an archive available as if the archive was a directory named path
+		///
+		/// ImageFile::load and FontFamily::add look up file names below a mounted path in the archive.
+		static void mount(const std::string &path, const ZipArchivePtr &archive);
+
+		/// \brief Removes a previously mounted archive
+		static void unmount(const std::string &path);
+
+		/// \brief Finds the mounted archive containing a file
+		/// \param filename File name including the mount path
+		/// \param out_archive Archive containing the file
+		/// \param out_name Name of the file inside the archive
+		/// \return True if filename is below a mounted path and the file exists in the archive
+		static bool find_mounted(const std::string &filename, ZipArchivePtr &out_archive, std::string &out_name);
+
+		/// \brief Names of all files in the archive, in central directory order
+		virtual std::vector<std::string> files() const = 0;
+
+		/// \brief Returns true if the archive contains the file
+		virtual bool exists(const std::string &name) const = 0;
+
+		/// \brief Uncompressed size of a file in the archive
+		virtual long long file_size(const std::string &name) const = 0;
+
+		/// \brief Opens a file in the archive for reading
+		virtual IODevicePtr open_file(const std::string &name) = 0;
+
+		/// \brief Reads the entire file
+		///
+		/// Stored files are returned without being copied.
+		virtual DataBufferPtr read_all_bytes(const std::string &name) = 0;
+	};
+}
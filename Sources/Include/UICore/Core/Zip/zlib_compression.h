@@ -52,6 +52,17 @@ namespace uicore
 		// \param mode Compression strategy
 		static DataBufferPtr compress(const DataBufferPtr &data, bool raw = true, int compression_level = 6, CompressionMode mode = default_strategy);
 
+		// \brief Compress data using multiple threads
+		//
+		// The data is split into blocks that are compressed independently, each primed with the 32 KB preceding it,
+		// and joined into a single deflate stream. The output is slightly larger than compress() produces.
+		// \param data Data to compress
+		// \param raw Skips header if true
+		// \param compression_level Compression level in range 0-9. 0 = no compression, 1 = best speed, 6 = default, 9 = best compression.
+		// \param mode Compression strategy
+		// \param num_threads Number of threads to use. 0 = System::num_cores()
+		static DataBufferPtr compress_parallel(const DataBufferPtr &data, bool raw = true, int compression_level = 6, CompressionMode mode = default_strategy, int num_threads = 0);
+
 		// \brief Decompress data
 		// \param data Data to compress
 		// \param raw Skips header if true
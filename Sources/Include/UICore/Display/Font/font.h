@@ -30,6 +30,7 @@
 #pragma once
 
 #include <memory>
+#include <cstdint>
 #include "UICore/Display/Render/graphic_context.h"
 #include "../Image/pixel_buffer.h"
 #include "font_description.h"
@@ -50,6 +51,26 @@ namespace uicore
 		virtual ~FontHandle() { }
 	};
 
+	/// \brief Glyph cache counters
+	class GlyphCacheStats
+	{
+	public:
+		/// \brief Glyph lookups found in the cache
+		uint64_t hits = 0;
+
+		/// \brief Glyph lookups that had to render the glyph
+		uint64_t misses = 0;
+
+		/// \brief Glyphs removed to stay within the budget
+		uint64_t evictions = 0;
+
+		/// \brief Glyphs currently cached
+		int glyph_count = 0;
+
+		/// \brief Texture area, in pixels, currently used by the cached glyphs
+		int atlas_pixels = 0;
+	};
+
 	/// \brief Font class
 	///
 	/// A Font is a collection of images that can be used to represent text on a screen.
@@ -142,6 +163,16 @@ namespace uicore
 		///
 		/// \return The font handle interface
 		virtual FontHandle *handle(const CanvasPtr &canvas) = 0;
+
+		/// \brief Returns the counters of the glyph cache currently used by this font
+		///
+		/// The glyph cache is shared by all fonts of the same family using the same description. All counters are zero until the font has been used.
+		virtual GlyphCacheStats glyph_cache_stats() const = 0;
+
+		/// \brief Sets the maximum texture area, in pixels, the glyph cache may use before evicting the least recently used glyphs
+		///
+		/// The budget applies to the glyph cache shared by all fonts of the same family using the same description.
+		virtual void set_glyph_cache_budget(int atlas_pixels) = 0;
 	};
 
 	typedef std::shared_ptr<Font> FontPtr;
@@ -43,7 +43,7 @@ namespace uicore
 	class ActivationChangeEvent : public EventUI
 	{
 	public:
-		ActivationChangeEvent(ActivationChangeType type) : _type(type) { }
+		ActivationChangeEvent(ActivationChangeType type) : EventUI(EventUICategory::activation_change), _type(type) { }
 
 		/// Window activation type
 		ActivationChangeType type() const { return _type; }
@@ -36,5 +36,6 @@ namespace uicore
 	class CloseEvent : public EventUI
 	{
 	public:
+		CloseEvent() : EventUI(EventUICategory::close) { }
 	};
 }
@@ -43,12 +43,28 @@ namespace uicore
 		bubbling   /// Event bubbling up from target view to root
 	};
 
+	/// Kind of UI event, used for dispatching events to the matching handler function
+	enum class EventUICategory
+	{
+		none,              /// Event without a specific handler function
+		activation_change, /// ActivationChangeEvent
+		close,             /// CloseEvent
+		resize,            /// ResizeEvent
+		focus_change,      /// FocusChangeEvent
+		pointer,           /// PointerEvent
+		key                /// KeyEvent
+	};
+
 	/// Base class for events being dispatched through the view hiarchy
 	class EventUI
 	{
 	public:
+		EventUI() { }
 		virtual ~EventUI() { }
 
+		/// Kind of event
+		EventUICategory category() const { return _category; }
+
 		/// Current active event phase during dispatch
 		EventUIPhase phase() const { return _phase; }
 
@@ -79,7 +95,11 @@ namespace uicore
 		/// Set event timestamp
 		void set_timestamp(long long ts) { _timestamp = ts; }
 
+	protected:
+		EventUI(EventUICategory category) : _category(category) { }
+
 	private:
+		EventUICategory _category = EventUICategory::none;
 		bool _default_prevented = false;
 		bool _propagation_stopped = false;
 		//bool _immediate_propagation_stopped = true;
@@ -43,7 +43,7 @@ namespace uicore
 	class FocusChangeEvent : public EventUI
 	{
 	public:
-		FocusChangeEvent(FocusChangeType type) : _type(type) { }
+		FocusChangeEvent(FocusChangeType type) : EventUI(EventUICategory::focus_change), _type(type) { }
 
 		FocusChangeType type() const { return _type; }
 
@@ -36,5 +36,6 @@ namespace uicore
 	class ResizeEvent : public EventUI
 	{
 	public:
+		ResizeEvent() : EventUI(EventUICategory::resize) { }
 	};
 }
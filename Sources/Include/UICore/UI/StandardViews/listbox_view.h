@@ -55,11 +55,26 @@ namespace uicore
 			set_items(views);
 		}
 		
+		/// Shows item_count rows that are created on demand by row_factory
+		///
+		/// Only the rows in view, plus a few above and below, exist as views. A row scrolled out of view is handed back
+		/// to row_factory as recycled_view for another index. The factory can update and return it, or return a new view.
+		/// All rows are row_height tall. If row_height is zero the height of the first row is used for every row.
+		void set_item_source(int item_count, const std::function<std::shared_ptr<View>(int index, const std::shared_ptr<View> &recycled_view)> &row_factory, float row_height = 0.0f);
+
+		/// Recreates the rows in view, for example after the item data changed
+		void update_item_source();
+
+		/// Number of items in the list
+		int item_count() const;
+
 		int selected_item() const;
 		void set_selected_item(int index);
 
 		Signal<void()> &sig_selection_changed();
 
+		void layout_children(const CanvasPtr &canvas) override;
+
 	private:
 		std::unique_ptr<ListBoxBaseViewImpl> impl;
 	};
@@ -38,6 +38,7 @@ namespace uicore
 {
 	class StyleImpl;
 	class StyleGetValue;
+	typedef int StylePropertyId;
 
 	/// Style property set
 	class Style
@@ -64,9 +65,20 @@ namespace uicore
 			set(string_format(properties, arg1, values...));
 		}
 
+		/// Enables or disables the shared cache of parsed properties strings used by set()
+		///
+		/// With the cache enabled each distinct properties string is only parsed once. Styles that are set from a
+		/// single string share the parsed property values until one of them is modified again.
+		/// The cache keeps the 4096 most recently used strings. Disabling the cache frees the cached strings.
+		static void set_parse_cache_enabled(bool enable);
+
+		/// Returns a stamp that changes whenever a property value in the style changes
+		unsigned int generation() const;
+
 		/// Retrieve the declared value for a property
 		StyleGetValue declared_value(const char *property_name) const;
 		StyleGetValue declared_value(const std::string &property_name) const { return declared_value(property_name.c_str()); }
+		StyleGetValue declared_value(StylePropertyId property_id) const;
 
 		/// Static helper that generates a "rgba(%1,%2,%3,%4)" string for the given color.
 		static std::string to_rgba(const Colorf &c)
@@ -80,6 +92,8 @@ namespace uicore
 		}
 
 	private:
-		std::unique_ptr<StyleImpl> impl;
+		void detach();
+
+		std::shared_ptr<StyleImpl> impl;
 	};
 }
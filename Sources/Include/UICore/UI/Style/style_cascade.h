@@ -42,6 +42,7 @@ namespace uicore
 	class Font;
 	typedef std::shared_ptr<Font> FontPtr;
 	class ViewGeometry;
+	typedef int StylePropertyId;
 
 #if defined(MICROSOFT_FINALLY_IMPLEMENTED_CONSTEXPR_TEN_YEARS_AFTER_EVERYONE_ELSE)
 	/// Allows property name hashes to be evaluated at compile time
@@ -63,6 +64,43 @@ namespace uicore
 	};
 #endif
 
+	/// Computed values cached by a style cascade
+	class StyleComputedValueCache
+	{
+	public:
+		const StyleGetValue *find(StylePropertyId id) const;
+		void insert(StylePropertyId id, const StyleGetValue &value);
+
+		/// Marks all cached values as stale
+		void clear();
+
+		/// Generation of each style in the cascade the cached values were computed for
+		std::vector<unsigned int> style_generations;
+
+		/// False after clear() until style_generations has been recorded again
+		bool styles_recorded = false;
+
+		/// Stamp of the most recent change to any style when the style generations were last compared
+		unsigned int checked_generation = 0;
+
+		/// Parent cache version the cached values were computed for
+		unsigned int parent_version = 0;
+
+		/// Incremented every time the cache is cleared
+		unsigned int version = 1;
+
+	private:
+		struct Entry
+		{
+			StyleGetValue value;
+			unsigned int version = 0;
+		};
+
+		// Index into entries plus one for each property id, or zero if the property has not been cached
+		std::vector<unsigned int> slots;
+		std::vector<Entry> entries;
+	};
+
 	/// Style value resolver
 	class StyleCascade
 	{
@@ -79,16 +117,25 @@ namespace uicore
 		/// Find the first declared value in the cascade for the specified property
 		StyleGetValue cascade_value(const char *property_name) const;
 		StyleGetValue cascade_value(const std::string &property_name) const { return cascade_value(property_name.c_str()); }
+		StyleGetValue cascade_value(StylePropertyId property_id) const;
 
 		/// Resolve any inheritance or initial values for the cascade value
 		StyleGetValue specified_value(const char *property_name) const;
 		StyleGetValue specified_value(const std::string &property_name) const { return specified_value(property_name.c_str()); }
+		StyleGetValue specified_value(StylePropertyId property_id) const;
 
 		/// Find the computed value for the specified value
 		///
 		/// The computed value is a simplified value for the property. Lengths are resolved to device independent pixels and so on.
+		/// Computed values are cached until a style changes, the parent cascade is invalidated or invalidate_computed_values is called.
 		StyleGetValue computed_value(const char *property_name) const;
 		StyleGetValue computed_value(const std::string &property_name) const { return computed_value(property_name.c_str()); }
+		StyleGetValue computed_value(StylePropertyId property_id) const;
+
+		/// Discard cached computed values
+		///
+		/// Must be called after the cascade or parent members are changed.
+		void invalidate_computed_values() const;
 		
 		/// Convert length into px (device independent pixel) units
 		StyleGetValue compute_length(const StyleGetValue &length) const;
@@ -117,5 +164,12 @@ namespace uicore
 		
 		/// Font used by this style cascade
 		FontPtr font() const;
+
+	private:
+		StyleGetValue compute_value(StylePropertyId property_id) const;
+		void validate_computed_values() const;
+		static StylePropertyId font_size_id();
+
+		mutable StyleComputedValueCache computed_cache;
 	};
 }
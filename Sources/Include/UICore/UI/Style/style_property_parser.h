@@ -111,15 +111,39 @@ namespace uicore
 		StylePropertyDefault(const std::string &name, const StyleGetValue &value, bool inherit);
 	};
 
+	/// Dense integer identifier for a style property name
+	///
+	/// Ids are assigned in the order names are first seen, starting at zero. Each element of an array property,
+	/// such as "box-shadow-color[2]", has an id of its own.
+	typedef int StylePropertyId;
+
 	/// Style property interface used to parse or query properties by name
 	class StyleProperty
 	{
 	public:
+		/// Gets the id for a property name, assigning a new id if the name has not been seen before
+		static StylePropertyId id(const char *name);
+		static StylePropertyId id(const std::string &name) { return id(name.c_str()); }
+
+		/// Gets the id for a property name, or -1 if no id has been assigned to it
+		static StylePropertyId find_id(const char *name);
+
+		/// Gets the id for element [index] of an array property
+		static StylePropertyId array_id(StylePropertyId id, int index);
+
+		/// Gets the name for a property id
+		static const std::string &name(StylePropertyId id);
+
+		/// Number of ids assigned so far
+		static int id_count();
+
 		/// Gets the default value for a given property
 		static const StyleGetValue &default_value(const char *name);
+		static const StyleGetValue &default_value(StylePropertyId id);
 
 		/// Indicates if this an inherited property or not
 		static bool is_inherited(const char *name);
+		static bool is_inherited(StylePropertyId id);
 
 		/// Parses a string of styles and sets the values
 		static void parse(StylePropertySetter *setter, const std::string &styles);
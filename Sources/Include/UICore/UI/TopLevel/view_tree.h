@@ -81,6 +81,39 @@ namespace uicore
 			return add_child<View>();
 		}
 
+		/// Test if retained rendering is enabled
+		bool retained_rendering() const;
+
+		/// Enables or disables retained rendering
+		///
+		/// With retained rendering enabled each view records what it draws into display lists. A view that was not
+		/// changed replays its lists instead of rendering again, even if it moved by whole pixels.
+		///
+		/// A view's lists are discarded by View::set_needs_render, View::set_needs_layout and style changes. A view drawing
+		/// through a custom RenderBatcher is rendered normally every time. Drawing directly on the canvas graphic context is
+		/// not captured and can not be detected, so views doing that must not be used with retained rendering.
+		void set_retained_rendering(bool enable);
+
+		/// Test if incremental layout is enabled
+		bool incremental_layout() const;
+
+		/// Enables or disables incremental layout
+		///
+		/// Without incremental layout any layout change makes the entire tree lay out again. With it enabled, views
+		/// with a fixed width and height act as layout boundaries. Changes inside a boundary do not invalidate its
+		/// ancestors, and only the subtrees that need layout are laid out again.
+		void set_incremental_layout(bool enable);
+
+		/// Number of views laid out during the last render
+		int layout_view_count() const;
+
+		/// Number of subtrees laid out during the last render
+		int layout_subtree_count() const;
+
+		/// Number of layout cache lookups that were found or not found during the last render
+		int layout_cache_hits() const;
+		int layout_cache_misses() const;
+
 	protected:
 		/// Set or clears the focus
 		void set_focus_view(View *view);
@@ -88,6 +121,12 @@ namespace uicore
 		/// Renders view into the specified canvas
 		void render(const CanvasPtr &canvas, const Rectf &margin_box);
 
+		/// Renders the damaged parts of the view tree into the specified canvas
+		///
+		/// Areas without damage are left untouched, so this can only be used if the canvas still holds the previous
+		/// rendering. Each damaged area is cleared to the background color before the views overlapping it are rendered.
+		void render_damage(const CanvasPtr &canvas, const Rectf &margin_box, const Colorf &background);
+
 		/// Dispatch activation change event to all views
 		void dispatch_activation_change(ActivationChangeType type);
 
@@ -107,6 +146,14 @@ namespace uicore
 		ViewTree(const ViewTree &) = delete;
 		ViewTree &operator=(const ViewTree &) = delete;
 
+		void layout(const CanvasPtr &canvas, const Rectf &margin_box);
+
+		/// Adds a rectangle in root view coordinates that must be rendered again
+		void add_damage(const Rectf &box);
+
+		/// Marks the entire view tree as needing to be rendered again
+		void add_full_damage();
+
 		std::unique_ptr<ViewTreeImpl> impl;
 
 		friend class View;
@@ -46,6 +46,10 @@ namespace uicore
 		static void add_font_face(const std::string &properties, const std::string &src);
 
 		static std::string resource_path();
+
+		/// \brief Sets the path resources are loaded from
+		///
+		/// If the path is a .zip file the archive is mounted and resources are read from it.
 		static void set_resource_path(const std::string &path);
 
 		static ImagePtr image(const CanvasPtr &canvas, const std::string &name);
@@ -268,6 +268,15 @@ namespace uicore
 		/// Find descendant view at the specified content relative position
 		std::shared_ptr<View> find_view_at(const Pointf &pos) const;
 
+		/// Test if find_view_at uses a spatial index of the children of this view
+		bool indexed_hit_testing() const;
+
+		/// Enables or disables a spatial index of the children for find_view_at
+		///
+		/// Useful for views with many positioned children. The index is rebuilt on the next hit test after a child was
+		/// added, removed or moved.
+		void set_indexed_hit_testing(bool enable);
+
 		/// Checks if another view is the ancestor of this view
 		bool has_ancestor(const View *ancestor_view) const;
 
@@ -46,11 +46,16 @@
 #include "Core/IOData/endian.h"
 #include "Core/IOData/iodevice.h"
 #include "Core/IOData/memory_device.h"
+#include "Core/IOData/buffered_iodevice.h"
+#include "Core/IOData/mapped_file.h"
 #include "Core/IOData/file.h"
 #include "Core/IOData/path_help.h"
 #include "Core/IOData/directory.h"
 #include "Core/IOData/directory_scanner.h"
 #include "Core/Zip/zlib_compression.h"
+#include "Core/Zip/deflate_writer.h"
+#include "Core/Zip/inflate_reader.h"
+#include "Core/Zip/zip_archive.h"
 #include "Core/Math/angle.h"
 #include "Core/Math/base64_encoder.h"
 #include "Core/Math/base64_decoder.h"
@@ -108,6 +113,9 @@
 #include "Core/Crypto/tls_client.h"
 #include "Core/Crypto/hash_functions.h"
 #include "Core/Json/json_value.h"
+#include "Core/Json/json_document.h"
+#include "Core/Json/json_reader.h"
+#include "Core/Json/json_writer.h"
 #include "Core/Xml/xml_document.h"
 #include "Core/Xml/xml_node.h"
 #include "Core/Xml/xml_tokenizer.h"
@@ -0,0 +1,237 @@
+/*
+**  UICore
+**  Copyright (c) 1997-2015 The UICore Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries UICore may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+#include "UICore/precomp.h"
+#include "UICore/Core/IOData/buffered_iodevice.h"
+#include "UICore/Core/System/exception.h"
+#include <vector>
+#include <algorithm>
+#include <cstring>
+
+#undef min
+#undef max
+
+namespace uicore
+{
+	class BufferedIODeviceImpl : public BufferedIODevice
+	{
+	public:
+		BufferedIODeviceImpl(const IODevicePtr &device, int read_buffer_size, int write_buffer_size);
+		~BufferedIODeviceImpl();
+
+		const IODevicePtr &device() const override { return _device; }
+		void flush() override;
+
+		long long size() const override;
+
+		long long seek(long long position) override;
+		long long seek_from_current(long long offset) override;
+		long long seek_from_end(long long offset) override;
+
+		int try_read(void *data, int size) override { return (int)try_read_64(data, size); }
+		long long try_read_64(void *data, long long size) override;
+		void write(const void *data, int size) override { write_64(data, size); }
+		void write_64(const void *data, long long size) override;
+
+		void close() override;
+
+	private:
+		long long logical_position() const { return device_pos - (read_end - read_pos) + write_used; }
+		void discard_read_buffer();
+
+		IODevicePtr _device;
+
+		// Position of the underlying device
+		long long device_pos = 0;
+
+		// Read-ahead data. It ends at device_pos.
+		std::vector<char> read_buffer;
+		long long read_pos = 0;
+		long long read_end = 0;
+
+		// Write-behind data. It starts at device_pos.
+		std::vector<char> write_buffer;
+		long long write_used = 0;
+	};
+
+	std::shared_ptr<BufferedIODevice> BufferedIODevice::create(const IODevicePtr &device, int read_buffer_size, int write_buffer_size)
+	{
+		return std::make_shared<BufferedIODeviceImpl>(device, read_buffer_size, write_buffer_size);
+	}
+
+	BufferedIODeviceImpl::BufferedIODeviceImpl(const IODevicePtr &device, int read_buffer_size, int write_buffer_size)
+		: _device(device), device_pos(device->position()), read_buffer(std::max(read_buffer_size, 0)), write_buffer(std::max(write_buffer_size, 0))
+	{
+		set_big_endian_mode(device->is_big_endian_mode());
+	}
+
+	BufferedIODeviceImpl::~BufferedIODeviceImpl()
+	{
+		try
+		{
+			flush();
+		}
+		catch (...)
+		{
+		}
+	}
+
+	void BufferedIODeviceImpl::flush()
+	{
+		if (write_used > 0)
+		{
+			long long amount = write_used;
+			write_used = 0;
+			_device->write_64(write_buffer.data(), amount);
+			device_pos += amount;
+		}
+	}
+
+	void BufferedIODeviceImpl::discard_read_buffer()
+	{
+		if (read_pos != read_end)
+			device_pos = _device->seek(logical_position());
+		read_pos = 0;
+		read_end = 0;
+	}
+
+	long long BufferedIODeviceImpl::size() const
+	{
+		const_cast<BufferedIODeviceImpl*>(this)->flush();
+		return _device->size();
+	}
+
+	long long BufferedIODeviceImpl::seek(long long position)
+	{
+		// Stay inside the read buffer if possible
+		long long buffer_start = device_pos - read_end;
+		if (write_used == 0 && read_end > 0 && position >= buffer_start && position <= device_pos)
+		{
+			read_pos = position - buffer_start;
+			return position;
+		}
+
+		long long old_position = logical_position();
+		flush();
+		read_pos = 0;
+		read_end = 0;
+		device_pos = _device->seek(position);
+
+		// Devices that reject the seek stay where they were. Make sure that is also where we were.
+		if (device_pos != position && device_pos != old_position)
+			device_pos = _device->seek(old_position);
+
+		return device_pos;
+	}
+
+	long long BufferedIODeviceImpl::seek_from_current(long long offset)
+	{
+		if (offset == 0)
+			return logical_position();
+		return seek(logical_position() + offset);
+	}
+
+	long long BufferedIODeviceImpl::seek_from_end(long long offset)
+	{
+		flush();
+		discard_read_buffer();
+		device_pos = _device->seek_from_end(offset);
+		return device_pos;
+	}
+
+	long long BufferedIODeviceImpl::try_read_64(void *data, long long size)
+	{
+		if (size < 0)
+			throw Exception("Read failed");
+
+		flush();
+
+		char *dest = static_cast<char*>(data);
+		long long pos = 0;
+		while (pos < size)
+		{
+			if (read_pos == read_end)
+			{
+				read_pos = 0;
+				read_end = 0;
+
+				// Large reads go directly to the destination
+				if (size - pos >= (long long)read_buffer.size())
+				{
+					long long bytes = _device->try_read_64(dest + pos, size - pos);
+					device_pos += bytes;
+					pos += bytes;
+					break;
+				}
+
+				read_end = _device->try_read_64(read_buffer.data(), read_buffer.size());
+				device_pos += read_end;
+				if (read_end == 0)
+					break;
+			}
+
+			long long amount = std::min(size - pos, read_end - read_pos);
+			memcpy(dest + pos, read_buffer.data() + read_pos, (size_t)amount);
+			read_pos += amount;
+			pos += amount;
+		}
+		return pos;
+	}
+
+	void BufferedIODeviceImpl::write_64(const void *data, long long size)
+	{
+		if (size < 0)
+			throw Exception("Write failed");
+
+		discard_read_buffer();
+
+		if (write_used + size > (long long)write_buffer.size())
+		{
+			flush();
+
+			// Large writes go directly to the device
+			if (size >= (long long)write_buffer.size())
+			{
+				_device->write_64(data, size);
+				device_pos += size;
+				return;
+			}
+		}
+
+		memcpy(write_buffer.data() + write_used, data, (size_t)size);
+		write_used += size;
+	}
+
+	void BufferedIODeviceImpl::close()
+	{
+		flush();
+		read_pos = 0;
+		read_end = 0;
+		_device->close();
+	}
+}
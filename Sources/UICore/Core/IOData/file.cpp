@@ -36,8 +36,10 @@
 #include <sys/stat.h>
 #include <fcntl.h>
 #include <unistd.h>
+#include <errno.h>
 #endif
 
+#undef min
 #undef max
 #include <limits>
 #include <algorithm>
@@ -68,8 +70,10 @@ namespace uicore
 		long long seek_from_current(long long offset) override;
 		long long seek_from_end(long long offset) override;
 
-		int try_read(void *data, int size) override;
-		void write(const void *data, int size) override;
+		int try_read(void *data, int size) override { return (int)try_read_64(data, size); }
+		long long try_read_64(void *data, long long size) override;
+		void write(const void *data, int size) override { write_64(data, size); }
+		void write_64(const void *data, long long size) override;
 
 		FileImpl(const FileImpl &) = delete;
 		FileImpl &operator=(const FileImpl &) = delete;
@@ -188,23 +192,37 @@ namespace uicore
 		return new_pos.QuadPart;
 	}
 
-	int FileImpl::try_read(void *data, int size)
+	long long FileImpl::try_read_64(void *data, long long size)
 	{
-		DWORD bytes_read = 0;
-		BOOL result = ReadFile(handle, data, size, &bytes_read, 0);
-		if (result == FALSE)
-			throw Exception("ReadFile failed");
-		return (int)bytes_read;
+		// ReadFile is limited to 32-bit sizes
+		long long pos = 0;
+		while (pos < size)
+		{
+			DWORD bytes_read = 0;
+			BOOL result = ReadFile(handle, static_cast<char*>(data) + pos, (DWORD)std::min(size - pos, 0x40000000LL), &bytes_read, 0);
+			if (result == FALSE)
+				throw Exception("ReadFile failed");
+			if (bytes_read == 0)
+				break;
+			pos += bytes_read;
+		}
+		return pos;
 	}
 
-	void FileImpl::write(const void *data, int size)
+	void FileImpl::write_64(const void *data, long long size)
 	{
-		DWORD written = 0;
-		BOOL result = WriteFile(handle, data, size, &written, 0);
-		if (result == FALSE)
-			throw Exception("WriteFile failed");
-		if (written != size)
-			throw Exception("Could not write all bytes to file");
+		long long pos = 0;
+		while (pos < size)
+		{
+			DWORD amount = (DWORD)std::min(size - pos, 0x40000000LL);
+			DWORD written = 0;
+			BOOL result = WriteFile(handle, static_cast<const char*>(data) + pos, amount, &written, 0);
+			if (result == FALSE)
+				throw Exception("WriteFile failed");
+			if (written != amount)
+				throw Exception("Could not write all bytes to file");
+			pos += written;
+		}
 	}
 
 #else
@@ -230,8 +248,10 @@ namespace uicore
 		long long seek_from_current(long long offset) override;
 		long long seek_from_end(long long offset) override;
 
-		int try_read(void *data, int size) override;
-		void write(const void *data, int size) override;
+		int try_read(void *data, int size) override { return (int)try_read_64(data, size); }
+		long long try_read_64(void *data, long long size) override;
+		void write(const void *data, int size) override { write_64(data, size); }
+		void write_64(const void *data, long long size) override;
 
 		FileImpl(const FileImpl &) = delete;
 		FileImpl &operator=(const FileImpl &) = delete;
@@ -346,21 +366,42 @@ namespace uicore
 		return result;
 	}
 
-	int FileImpl::try_read(void *data, int size)
+	long long FileImpl::try_read_64(void *data, long long size)
 	{
-		int result = ::read(handle, data, size);
-		if (result == -1)
-			throw Exception("read failed");
-		return result;
+		// read may return less than requested for large sizes or when interrupted
+		long long pos = 0;
+		while (pos < size)
+		{
+			ssize_t result = ::read(handle, static_cast<char*>(data) + pos, (size_t)std::min(size - pos, 0x40000000LL));
+			if (result == -1)
+			{
+				if (errno == EINTR)
+					continue;
+				throw Exception("read failed");
+			}
+			if (result == 0)
+				break;
+			pos += result;
+		}
+		return pos;
 	}
 
-	void FileImpl::write(const void *data, int size)
+	void FileImpl::write_64(const void *data, long long size)
 	{
-		int result = ::write(handle, data, size);
-		if (result == -1)
-			throw Exception("write failed");
-		if (result != size)
-			throw Exception("Could not write all bytes to file");
+		long long pos = 0;
+		while (pos < size)
+		{
+			ssize_t result = ::write(handle, static_cast<const char*>(data) + pos, (size_t)std::min(size - pos, 0x40000000LL));
+			if (result == -1)
+			{
+				if (errno == EINTR)
+					continue;
+				throw Exception("write failed");
+			}
+			if (result == 0)
+				throw Exception("Could not write all bytes to file");
+			pos += result;
+		}
 	}
 
 #endif
@@ -384,7 +425,7 @@ namespace uicore
 	void File::write_all_text(const std::string &filename, const std::string &text)
 	{
 		auto file = FileImpl::create_always(filename);
-		file->write(text.data(), text.length());
+		file->write_64(text.data(), text.length());
 	}
 
 	DataBufferPtr File::read_all_bytes(const std::string &filename)
@@ -405,7 +446,7 @@ namespace uicore
 	void File::write_all_bytes(const std::string &filename, const DataBufferPtr &data)
 	{
 		auto file = FileImpl::create_always(filename);
-		file->write(data->data(), data->size());
+		file->write_64(data->data(), data->size());
 	}
 
 	void File::copy(const std::string &from, const std::string &to, bool copy_always)
@@ -424,7 +465,7 @@ namespace uicore
 		{
 			long long amount = std::min(1024 * 1024LL, size - pos);
 			input_file->read(buffer->data(), amount);
-			output_file->write(buffer->data(), amount);
+			output_file->write_64(buffer->data(), amount);
 			pos += amount;
 		}
 #endif
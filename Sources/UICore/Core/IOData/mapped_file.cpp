@@ -0,0 +1,344 @@
+/*
+**  UICore
+**  Copyright (c) 1997-2015 The UICore Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries UICore may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+#include "UICore/precomp.h"
+#include "UICore/Core/IOData/mapped_file.h"
+#include "UICore/Core/Text/text.h"
+#include "UICore/Core/System/exception.h"
+#if !defined(WIN32)
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+#include <vector>
+#include <cstring>
+#include <algorithm>
+
+#undef min
+#undef max
+
+namespace uicore
+{
+	class MappedFileMapping
+	{
+	public:
+		MappedFileMapping(const std::string &filename);
+		~MappedFileMapping();
+
+		void set_usage(MappedFileUsage usage);
+
+		/// Maps part of the file again as a private copy-on-write view. Returns a pointer to offset.
+		char *map_private(long long offset, size_t size, void *&view_base, size_t &view_size);
+		static void unmap_private(void *view_base, size_t view_size);
+
+		/// Read-only view of the entire file, shared by all readers
+		const char *data = nullptr;
+		long long size = 0;
+
+	private:
+		/// Current access hint. Also applied to each private view when it is mapped.
+		MappedFileUsage usage = MappedFileUsage::normal;
+
+#if defined(WIN32)
+		HANDLE file_mapping = 0;
+#else
+		int handle = -1;
+
+		static int usage_advice(MappedFileUsage usage);
+#endif
+
+		MappedFileMapping(const MappedFileMapping &) = delete;
+		MappedFileMapping &operator=(const MappedFileMapping &) = delete;
+	};
+
+	/// Buffer backed by its own private mapping of part of the file, so writes to it are not seen by anyone else
+	class MappedFileBuffer : public DataBuffer
+	{
+	public:
+		MappedFileBuffer(MappedFileMapping &mapping, long long offset, size_t size) : _size(size), _capacity(size)
+		{
+			ptr = mapping.map_private(offset, size, view_base, view_size);
+		}
+
+		~MappedFileBuffer()
+		{
+			if (view_base)
+				MappedFileMapping::unmap_private(view_base, view_size);
+		}
+
+		char *data() override { return ptr; }
+		const char *data() const override { return ptr; }
+		size_t size() const override { return _size; }
+		size_t capacity() const override { return _capacity; }
+
+		void set_size(size_t size) override
+		{
+			if (size > _capacity)
+				set_capacity(size);
+			_size = size;
+		}
+
+		void set_capacity(size_t capacity) override
+		{
+			if (capacity > _capacity)
+			{
+				// Leave the mapping
+				std::vector<char> new_storage(capacity);
+				memcpy(new_storage.data(), ptr, _size);
+				storage.swap(new_storage);
+				ptr = storage.data();
+				_capacity = capacity;
+				if (view_base)
+				{
+					MappedFileMapping::unmap_private(view_base, view_size);
+					view_base = nullptr;
+				}
+			}
+		}
+
+		std::shared_ptr<DataBuffer> copy(size_t pos, size_t size) override { return DataBuffer::create(ptr + pos, size); }
+
+		MappedFileBuffer(const MappedFileBuffer &) = delete;
+		MappedFileBuffer &operator=(const MappedFileBuffer &) = delete;
+
+	private:
+		void *view_base = nullptr;
+		size_t view_size = 0;
+		char *ptr = nullptr;
+		size_t _size;
+		size_t _capacity;
+		std::vector<char> storage;
+	};
+
+	class MappedFileImpl : public MappedFile
+	{
+	public:
+		MappedFileImpl(const std::string &filename) : mapping(std::make_shared<MappedFileMapping>(filename)) { }
+
+		const char *data() const override { return mapping->data; }
+		DataBufferPtr buffer() override { return view(0, mapping->size); }
+		DataBufferPtr view(long long offset, long long size) override;
+		void set_usage(MappedFileUsage usage) override { mapping->set_usage(usage); }
+
+		long long size() const override { return mapping->size; }
+
+		long long seek(long long position) override { if (position < 0) throw Exception("Seek failed"); _pos = position; return _pos; }
+		long long seek_from_current(long long offset) override { return seek(_pos + offset); }
+		long long seek_from_end(long long offset) override { return seek(mapping->size + offset); }
+
+		int try_read(void *data, int size) override { return (int)try_read_64(data, size); }
+		long long try_read_64(void *data, long long size) override;
+		void write(const void *data, int size) override { write_64(data, size); }
+		void write_64(const void *data, long long size) override { throw Exception("Cannot write to a memory mapped file"); }
+
+	private:
+		std::shared_ptr<MappedFileMapping> mapping;
+		long long _pos = 0;
+
+		static const long long private_view_threshold = 64 * 1024;
+	};
+
+	std::shared_ptr<MappedFile> MappedFile::open(const std::string &filename, MappedFileUsage usage)
+	{
+		auto file = std::make_shared<MappedFileImpl>(filename);
+		if (usage != MappedFileUsage::normal)
+			file->set_usage(usage);
+		return file;
+	}
+
+	DataBufferPtr MappedFileImpl::view(long long offset, long long size)
+	{
+		if (offset < 0 || size < 0 || offset + size > mapping->size)
+			throw Exception("View is outside the memory mapped file");
+
+		// Copying is cheaper than setting up a mapping for small views
+		if (size < private_view_threshold)
+			return DataBuffer::create(mapping->data + offset, (size_t)size);
+		return std::make_shared<MappedFileBuffer>(*mapping, offset, (size_t)size);
+	}
+
+	long long MappedFileImpl::try_read_64(void *data, long long size)
+	{
+		if (size < 0)
+			throw Exception("Read failed");
+
+		size = std::max(std::min(size, mapping->size - _pos), 0LL);
+		memcpy(data, mapping->data + _pos, (size_t)size);
+		_pos += size;
+		return size;
+	}
+
+#if defined(WIN32)
+
+	MappedFileMapping::MappedFileMapping(const std::string &filename)
+	{
+		HANDLE file = CreateFile(Text::to_utf16(filename).c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, 0, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, 0);
+		if (file == INVALID_HANDLE_VALUE)
+			throw Exception("Could not open existing file: " + filename);
+
+		LARGE_INTEGER file_size;
+		file_size.QuadPart = 0;
+		if (GetFileSizeEx(file, &file_size) == FALSE)
+		{
+			CloseHandle(file);
+			throw Exception("GetFileSizeEx failed");
+		}
+
+		if (file_size.QuadPart > 0)
+		{
+			// The mapping object is kept for the private views. It stays valid after the file handle is closed.
+			file_mapping = CreateFileMapping(file, 0, PAGE_WRITECOPY, 0, 0, 0);
+			CloseHandle(file);
+			if (file_mapping == 0)
+				throw Exception("Could not create file mapping: " + filename);
+
+			data = static_cast<const char*>(MapViewOfFile(file_mapping, FILE_MAP_READ, 0, 0, 0));
+			if (data == nullptr)
+			{
+				CloseHandle(file_mapping);
+				throw Exception("Could not map file: " + filename);
+			}
+		}
+		else
+		{
+			CloseHandle(file);
+		}
+		size = file_size.QuadPart;
+	}
+
+	MappedFileMapping::~MappedFileMapping()
+	{
+		if (data)
+			UnmapViewOfFile(data);
+		if (file_mapping)
+			CloseHandle(file_mapping);
+	}
+
+	char *MappedFileMapping::map_private(long long offset, size_t size, void *&view_base, size_t &view_size)
+	{
+		SYSTEM_INFO system_info;
+		GetSystemInfo(&system_info);
+		long long start = offset - offset % system_info.dwAllocationGranularity;
+
+		view_size = (size_t)(offset - start) + size;
+		view_base = MapViewOfFile(file_mapping, FILE_MAP_COPY, (DWORD)(start >> 32), (DWORD)start, view_size);
+		if (view_base == nullptr)
+			throw Exception("Could not map file view");
+		return static_cast<char*>(view_base) + (offset - start);
+	}
+
+	void MappedFileMapping::unmap_private(void *view_base, size_t view_size)
+	{
+		UnmapViewOfFile(view_base);
+	}
+
+	void MappedFileMapping::set_usage(MappedFileUsage new_usage)
+	{
+		// No madvise equivalent. The cache manager detects sequential access by itself.
+		usage = new_usage;
+	}
+
+#else
+
+	MappedFileMapping::MappedFileMapping(const std::string &filename)
+	{
+		handle = ::open(filename.c_str(), O_RDONLY);
+		if (handle == -1)
+			throw Exception("Could not open existing file: " + filename);
+
+		struct stat file_info;
+		if (fstat(handle, &file_info) == -1)
+		{
+			::close(handle);
+			throw Exception("fstat failed");
+		}
+
+		if (file_info.st_size > 0)
+		{
+			// The handle is kept open for the private views
+			void *result = mmap(nullptr, (size_t)file_info.st_size, PROT_READ, MAP_SHARED, handle, 0);
+			if (result == MAP_FAILED)
+			{
+				::close(handle);
+				throw Exception("Could not map file: " + filename);
+			}
+			data = static_cast<const char*>(result);
+		}
+		size = file_info.st_size;
+	}
+
+	MappedFileMapping::~MappedFileMapping()
+	{
+		if (data)
+			munmap(const_cast<char*>(data), (size_t)size);
+		::close(handle);
+	}
+
+	char *MappedFileMapping::map_private(long long offset, size_t size, void *&view_base, size_t &view_size)
+	{
+		// Private writable mapping: pages are copied on write, so the buffer can be modified like any other DataBuffer
+		long long page_size = sysconf(_SC_PAGESIZE);
+		long long start = offset - offset % page_size;
+
+		view_size = (size_t)(offset - start) + size;
+		void *result = mmap(nullptr, view_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, handle, (off_t)start);
+		if (result == MAP_FAILED)
+			throw Exception("Could not map file view");
+		view_base = result;
+		if (usage != MappedFileUsage::normal)
+			madvise(view_base, view_size, usage_advice(usage));
+		return static_cast<char*>(view_base) + (offset - start);
+	}
+
+	void MappedFileMapping::unmap_private(void *view_base, size_t view_size)
+	{
+		munmap(view_base, view_size);
+	}
+
+	void MappedFileMapping::set_usage(MappedFileUsage new_usage)
+	{
+		usage = new_usage;
+		if (data)
+			madvise(const_cast<char*>(data), (size_t)size, usage_advice(usage));
+	}
+
+	int MappedFileMapping::usage_advice(MappedFileUsage usage)
+	{
+		switch (usage)
+		{
+		default:
+		case MappedFileUsage::normal: return MADV_NORMAL;
+		case MappedFileUsage::sequential: return MADV_SEQUENTIAL;
+		case MappedFileUsage::random: return MADV_RANDOM;
+		}
+	}
+
+#endif
+}
@@ -32,6 +32,7 @@
 #include "UICore/Core/System/exception.h"
 #include "UICore/Core/System/databuffer.h"
 #include <algorithm>
+#include <limits>
 
 #undef min
 #undef max
@@ -49,36 +50,38 @@ namespace uicore
 
 		long long size() const override { return _buffer->size(); }
 
-		long long seek(long long pos) override { if (pos >= 0 && pos < size()) _pos = pos; return _pos; }
+		long long seek(long long pos) override { if (pos >= 0 && pos <= size()) _pos = pos; return _pos; }
 		long long seek_from_current(long long offset) override { return seek(_pos + offset); }
 		long long seek_from_end(long long offset) override { return seek(size() + offset); }
 
-		int try_read(void *data, int size) override
+		int try_read(void *data, int size) override { return (int)try_read_64(data, size); }
+		long long try_read_64(void *data, long long size) override
 		{
 			if (size < 0)
 				throw Exception("Read failed");
 
-			size = std::min(size, (int)(_buffer->size() - _pos));
-			memcpy(data, _buffer->data() + _pos, size);
+			size = std::max(std::min(size, (long long)_buffer->size() - _pos), 0LL);
+			memcpy(data, _buffer->data() + _pos, (size_t)size);
 			_pos += size;
 			return size;
 		}
 
-		void write(const void *data, int size) override
+		void write(const void *data, int size) override { write_64(data, size); }
+		void write_64(const void *data, long long size) override
 		{
 			if (size < 0)
 				throw Exception("Write failed");
 
-			if (_pos + size > 0x7ffffff)
+			if ((unsigned long long)(_pos + size) > std::numeric_limits<size_t>::max() / 2)
 				throw Exception("Memory buffer max size exceeeded");
 
-			if (_pos + size > _buffer->capacity())
-				_buffer->set_capacity(std::max(_pos + size, static_cast<long long>(_buffer->capacity()) * 2));
+			if (_pos + size > (long long)_buffer->capacity())
+				_buffer->set_capacity((size_t)std::max(_pos + size, static_cast<long long>(_buffer->capacity()) * 2));
 
-			if (_pos + size > _buffer->size())
-				_buffer->set_size(_pos + size);
+			if (_pos + size > (long long)_buffer->size())
+				_buffer->set_size((size_t)(_pos + size));
 
-			memcpy(_buffer->data() + _pos, data, size);
+			memcpy(_buffer->data() + _pos, data, (size_t)size);
 			_pos += size;
 		}
 
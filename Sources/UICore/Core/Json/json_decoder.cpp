@@ -0,0 +1,210 @@
+/*
+**  UICore
+**  Copyright (c) 1997-2015 The UICore Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries UICore may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+#include "UICore/precomp.h"
+#include "UICore/Core/Text/text.h"
+#include "json_decoder.h"
+#include <cstdlib>
+
+namespace uicore
+{
+	void JsonDecoder::read_string(const char *data, size_t length, size_t &pos, std::string &result)
+	{
+		pos++;
+		if (pos == length)
+			throw Exception("Unexpected end of JSON data");
+
+		result.clear();
+		while (true)
+		{
+			size_t start = pos;
+			while (pos != length && data[pos] != '"' && data[pos] != '\\')
+				pos++;
+			result.append(data + start, pos - start);
+
+			if (pos == length)
+			{
+				throw Exception("Unexpected end of JSON data");
+			}
+			else if (data[pos] == '"')
+			{
+				break;
+			}
+			else
+			{
+				pos++;
+				if (pos == length)
+					throw Exception("Unexpected end of JSON data");
+
+				unsigned codepoint;
+				switch (data[pos])
+				{
+				case '"':
+					result.push_back('"');
+					break;
+				case '\\':
+					result.push_back('\\');
+					break;
+				case '/':
+					result.push_back('/');
+					break;
+				case 'b':
+					result.push_back('\b');
+					break;
+				case 'f':
+					result.push_back('\f');
+					break;
+				case 'n':
+					result.push_back('\n');
+					break;
+				case 'r':
+					result.push_back('\r');
+					break;
+				case 't':
+					result.push_back('\t');
+					break;
+				case 'u':
+					if (pos + 5 > length)
+						throw Exception("Unexpected end of JSON data");
+
+					codepoint = 0;
+					for (int i = 0; i < 4; i++)
+					{
+						char c = data[pos + 1 + i];
+						if (c >= '0' && c <= '9')
+						{
+							codepoint <<= 4;
+							codepoint |= c - '0';
+						}
+						else if (c >= 'a' && c <= 'f')
+						{
+							codepoint <<= 4;
+							codepoint |= c - 'a' + 10;
+						}
+						else if (c >= 'A' && c <= 'F')
+						{
+							codepoint <<= 4;
+							codepoint |= c - 'A' + 10;
+						}
+						else
+						{
+							throw Exception("Invalid unicode escape");
+						}
+					}
+					result += Text::from_utf32(codepoint);
+					pos += 4;
+					break;
+				}
+				pos++;
+			}
+		}
+
+		pos++;
+	}
+
+	bool JsonDecoder::read_raw_string(const char *data, size_t length, size_t &pos, const char *&out_string, size_t &out_length)
+	{
+		size_t end = pos + 1;
+		while (end < length && data[end] != '"' && data[end] != '\\')
+			end++;
+
+		if (end >= length)
+			throw Exception("Unexpected end of JSON data");
+		else if (data[end] == '\\')
+			return false;
+
+		out_string = data + pos + 1;
+		out_length = end - pos - 1;
+		pos = end + 1;
+		return true;
+	}
+
+	double JsonDecoder::read_number(const char *data, size_t length, size_t &pos)
+	{
+		size_t start_pos = pos;
+		if (pos != length && data[pos] == '-')
+			pos++;
+		while (pos < length && data[pos] >= '0' && data[pos] <= '9')
+			pos++;
+		if (pos != length && data[pos] == '.')
+			pos++;
+		while (pos < length && data[pos] >= '0' && data[pos] <= '9')
+			pos++;
+		if (pos != length && (data[pos] == 'e' || data[pos] == 'E'))
+		{
+			pos++;
+			if (pos != length && (data[pos] == '+' || data[pos] == '-'))
+				pos++;
+			while (pos < length && data[pos] >= '0' && data[pos] <= '9')
+				pos++;
+		}
+		size_t number_length = pos - start_pos;
+
+		if (number_length == 0)
+			throw Exception("Unexpected character in JSON data");
+
+		// strtod needs a null terminated string. Numbers are nearly always short enough for the stack buffer.
+		char buffer[64];
+		if (number_length < sizeof(buffer))
+		{
+			memcpy(buffer, data + start_pos, number_length);
+			buffer[number_length] = 0;
+			return strtod(buffer, nullptr);
+		}
+		else
+		{
+			std::string number_string(data + start_pos, number_length);
+			return strtod(number_string.c_str(), nullptr);
+		}
+	}
+
+	bool JsonDecoder::read_boolean(const char *data, size_t length, size_t &pos)
+	{
+		if (data[pos] == 't')
+		{
+			if (pos + 4 > length || memcmp(data + pos, "true", 4) != 0)
+				throw Exception("Unexpected character in JSON data");
+			pos += 4;
+			return true;
+		}
+		else
+		{
+			if (pos + 5 > length || memcmp(data + pos, "false", 5) != 0)
+				throw Exception("Unexpected character in JSON data");
+			pos += 5;
+			return false;
+		}
+	}
+
+	void JsonDecoder::read_null(const char *data, size_t length, size_t &pos)
+	{
+		if (pos + 4 > length || memcmp(data + pos, "null", 4) != 0)
+			throw Exception("Unexpected character in JSON data");
+		pos += 4;
+	}
+}
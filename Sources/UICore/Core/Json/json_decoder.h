@@ -0,0 +1,55 @@
+/*
+**  UICore
+**  Copyright (c) 1997-2015 The UICore Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries UICore may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+#pragma once
+
+#include <string>
+
+namespace uicore
+{
+	/// \brief Low level JSON token decoding shared by the JSON parsers.
+	///
+	/// All functions operate on a complete memory range. pos is the current read position and is advanced past the decoded token.
+	class JsonDecoder
+	{
+	public:
+		static bool is_whitespace(char c) { return c == ' ' || c == '\r' || c == '\n' || c == '\t' || c == '\f'; }
+		static void read_whitespace(const char *data, size_t length, size_t &pos) { while (pos != length && is_whitespace(data[pos])) pos++; }
+
+		/// \brief Reads a quoted string and unescapes it into result.
+		static void read_string(const char *data, size_t length, size_t &pos, std::string &result);
+
+		/// \brief Reads a quoted string that contains no escape sequences.
+		/// Returns false, and leaves pos unchanged, if the string needs unescaping.
+		static bool read_raw_string(const char *data, size_t length, size_t &pos, const char *&out_string, size_t &out_length);
+
+		static double read_number(const char *data, size_t length, size_t &pos);
+		static bool read_boolean(const char *data, size_t length, size_t &pos);
+		static void read_null(const char *data, size_t length, size_t &pos);
+	};
+}
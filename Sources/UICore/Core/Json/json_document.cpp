@@ -0,0 +1,409 @@
+/*
+**  UICore
+**  Copyright (c) 1997-2015 The UICore Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries UICore may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+#include "UICore/precomp.h"
+#include "UICore/Core/Json/json_document.h"
+#include "json_decoder.h"
+#include "../Xml/block_allocator.h"
+#include <vector>
+#include <algorithm>
+
+namespace uicore
+{
+	class JsonDocumentImpl : public JsonDocument
+	{
+	public:
+		JsonView root() const override { return JsonView(&root_node); }
+		size_t memory_usage() const override { return node_allocator.memory_usage() + string_allocator.memory_usage(); }
+
+		JsonDocumentNode root_node;
+
+		// Nodes and properties are multiples of 8 bytes in size and share one allocator, keeping them aligned.
+		// Strings have no alignment requirements and are packed into their own.
+		BlockAllocator node_allocator;
+		BlockAllocator string_allocator;
+	};
+
+	class JsonDocumentParser
+	{
+	public:
+		JsonDocumentParser(JsonDocumentImpl *document, const char *data, size_t length) : document(document), data(data), length(length) { }
+
+		void parse();
+
+	private:
+		void read(JsonDocumentNode &node);
+		void read_object(JsonDocumentNode &node);
+		void read_array(JsonDocumentNode &node);
+		void read_string(const char *&out_string, uint32_t &out_length);
+
+		static uint32_t to_count(size_t count);
+		static bool name_less(const JsonDocumentProperty &a, const JsonDocumentProperty &b);
+		static bool name_equal(const JsonDocumentProperty &a, const JsonDocumentProperty &b);
+		static void sort_properties(JsonDocumentProperty *properties, size_t count);
+
+		JsonDocumentImpl *document;
+		const char *data;
+		size_t length;
+		size_t pos = 0;
+
+		// Children are collected here until their parent ends, then copied into the arena in one go
+		std::vector<JsonDocumentNode> item_stack;
+		std::vector<JsonDocumentProperty> property_stack;
+		std::string unescape_buffer;
+	};
+
+	std::shared_ptr<JsonDocument> JsonDocument::parse(const char *json, size_t length)
+	{
+		auto document = std::make_shared<JsonDocumentImpl>();
+		JsonDocumentParser parser(document.get(), json, length);
+		parser.parse();
+		return document;
+	}
+
+	std::shared_ptr<JsonDocument> JsonValue::parse_document(const std::string &json)
+	{
+		return JsonDocument::parse(json);
+	}
+
+	/////////////////////////////////////////////////////////////////////////
+
+	JsonView JsonView::prop(const char *name, size_t length) const
+	{
+		if (!is_object())
+			return JsonView();
+
+		const JsonDocumentProperty *first = node->properties;
+		size_t count = node->count;
+		while (count > 0)
+		{
+			size_t half = count / 2;
+			const JsonDocumentProperty *middle = first + half;
+
+			int result = memcmp(middle->name, name, std::min((size_t)middle->name_length, length));
+			if (result == 0 && middle->name_length == length)
+				return JsonView(&middle->value);
+
+			if (result < 0 || (result == 0 && middle->name_length < length))
+			{
+				first = middle + 1;
+				count -= half + 1;
+			}
+			else
+			{
+				count = half;
+			}
+		}
+		return JsonView();
+	}
+
+	JsonValue JsonView::to_value() const
+	{
+		switch (type())
+		{
+		default:
+		case JsonType::undefined:
+			return JsonValue::undefined();
+		case JsonType::null:
+			return JsonValue::null();
+		case JsonType::number:
+			return JsonValue::number(to_number());
+		case JsonType::boolean:
+			return JsonValue::boolean(to_boolean());
+		case JsonType::string:
+			return JsonValue::string(to_string());
+		case JsonType::array:
+		{
+			JsonValue value = JsonValue::array();
+			value.items().reserve(size());
+			for (JsonView item : items())
+				value.items().push_back(item.to_value());
+			return value;
+		}
+		case JsonType::object:
+		{
+			JsonValue value = JsonValue::object();
+			for (JsonViewProperty property : properties())
+				value.properties().insert(value.properties().end(), std::make_pair(property.name(), property.value().to_value()));
+			return value;
+		}
+		}
+	}
+
+	/////////////////////////////////////////////////////////////////////////
+
+	void JsonDocumentParser::parse()
+	{
+		read(document->root_node);
+		JsonDecoder::read_whitespace(data, length, pos);
+		if (pos != length)
+			throw Exception("Unexpected character in JSON data");
+	}
+
+	void JsonDocumentParser::read(JsonDocumentNode &node)
+	{
+		JsonDecoder::read_whitespace(data, length, pos);
+
+		if (pos == length)
+			throw Exception("Unexpected end of JSON data");
+
+		node.count = 0;
+		node.number = 0.0;
+
+		switch (data[pos])
+		{
+		case '{':
+			node.type = JsonType::object;
+			read_object(node);
+			break;
+		case '[':
+			node.type = JsonType::array;
+			read_array(node);
+			break;
+		case '"':
+			node.type = JsonType::string;
+			read_string(node.string, node.count);
+			break;
+		case '-':
+		case '0':
+		case '1':
+		case '2':
+		case '3':
+		case '4':
+		case '5':
+		case '6':
+		case '7':
+		case '8':
+		case '9':
+			node.type = JsonType::number;
+			node.number = JsonDecoder::read_number(data, length, pos);
+			break;
+		case 'f':
+		case 't':
+			node.type = JsonType::boolean;
+			node.boolean = JsonDecoder::read_boolean(data, length, pos);
+			break;
+		case 'n':
+			node.type = JsonType::null;
+			JsonDecoder::read_null(data, length, pos);
+			break;
+		default:
+			throw Exception("Unexpected character in JSON data");
+		}
+	}
+
+	void JsonDocumentParser::read_object(JsonDocumentNode &node)
+	{
+		size_t start = property_stack.size();
+
+		pos++;
+		JsonDecoder::read_whitespace(data, length, pos);
+
+		if (pos == length)
+			throw Exception("Unexpected end of JSON data");
+
+		while (data[pos] != '}')
+		{
+			if (data[pos] != '"')
+				throw Exception("Unexpected character in JSON data");
+
+			JsonDocumentProperty property;
+			read_string(property.name, property.name_length);
+
+			JsonDecoder::read_whitespace(data, length, pos);
+
+			if (pos == length)
+				throw Exception("Unexpected end of JSON data");
+			else if (data[pos] != ':')
+				throw Exception("Unexpected character in JSON data");
+			pos++;
+
+			read(property.value);
+			property_stack.push_back(property);
+
+			JsonDecoder::read_whitespace(data, length, pos);
+
+			if (pos == length)
+			{
+				throw Exception("Unexpected end of JSON data");
+			}
+			else if (data[pos] == ',')
+			{
+				pos++;
+				JsonDecoder::read_whitespace(data, length, pos);
+				if (pos == length)
+					throw Exception("Unexpected end of JSON data");
+			}
+			else if (data[pos] != '}')
+			{
+				throw Exception("Unexpected character in JSON data");
+			}
+		}
+		pos++;
+
+		size_t count = property_stack.size() - start;
+		if (count > 0)
+		{
+			JsonDocumentProperty *properties = property_stack.data() + start;
+			sort_properties(properties, count);
+
+			// Remove duplicate names. Like JsonValue, the last occurrence wins.
+			size_t unique_count = 0;
+			for (size_t i = 0; i < count; i++)
+			{
+				if (i + 1 < count && name_equal(properties[i], properties[i + 1]))
+					continue;
+				properties[unique_count++] = properties[i];
+			}
+
+			auto storage = static_cast<JsonDocumentProperty*>(document->node_allocator.allocate(sizeof(JsonDocumentProperty) * unique_count));
+			memcpy(storage, properties, sizeof(JsonDocumentProperty) * unique_count);
+			node.properties = storage;
+			node.count = to_count(unique_count);
+		}
+		else
+		{
+			node.properties = nullptr;
+		}
+
+		property_stack.resize(start);
+	}
+
+	void JsonDocumentParser::read_array(JsonDocumentNode &node)
+	{
+		size_t start = item_stack.size();
+
+		pos++;
+		JsonDecoder::read_whitespace(data, length, pos);
+
+		if (pos == length)
+			throw Exception("Unexpected end of JSON data");
+
+		while (data[pos] != ']')
+		{
+			JsonDocumentNode item;
+			read(item);
+			item_stack.push_back(item);
+
+			JsonDecoder::read_whitespace(data, length, pos);
+
+			if (pos == length)
+			{
+				throw Exception("Unexpected end of JSON data");
+			}
+			else if (data[pos] == ',')
+			{
+				pos++;
+				JsonDecoder::read_whitespace(data, length, pos);
+				if (pos == length)
+					throw Exception("Unexpected end of JSON data");
+			}
+			else if (data[pos] != ']')
+			{
+				throw Exception("Unexpected character in JSON data");
+			}
+		}
+		pos++;
+
+		size_t count = item_stack.size() - start;
+		if (count > 0)
+		{
+			auto storage = static_cast<JsonDocumentNode*>(document->node_allocator.allocate(sizeof(JsonDocumentNode) * count));
+			memcpy(storage, item_stack.data() + start, sizeof(JsonDocumentNode) * count);
+			node.items = storage;
+			node.count = to_count(count);
+		}
+		else
+		{
+			node.items = nullptr;
+		}
+
+		item_stack.resize(start);
+	}
+
+	void JsonDocumentParser::read_string(const char *&out_string, uint32_t &out_length)
+	{
+		const char *source;
+		size_t source_length;
+		if (!JsonDecoder::read_raw_string(data, length, pos, source, source_length))
+		{
+			JsonDecoder::read_string(data, length, pos, unescape_buffer);
+			source = unescape_buffer.data();
+			source_length = unescape_buffer.length();
+		}
+
+		char *storage = static_cast<char*>(document->string_allocator.allocate(to_count(source_length + 1)));
+		memcpy(storage, source, source_length);
+		storage[source_length] = 0;
+
+		out_string = storage;
+		out_length = to_count(source_length);
+	}
+
+	uint32_t JsonDocumentParser::to_count(size_t count)
+	{
+		if (count > 0x7fffffff)
+			throw Exception("JSON node too large");
+		return static_cast<uint32_t>(count);
+	}
+
+	bool JsonDocumentParser::name_less(const JsonDocumentProperty &a, const JsonDocumentProperty &b)
+	{
+		int result = memcmp(a.name, b.name, std::min(a.name_length, b.name_length));
+		return result < 0 || (result == 0 && a.name_length < b.name_length);
+	}
+
+	bool JsonDocumentParser::name_equal(const JsonDocumentProperty &a, const JsonDocumentProperty &b)
+	{
+		return a.name_length == b.name_length && memcmp(a.name, b.name, a.name_length) == 0;
+	}
+
+	void JsonDocumentParser::sort_properties(JsonDocumentProperty *properties, size_t count)
+	{
+		// The sort must be stable for duplicate names to resolve to the last occurrence.
+		// Most objects are small, where an insertion sort avoids the temporary buffer std::stable_sort allocates.
+		if (count <= 16)
+		{
+			for (size_t i = 1; i < count; i++)
+			{
+				JsonDocumentProperty property = properties[i];
+				size_t j = i;
+				while (j > 0 && name_less(property, properties[j - 1]))
+				{
+					properties[j] = properties[j - 1];
+					j--;
+				}
+				properties[j] = property;
+			}
+		}
+		else
+		{
+			std::stable_sort(properties, properties + count, &JsonDocumentParser::name_less);
+		}
+	}
+}
@@ -0,0 +1,361 @@
+/*
+**  UICore
+**  Copyright (c) 1997-2015 The UICore Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries UICore may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+#include "UICore/precomp.h"
+#include "json_number_format.h"
+#include <cstdint>
+
+namespace uicore
+{
+	class JsonDiyFp
+	{
+	public:
+		JsonDiyFp() { }
+		JsonDiyFp(uint64_t f, int e) : f(f), e(e) { }
+
+		explicit JsonDiyFp(double d)
+		{
+			uint64_t bits;
+			memcpy(&bits, &d, sizeof(double));
+			int biased_e = static_cast<int>((bits & exponent_mask) >> significand_size);
+			uint64_t significand = bits & significand_mask;
+			if (biased_e != 0)
+			{
+				f = significand + hidden_bit;
+				e = biased_e - exponent_bias;
+			}
+			else
+			{
+				f = significand;
+				e = 1 - exponent_bias;
+			}
+		}
+
+		JsonDiyFp operator-(const JsonDiyFp &rhs) const { return JsonDiyFp(f - rhs.f, e); }
+
+		JsonDiyFp operator*(const JsonDiyFp &rhs) const
+		{
+			// Upper 64 bits of the 128 bit product, rounded
+			const uint64_t mask32 = 0xffffffff;
+			uint64_t a = f >> 32;
+			uint64_t b = f & mask32;
+			uint64_t c = rhs.f >> 32;
+			uint64_t d = rhs.f & mask32;
+			uint64_t ac = a * c;
+			uint64_t bc = b * c;
+			uint64_t ad = a * d;
+			uint64_t bd = b * d;
+			uint64_t tmp = (bd >> 32) + (ad & mask32) + (bc & mask32);
+			tmp += 1U << 31;
+			return JsonDiyFp(ac + (ad >> 32) + (bc >> 32) + (tmp >> 32), e + rhs.e + 64);
+		}
+
+		JsonDiyFp normalize() const
+		{
+			JsonDiyFp res = *this;
+			while (!(res.f & (hidden_bit << 11)))
+			{
+				res.f <<= 1;
+				res.e--;
+			}
+			return res;
+		}
+
+		JsonDiyFp normalize_boundary() const
+		{
+			JsonDiyFp res = *this;
+			while (!(res.f & (hidden_bit << 1)))
+			{
+				res.f <<= 1;
+				res.e--;
+			}
+			res.f <<= 64 - significand_size - 2;
+			res.e -= 64 - significand_size - 2;
+			return res;
+		}
+
+		void normalized_boundaries(JsonDiyFp &minus, JsonDiyFp &plus) const
+		{
+			JsonDiyFp pl = JsonDiyFp((f << 1) + 1, e - 1).normalize_boundary();
+			JsonDiyFp mi = (f == hidden_bit) ? JsonDiyFp((f << 2) - 1, e - 2) : JsonDiyFp((f << 1) - 1, e - 1);
+			mi.f <<= mi.e - pl.e;
+			mi.e = pl.e;
+			plus = pl;
+			minus = mi;
+		}
+
+		uint64_t f = 0;
+		int e = 0;
+
+		static const int significand_size = 52;
+		static const int exponent_bias = 0x3ff + significand_size;
+		static const uint64_t exponent_mask = 0x7ff0000000000000ULL;
+		static const uint64_t significand_mask = 0x000fffffffffffffULL;
+		static const uint64_t hidden_bit = 0x0010000000000000ULL;
+	};
+
+	class JsonGrisu
+	{
+	public:
+		static JsonDiyFp cached_power(int e, int &k);
+		static void digit_gen(const JsonDiyFp &w, const JsonDiyFp &mp, uint64_t delta, char *buffer, int &length, int &k);
+		static void round(char *buffer, int length, uint64_t delta, uint64_t rest, uint64_t ten_kappa, uint64_t wp_w);
+		static int count_decimal_digits(uint32_t n);
+		static int prettify(char *buffer, int length, int k);
+		static int write_exponent(int k, char *buffer);
+
+		static const uint64_t pow10[20];
+	};
+
+	const uint64_t JsonGrisu::pow10[20] =
+	{
+		1ULL, 10ULL, 100ULL, 1000ULL, 10000ULL, 100000ULL, 1000000ULL, 10000000ULL, 100000000ULL, 1000000000ULL,
+		10000000000ULL, 100000000000ULL, 1000000000000ULL, 10000000000000ULL, 100000000000000ULL, 1000000000000000ULL,
+		10000000000000000ULL, 100000000000000000ULL, 1000000000000000000ULL, 10000000000000000000ULL
+	};
+
+	int JsonNumberFormat::format(double value, char *buffer)
+	{
+		int length = 0;
+		if (value < 0)
+		{
+			buffer[length++] = '-';
+			value = -value;
+		}
+
+		if (value == 0.0)
+		{
+			buffer[length++] = '0';
+			return length;
+		}
+
+		JsonDiyFp v(value);
+		JsonDiyFp w_m, w_p;
+		v.normalized_boundaries(w_m, w_p);
+
+		int k = 0;
+		const JsonDiyFp c_mk = JsonGrisu::cached_power(w_p.e, k);
+		const JsonDiyFp w = v.normalize() * c_mk;
+		JsonDiyFp wp = w_p * c_mk;
+		JsonDiyFp wm = w_m * c_mk;
+		wm.f++;
+		wp.f--;
+
+		int digits = 0;
+		JsonGrisu::digit_gen(w, wp, wp.f - wm.f, buffer + length, digits, k);
+		return length + JsonGrisu::prettify(buffer + length, digits, k);
+	}
+
+	JsonDiyFp JsonGrisu::cached_power(int e, int &k)
+	{
+		// Normalized 64 bit significands and binary exponents of 10^-348, 10^-340, ..., 10^340
+		static const uint64_t cached_powers_f[] =
+		{
+			0xfa8fd5a0081c0288ULL, 0xbaaee17fa23ebf76ULL, 0x8b16fb203055ac76ULL, 0xcf42894a5dce35eaULL,
+			0x9a6bb0aa55653b2dULL, 0xe61acf033d1a45dfULL, 0xab70fe17c79ac6caULL, 0xff77b1fcbebcdc4fULL,
+			0xbe5691ef416bd60cULL, 0x8dd01fad907ffc3cULL, 0xd3515c2831559a83ULL, 0x9d71ac8fada6c9b5ULL,
+			0xea9c227723ee8bcbULL, 0xaecc49914078536dULL, 0x823c12795db6ce57ULL, 0xc21094364dfb5637ULL,
+			0x9096ea6f3848984fULL, 0xd77485cb25823ac7ULL, 0xa086cfcd97bf97f4ULL, 0xef340a98172aace5ULL,
+			0xb23867fb2a35b28eULL, 0x84c8d4dfd2c63f3bULL, 0xc5dd44271ad3cdbaULL, 0x936b9fcebb25c996ULL,
+			0xdbac6c247d62a584ULL, 0xa3ab66580d5fdaf6ULL, 0xf3e2f893dec3f126ULL, 0xb5b5ada8aaff80b8ULL,
+			0x87625f056c7c4a8bULL, 0xc9bcff6034c13053ULL, 0x964e858c91ba2655ULL, 0xdff9772470297ebdULL,
+			0xa6dfbd9fb8e5b88fULL, 0xf8a95fcf88747d94ULL, 0xb94470938fa89bcfULL, 0x8a08f0f8bf0f156bULL,
+			0xcdb02555653131b6ULL, 0x993fe2c6d07b7facULL, 0xe45c10c42a2b3b06ULL, 0xaa242499697392d3ULL,
+			0xfd87b5f28300ca0eULL, 0xbce5086492111aebULL, 0x8cbccc096f5088ccULL, 0xd1b71758e219652cULL,
+			0x9c40000000000000ULL, 0xe8d4a51000000000ULL, 0xad78ebc5ac620000ULL, 0x813f3978f8940984ULL,
+			0xc097ce7bc90715b3ULL, 0x8f7e32ce7bea5c70ULL, 0xd5d238a4abe98068ULL, 0x9f4f2726179a2245ULL,
+			0xed63a231d4c4fb27ULL, 0xb0de65388cc8ada8ULL, 0x83c7088e1aab65dbULL, 0xc45d1df942711d9aULL,
+			0x924d692ca61be758ULL, 0xda01ee641a708deaULL, 0xa26da3999aef774aULL, 0xf209787bb47d6b85ULL,
+			0xb454e4a179dd1877ULL, 0x865b86925b9bc5c2ULL, 0xc83553c5c8965d3dULL, 0x952ab45cfa97a0b3ULL,
+			0xde469fbd99a05fe3ULL, 0xa59bc234db398c25ULL, 0xf6c69a72a3989f5cULL, 0xb7dcbf5354e9beceULL,
+			0x88fcf317f22241e2ULL, 0xcc20ce9bd35c78a5ULL, 0x98165af37b2153dfULL, 0xe2a0b5dc971f303aULL,
+			0xa8d9d1535ce3b396ULL, 0xfb9b7cd9a4a7443cULL, 0xbb764c4ca7a44410ULL, 0x8bab8eefb6409c1aULL,
+			0xd01fef10a657842cULL, 0x9b10a4e5e9913129ULL, 0xe7109bfba19c0c9dULL, 0xac2820d9623bf429ULL,
+			0x80444b5e7aa7cf85ULL, 0xbf21e44003acdd2dULL, 0x8e679c2f5e44ff8fULL, 0xd433179d9c8cb841ULL,
+			0x9e19db92b4e31ba9ULL, 0xeb96bf6ebadf77d9ULL, 0xaf87023b9bf0ee6bULL
+		};
+		static const int16_t cached_powers_e[] =
+		{
+			-1220, -1193, -1166, -1140, -1113, -1087, -1060, -1034, -1007, -980,
+			-954, -927, -901, -874, -847, -821, -794, -768, -741, -715,
+			-688, -661, -635, -608, -582, -555, -529, -502, -475, -449,
+			-422, -396, -369, -343, -316, -289, -263, -236, -210, -183,
+			-157, -130, -103, -77, -50, -24, 3, 30, 56, 83,
+			109, 136, 162, 189, 216, 242, 269, 295, 322, 348,
+			375, 402, 428, 455, 481, 508, 534, 561, 588, 614,
+			641, 667, 694, 720, 747, 774, 800, 827, 853, 880,
+			907, 933, 960, 986, 1013, 1039, 1066
+		};
+
+		double dk = (-61 - e) * 0.30102999566398114 + 347;
+		int ik = static_cast<int>(dk);
+		if (dk - ik > 0.0)
+			ik++;
+
+		unsigned index = static_cast<unsigned>((ik >> 3) + 1);
+		k = -(-348 + static_cast<int>(index << 3));
+		return JsonDiyFp(cached_powers_f[index], cached_powers_e[index]);
+	}
+
+	void JsonGrisu::digit_gen(const JsonDiyFp &w, const JsonDiyFp &mp, uint64_t delta, char *buffer, int &length, int &k)
+	{
+		const JsonDiyFp one(uint64_t(1) << -mp.e, mp.e);
+		const JsonDiyFp wp_w = mp - w;
+		uint32_t p1 = static_cast<uint32_t>(mp.f >> -one.e);
+		uint64_t p2 = mp.f & (one.f - 1);
+		int kappa = count_decimal_digits(p1);
+		length = 0;
+
+		while (kappa > 0)
+		{
+			uint32_t divisor = static_cast<uint32_t>(pow10[kappa - 1]);
+			uint32_t d = p1 / divisor;
+			p1 %= divisor;
+			if (d || length)
+				buffer[length++] = static_cast<char>('0' + d);
+			kappa--;
+
+			uint64_t tmp = (static_cast<uint64_t>(p1) << -one.e) + p2;
+			if (tmp <= delta)
+			{
+				k += kappa;
+				round(buffer, length, delta, tmp, pow10[kappa] << -one.e, wp_w.f);
+				return;
+			}
+		}
+
+		while (true)
+		{
+			p2 *= 10;
+			delta *= 10;
+			char d = static_cast<char>(p2 >> -one.e);
+			if (d || length)
+				buffer[length++] = static_cast<char>('0' + d);
+			p2 &= one.f - 1;
+			kappa--;
+			if (p2 < delta)
+			{
+				k += kappa;
+				int index = -kappa;
+				round(buffer, length, delta, p2, one.f, wp_w.f * (index < 20 ? pow10[index] : 0));
+				return;
+			}
+		}
+	}
+
+	void JsonGrisu::round(char *buffer, int length, uint64_t delta, uint64_t rest, uint64_t ten_kappa, uint64_t wp_w)
+	{
+		while (rest < wp_w && delta - rest >= ten_kappa && (rest + ten_kappa < wp_w || wp_w - rest > rest + ten_kappa - wp_w))
+		{
+			buffer[length - 1]--;
+			rest += ten_kappa;
+		}
+	}
+
+	int JsonGrisu::count_decimal_digits(uint32_t n)
+	{
+		int digits = 1;
+		while (digits < 10 && n >= pow10[digits])
+			digits++;
+		return digits;
+	}
+
+	int JsonGrisu::prettify(char *buffer, int length, int k)
+	{
+		// The value is digits * 10^k, and 10^(kk-1) <= value < 10^kk
+		const int kk = length + k;
+
+		if (k >= 0 && kk <= 21)
+		{
+			// 1234e7 -> 12340000000
+			for (int i = length; i < kk; i++)
+				buffer[i] = '0';
+			return kk;
+		}
+		else if (kk > 0 && kk <= 21)
+		{
+			// 1234e-2 -> 12.34
+			memmove(&buffer[kk + 1], &buffer[kk], length - kk);
+			buffer[kk] = '.';
+			return length + 1;
+		}
+		else if (kk > -6 && kk <= 0)
+		{
+			// 1234e-6 -> 0.001234
+			const int offset = 2 - kk;
+			memmove(&buffer[offset], &buffer[0], length);
+			buffer[0] = '0';
+			buffer[1] = '.';
+			for (int i = 2; i < offset; i++)
+				buffer[i] = '0';
+			return length + offset;
+		}
+		else if (length == 1)
+		{
+			// 1e30
+			buffer[1] = 'e';
+			return 2 + write_exponent(kk - 1, &buffer[2]);
+		}
+		else
+		{
+			// 1234e30 -> 1.234e33
+			memmove(&buffer[2], &buffer[1], length - 1);
+			buffer[1] = '.';
+			buffer[length + 1] = 'e';
+			return length + 2 + write_exponent(kk - 1, &buffer[length + 2]);
+		}
+	}
+
+	int JsonGrisu::write_exponent(int k, char *buffer)
+	{
+		int length = 0;
+		if (k < 0)
+		{
+			buffer[length++] = '-';
+			k = -k;
+		}
+
+		if (k >= 100)
+		{
+			buffer[length++] = static_cast<char>('0' + k / 100);
+			k %= 100;
+			buffer[length++] = static_cast<char>('0' + k / 10);
+			buffer[length++] = static_cast<char>('0' + k % 10);
+		}
+		else if (k >= 10)
+		{
+			buffer[length++] = static_cast<char>('0' + k / 10);
+			buffer[length++] = static_cast<char>('0' + k % 10);
+		}
+		else
+		{
+			buffer[length++] = static_cast<char>('0' + k);
+		}
+		return length;
+	}
+}
@@ -0,0 +1,457 @@
+/*
+**  UICore
+**  Copyright (c) 1997-2015 The UICore Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries UICore may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+#include "UICore/precomp.h"
+#include "UICore/Core/Json/json_reader.h"
+#include "UICore/Core/IOData/iodevice.h"
+#include "UICore/Core/IOData/mapped_file.h"
+#include "json_decoder.h"
+#include <vector>
+#include <algorithm>
+
+namespace uicore
+{
+	class JsonReaderImpl : public JsonReader
+	{
+	public:
+		JsonReaderImpl(const IODevicePtr &input, size_t buffer_size) : mapped_file(std::dynamic_pointer_cast<MappedFile>(input))
+		{
+			if (mapped_file)
+			{
+				// Read memory mapped files in place
+				long long start = std::min(mapped_file->position(), mapped_file->size());
+				data = mapped_file->data() + start;
+				end = (size_t)(mapped_file->size() - start);
+			}
+			else
+			{
+				this->input = input;
+				buffer.resize(std::max(buffer_size, (size_t)16));
+				data = buffer.data();
+			}
+		}
+
+		JsonReaderImpl(const char *data, size_t length) : data(data), end(length)
+		{
+		}
+
+		JsonReaderToken next() override;
+		JsonReaderToken token() const override { return current_token; }
+		size_t depth() const override { return stack.size(); }
+		const std::string &text() const override { return token_text; }
+		double number() const override { return token_number; }
+		bool boolean() const override { return token_boolean; }
+		void skip() override;
+		JsonValue read_value() override;
+
+	private:
+		enum class State
+		{
+			value,
+			first_item,
+			first_property,
+			property,
+			colon,
+			after_value
+		};
+
+		bool read_whitespace();
+		bool fill(size_t &offset);
+		void read_string();
+		void read_number();
+		void read_literal(size_t literal_length);
+		void skip_container();
+		JsonValue read_container_value();
+
+		IODevicePtr input;
+		MappedFilePtr mapped_file;
+		std::vector<char> buffer;
+		const char *data = nullptr;
+		size_t pos = 0;
+		size_t end = 0;
+
+		State state = State::value;
+		std::vector<char> stack;
+
+		JsonReaderToken current_token = JsonReaderToken::end_of_document;
+		std::string token_text;
+		double token_number = 0.0;
+		bool token_boolean = false;
+	};
+
+	std::shared_ptr<JsonReader> JsonReader::create(const IODevicePtr &input, size_t buffer_size)
+	{
+		return std::make_shared<JsonReaderImpl>(input, buffer_size);
+	}
+
+	std::shared_ptr<JsonReader> JsonReader::create(const char *data, size_t length)
+	{
+		return std::make_shared<JsonReaderImpl>(data, length);
+	}
+
+	JsonReaderToken JsonReaderImpl::next()
+	{
+		while (true)
+		{
+			if (!read_whitespace())
+			{
+				if (state == State::after_value && stack.empty())
+				{
+					current_token = JsonReaderToken::end_of_document;
+					return current_token;
+				}
+				throw Exception("Unexpected end of JSON data");
+			}
+
+			char c = data[pos];
+			switch (state)
+			{
+			case State::colon:
+				if (c != ':')
+					throw Exception("Unexpected character in JSON data");
+				pos++;
+				state = State::value;
+				continue;
+
+			case State::after_value:
+				if (stack.empty())
+				{
+					// Another top-level value follows
+					state = State::value;
+					continue;
+				}
+				else if (c == ',')
+				{
+					pos++;
+					state = stack.back() == '{' ? State::property : State::value;
+					continue;
+				}
+				else if (c == '}' && stack.back() == '{')
+				{
+					pos++;
+					stack.pop_back();
+					current_token = JsonReaderToken::end_object;
+					return current_token;
+				}
+				else if (c == ']' && stack.back() == '[')
+				{
+					pos++;
+					stack.pop_back();
+					current_token = JsonReaderToken::end_array;
+					return current_token;
+				}
+				throw Exception("Unexpected character in JSON data");
+
+			case State::first_property:
+				if (c == '}')
+				{
+					pos++;
+					stack.pop_back();
+					state = State::after_value;
+					current_token = JsonReaderToken::end_object;
+					return current_token;
+				}
+				// Fall through
+			case State::property:
+				if (c != '"')
+					throw Exception("Unexpected character in JSON data");
+				read_string();
+				state = State::colon;
+				current_token = JsonReaderToken::property_name;
+				return current_token;
+
+			case State::first_item:
+				if (c == ']')
+				{
+					pos++;
+					stack.pop_back();
+					state = State::after_value;
+					current_token = JsonReaderToken::end_array;
+					return current_token;
+				}
+				// Fall through
+			case State::value:
+				switch (c)
+				{
+				case '{':
+					pos++;
+					stack.push_back('{');
+					state = State::first_property;
+					current_token = JsonReaderToken::start_object;
+					return current_token;
+				case '[':
+					pos++;
+					stack.push_back('[');
+					state = State::first_item;
+					current_token = JsonReaderToken::start_array;
+					return current_token;
+				case '"':
+					read_string();
+					current_token = JsonReaderToken::string;
+					break;
+				case '-':
+				case '0':
+				case '1':
+				case '2':
+				case '3':
+				case '4':
+				case '5':
+				case '6':
+				case '7':
+				case '8':
+				case '9':
+					read_number();
+					current_token = JsonReaderToken::number;
+					break;
+				case 't':
+					read_literal(4);
+					token_boolean = JsonDecoder::read_boolean(data, end, pos);
+					current_token = JsonReaderToken::boolean;
+					break;
+				case 'f':
+					read_literal(5);
+					token_boolean = JsonDecoder::read_boolean(data, end, pos);
+					current_token = JsonReaderToken::boolean;
+					break;
+				case 'n':
+					read_literal(4);
+					JsonDecoder::read_null(data, end, pos);
+					current_token = JsonReaderToken::null;
+					break;
+				default:
+					throw Exception("Unexpected character in JSON data");
+				}
+				state = State::after_value;
+				return current_token;
+			}
+		}
+	}
+
+	void JsonReaderImpl::skip()
+	{
+		if (current_token == JsonReaderToken::property_name)
+		{
+			next();
+		}
+
+		if (current_token == JsonReaderToken::start_object || current_token == JsonReaderToken::start_array)
+		{
+			skip_container();
+		}
+	}
+
+	JsonValue JsonReaderImpl::read_value()
+	{
+		if (current_token == JsonReaderToken::property_name)
+			next();
+
+		switch (current_token)
+		{
+		case JsonReaderToken::start_object:
+		case JsonReaderToken::start_array:
+			return read_container_value();
+		case JsonReaderToken::string:
+			return JsonValue::string(token_text);
+		case JsonReaderToken::number:
+			return JsonValue::number(token_number);
+		case JsonReaderToken::boolean:
+			return JsonValue::boolean(token_boolean);
+		case JsonReaderToken::null:
+			return JsonValue::null();
+		default:
+			return JsonValue::undefined();
+		}
+	}
+
+	JsonValue JsonReaderImpl::read_container_value()
+	{
+		if (current_token == JsonReaderToken::start_array)
+		{
+			JsonValue result = JsonValue::array();
+			while (next() != JsonReaderToken::end_array)
+				result.items().push_back(read_value());
+			return result;
+		}
+		else
+		{
+			JsonValue result = JsonValue::object();
+			while (next() != JsonReaderToken::end_object)
+			{
+				std::string name = token_text;
+				result.prop(name) = read_value();
+			}
+			return result;
+		}
+	}
+
+	void JsonReaderImpl::skip_container()
+	{
+		// Scan for the matching end bracket without decoding anything. Only strings need tracking, as they may contain brackets.
+		size_t start_depth = stack.size();
+		size_t level = 1;
+		bool in_string = false;
+		while (true)
+		{
+			if (pos == end)
+			{
+				size_t offset = pos;
+				if (!fill(offset))
+					throw Exception("Unexpected end of JSON data");
+			}
+
+			char c = data[pos++];
+			if (in_string)
+			{
+				if (c == '\\')
+				{
+					if (pos == end)
+					{
+						size_t offset = pos;
+						if (!fill(offset))
+							throw Exception("Unexpected end of JSON data");
+					}
+					pos++;
+				}
+				else if (c == '"')
+				{
+					in_string = false;
+				}
+			}
+			else if (c == '"')
+			{
+				in_string = true;
+			}
+			else if (c == '{' || c == '[')
+			{
+				level++;
+			}
+			else if (c == '}' || c == ']')
+			{
+				level--;
+				if (level == 0)
+					break;
+			}
+		}
+
+		current_token = stack.back() == '{' ? JsonReaderToken::end_object : JsonReaderToken::end_array;
+		stack.resize(start_depth - 1);
+		state = State::after_value;
+	}
+
+	bool JsonReaderImpl::read_whitespace()
+	{
+		while (true)
+		{
+			JsonDecoder::read_whitespace(data, end, pos);
+			if (pos != end)
+				return true;
+
+			size_t offset = pos;
+			if (!fill(offset))
+				return false;
+		}
+	}
+
+	bool JsonReaderImpl::fill(size_t &offset)
+	{
+		// Moves the unread data to the front of the buffer and reads more. offset is a position in the buffer that is adjusted accordingly.
+		if (!input)
+			return false;
+
+		if (pos > 0)
+		{
+			memmove(buffer.data(), buffer.data() + pos, end - pos);
+			offset -= pos;
+			end -= pos;
+			pos = 0;
+		}
+
+		if (end == buffer.size())
+		{
+			buffer.resize(buffer.size() * 2);
+			data = buffer.data();
+		}
+
+		int bytes_read = input->try_read(buffer.data() + end, (int)std::min(buffer.size() - end, (size_t)0x40000000));
+		if (bytes_read <= 0)
+			return false;
+		end += bytes_read;
+		return true;
+	}
+
+	void JsonReaderImpl::read_string()
+	{
+		// Find the closing quote first, so that the decoder is given the complete string
+		size_t i = pos + 1;
+		while (true)
+		{
+			while (i >= end)
+			{
+				if (!fill(i))
+					throw Exception("Unexpected end of JSON data");
+			}
+
+			char c = data[i];
+			if (c == '"')
+				break;
+			i += (c == '\\') ? 2 : 1;
+		}
+
+		JsonDecoder::read_string(data, i + 1, pos, token_text);
+	}
+
+	void JsonReaderImpl::read_number()
+	{
+		size_t i = pos;
+		while (true)
+		{
+			if (i == end && !fill(i))
+				break;
+
+			char c = data[i];
+			if ((c >= '0' && c <= '9') || c == '-' || c == '+' || c == '.' || c == 'e' || c == 'E')
+				i++;
+			else
+				break;
+		}
+
+		token_number = JsonDecoder::read_number(data, i, pos);
+		if (pos != i)
+			throw Exception("Unexpected character in JSON data");
+	}
+
+	void JsonReaderImpl::read_literal(size_t literal_length)
+	{
+		size_t i = pos;
+		while (end - pos < literal_length)
+		{
+			if (!fill(i))
+				throw Exception("Unexpected end of JSON data");
+		}
+	}
+}
@@ -0,0 +1,331 @@
+/*
+**  UICore
+**  Copyright (c) 1997-2015 The UICore Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries UICore may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+#include "UICore/precomp.h"
+#include "UICore/Core/Json/json_writer.h"
+#include "UICore/Core/IOData/iodevice.h"
+#include "json_writer_impl.h"
+#include "json_number_format.h"
+#include <cmath>
+
+#ifndef CL_DISABLE_SSE2
+#ifndef ARM_PLATFORM
+#include <emmintrin.h>
+#define JSON_WRITER_SSE2
+#endif
+#endif
+
+namespace uicore
+{
+	std::shared_ptr<JsonWriter> JsonWriter::create()
+	{
+		return std::make_shared<JsonWriterImpl>();
+	}
+
+	std::shared_ptr<JsonWriter> JsonWriter::create(const IODevicePtr &output)
+	{
+		return std::make_shared<JsonWriterImpl>(output);
+	}
+
+	/////////////////////////////////////////////////////////////////////////
+
+	JsonWriterImpl::JsonWriterImpl(const IODevicePtr &output) : output(output)
+	{
+		if (output)
+			buffer.reserve(flush_size + flush_size / 4);
+	}
+
+	JsonWriterImpl::~JsonWriterImpl()
+	{
+		try
+		{
+			flush();
+		}
+		catch (...)
+		{
+		}
+	}
+
+	void JsonWriterImpl::flush()
+	{
+		if (output && !buffer.empty())
+		{
+			output->write(buffer.data(), (int)buffer.size());
+			buffer.clear();
+		}
+	}
+
+	void JsonWriterImpl::value(const JsonValue &value)
+	{
+		switch (value.type())
+		{
+		case JsonType::null:
+			null();
+			break;
+		case JsonType::object:
+			begin_object();
+			for (const auto &it : value.properties())
+			{
+				// Undefined values have no JSON representation, so leave out the member entirely
+				if (it.second.is_undefined())
+					continue;
+				name(it.first);
+				this->value(it.second);
+			}
+			end_object();
+			break;
+		case JsonType::array:
+			begin_array();
+			for (const auto &item : value.items())
+			{
+				if (!item.is_undefined())
+					this->value(item);
+			}
+			end_array();
+			break;
+		case JsonType::string:
+			string(value.to_string());
+			break;
+		case JsonType::number:
+			number(value.to_number());
+			break;
+		case JsonType::boolean:
+			boolean(value.to_boolean());
+			break;
+		case JsonType::undefined:
+			break;
+		}
+	}
+
+	void JsonWriterImpl::begin_object()
+	{
+		begin_container('{');
+	}
+
+	void JsonWriterImpl::end_object()
+	{
+		end_container('}');
+	}
+
+	void JsonWriterImpl::begin_array()
+	{
+		begin_container('[');
+	}
+
+	void JsonWriterImpl::end_array()
+	{
+		end_container(']');
+	}
+
+	void JsonWriterImpl::name_value(const char *name, size_t length)
+	{
+		begin_value();
+		write_escaped(name, length, buffer);
+		buffer.push_back(':');
+		if (_insert_whitespace)
+			buffer.push_back(' ');
+		after_name = true;
+	}
+
+	void JsonWriterImpl::string(const char *value, size_t length)
+	{
+		begin_value();
+		write_escaped(value, length, buffer);
+		flush_if_full();
+	}
+
+	void JsonWriterImpl::number(double value)
+	{
+		begin_value();
+		write_number(value, buffer);
+		flush_if_full();
+	}
+
+	void JsonWriterImpl::boolean(bool value)
+	{
+		begin_value();
+		if (value)
+			buffer.append("true", 4);
+		else
+			buffer.append("false", 5);
+		flush_if_full();
+	}
+
+	void JsonWriterImpl::null()
+	{
+		begin_value();
+		buffer.append("null", 4);
+		flush_if_full();
+	}
+
+	void JsonWriterImpl::begin_value()
+	{
+		if (after_name)
+		{
+			after_name = false;
+		}
+		else if (!first_child.empty())
+		{
+			if (!first_child.back())
+				buffer.push_back(',');
+			first_child.back() = false;
+			newline();
+		}
+	}
+
+	void JsonWriterImpl::begin_container(char c)
+	{
+		begin_value();
+		buffer.push_back(c);
+		first_child.push_back(true);
+	}
+
+	void JsonWriterImpl::end_container(char c)
+	{
+		if (first_child.empty())
+			throw Exception("JSON end of container without a beginning");
+
+		bool empty = first_child.back();
+		first_child.pop_back();
+		if (!empty)
+			newline();
+		buffer.push_back(c);
+		flush_if_full();
+	}
+
+	void JsonWriterImpl::newline()
+	{
+		if (_insert_whitespace)
+		{
+			buffer.push_back('\n');
+			buffer.append(first_child.size(), '\t');
+		}
+	}
+
+	void JsonWriterImpl::write_escaped(const char *str, size_t length, std::string &out)
+	{
+		static const char hex[] = "0123456789abcdef";
+
+		out.push_back('"');
+
+		size_t pos = 0;
+		while (pos < length)
+		{
+			// Find the next character that needs escaping and copy everything before it in one go
+			size_t end = pos;
+#ifdef JSON_WRITER_SSE2
+			const __m128i quote = _mm_set1_epi8('"');
+			const __m128i backslash = _mm_set1_epi8('\\');
+			const __m128i control_max = _mm_set1_epi8(0x1f);
+			while (end + 16 <= length)
+			{
+				__m128i chars = _mm_loadu_si128(reinterpret_cast<const __m128i*>(str + end));
+				__m128i is_control = _mm_cmpeq_epi8(_mm_max_epu8(chars, control_max), control_max);
+				__m128i needs_escape = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(chars, quote), _mm_cmpeq_epi8(chars, backslash)), is_control);
+				int mask = _mm_movemask_epi8(needs_escape);
+				if (mask != 0)
+				{
+					while ((mask & 1) == 0)
+					{
+						mask >>= 1;
+						end++;
+					}
+					break;
+				}
+				end += 16;
+			}
+#endif
+			while (end < length)
+			{
+				unsigned char c = str[end];
+				if (c == '"' || c == '\\' || c < 32)
+					break;
+				end++;
+			}
+
+			out.append(str + pos, end - pos);
+			if (end == length)
+				break;
+
+			unsigned char c = str[end];
+			out.push_back('\\');
+			switch (c)
+			{
+			case '"': out.push_back('"'); break;
+			case '\\': out.push_back('\\'); break;
+			case '\b': out.push_back('b'); break;
+			case '\f': out.push_back('f'); break;
+			case '\n': out.push_back('n'); break;
+			case '\r': out.push_back('r'); break;
+			case '\t': out.push_back('t'); break;
+			default:
+				out.append("u00", 3);
+				out.push_back(hex[c >> 4]);
+				out.push_back(hex[c & 15]);
+				break;
+			}
+			pos = end + 1;
+		}
+
+		out.push_back('"');
+	}
+
+	void JsonWriterImpl::write_number(double value, std::string &out)
+	{
+		if (!std::isfinite(value))
+		{
+			out.append("null", 4);
+			return;
+		}
+
+		char buf[32];
+
+		// Integers up to 2^53 are exact in a double and by far the most common numbers
+		if (value == std::floor(value) && std::fabs(value) < 9007199254740992.0)
+		{
+			long long integer = static_cast<long long>(value);
+			unsigned long long magnitude = integer < 0 ? 0 - static_cast<unsigned long long>(integer) : static_cast<unsigned long long>(integer);
+
+			char *end = buf + sizeof(buf);
+			char *p = end;
+			do
+			{
+				*(--p) = '0' + static_cast<char>(magnitude % 10);
+				magnitude /= 10;
+			} while (magnitude != 0);
+			if (integer < 0)
+				*(--p) = '-';
+
+			out.append(p, end - p);
+			return;
+		}
+
+		int length = JsonNumberFormat::format(value, buf);
+		out.append(buf, length);
+	}
+}
@@ -0,0 +1,85 @@
+/*
+**  UICore
+**  Copyright (c) 1997-2015 The UICore Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries UICore may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+#pragma once
+
+#include "UICore/Core/Json/json_writer.h"
+#include <vector>
+
+namespace uicore
+{
+	class JsonWriterImpl : public JsonWriter
+	{
+	public:
+		JsonWriterImpl(const IODevicePtr &output = IODevicePtr());
+		~JsonWriterImpl();
+
+		bool insert_whitespace() const override { return _insert_whitespace; }
+		void set_insert_whitespace(bool enable) override { _insert_whitespace = enable; }
+		void reserve(size_t size) override { buffer.reserve(size); }
+
+		void value(const JsonValue &value) override;
+
+		void begin_object() override;
+		void end_object() override;
+		void begin_array() override;
+		void end_array() override;
+
+		void name(const std::string &name) override { name_value(name.data(), name.length()); }
+		void string(const std::string &value) override { string(value.data(), value.length()); }
+		void string(const char *value, size_t length) override;
+		void number(double value) override;
+		void boolean(bool value) override;
+		void null() override;
+
+		const std::string &result() const override { return buffer; }
+		void flush() override;
+
+		std::string buffer;
+
+		static void write_escaped(const char *str, size_t length, std::string &out);
+		static void write_number(double value, std::string &out);
+
+	private:
+		void name_value(const char *name, size_t length);
+		void begin_value();
+		void begin_container(char c);
+		void end_container(char c);
+		void newline();
+		void flush_if_full() { if (output && buffer.size() >= flush_size) flush(); }
+
+		IODevicePtr output;
+		bool _insert_whitespace = false;
+
+		// One entry per open container, true until the first child has been written
+		std::vector<bool> first_child;
+		bool after_name = false;
+
+		static const size_t flush_size = 64 * 1024;
+	};
+}
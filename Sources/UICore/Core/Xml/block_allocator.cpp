@@ -40,7 +40,12 @@ namespace uicore
 	{
 	public:
 		std::vector<DataBufferPtr> blocks;
+		DataBufferPtr current_block;	// Block serving small allocations. Never a block dedicated to a large allocation
 		int block_pos = 0;
+		size_t allocated = 0;
+
+		// Blocks stop doubling at this size. Allocations bigger than a quarter of it get a block of their own.
+		static const int max_block_size = 1024 * 1024;
 	};
 
 	BlockAllocator::BlockAllocator()
@@ -50,24 +55,48 @@ namespace uicore
 
 	void *BlockAllocator::allocate(int size)
 	{
-		if (impl->blocks.empty())
-			impl->blocks.push_back(DataBuffer::create(size * 10));
-		DataBufferPtr &cur = impl->blocks.back();
-		if (impl->block_pos + size <= (int)cur->size())
+		if (size > BlockAllocator_Impl::max_block_size / 4)
 		{
-			void *data = cur->data() + impl->block_pos;
+			// Give it a block of its own, leaving the current block to continue serving small allocations
+			auto block = DataBuffer::create(size);
+			impl->blocks.push_back(block);
+			impl->allocated += size;
+			return block->data();
+		}
+
+		if (!impl->current_block)
+		{
+			int block_size = std::min(size * 10, (int)BlockAllocator_Impl::max_block_size);
+			impl->current_block = DataBuffer::create(block_size);
+			impl->blocks.push_back(impl->current_block);
+			impl->allocated += block_size;
+			impl->block_pos = 0;
+		}
+		if (impl->block_pos + size <= (int)impl->current_block->size())
+		{
+			void *data = impl->current_block->data() + impl->block_pos;
 			impl->block_pos += size;
 			return data;
 		}
-		impl->blocks.push_back(DataBuffer::create(std::max((int)cur->size() * 2, size)));
+		int block_size = std::max(std::min((int)impl->current_block->size() * 2, (int)BlockAllocator_Impl::max_block_size), size);
+		impl->current_block = DataBuffer::create(block_size);
+		impl->blocks.push_back(impl->current_block);
+		impl->allocated += block_size;
 		impl->block_pos = size;
-		return impl->blocks.back()->data();
+		return impl->current_block->data();
 	}
 
 	void BlockAllocator::free()
 	{
 		impl->blocks.clear();
+		impl->current_block.reset();
 		impl->block_pos = 0;
+		impl->allocated = 0;
+	}
+
+	size_t BlockAllocator::memory_usage() const
+	{
+		return impl->allocated;
 	}
 
 	void *BlockAllocated::operator new(size_t size, BlockAllocator *allocator)
@@ -42,6 +42,9 @@ namespace uicore
 		void *allocate(int size);
 		void free();
 
+		/// \brief Returns the total size of all allocated blocks.
+		size_t memory_usage() const;
+
 	private:
 		std::shared_ptr<BlockAllocator_Impl> impl;
 	};
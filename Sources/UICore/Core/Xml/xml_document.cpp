@@ -32,10 +32,12 @@
 #include "UICore/Core/Xml/xml_tokenizer.h"
 #include "UICore/Core/Xml/xml_writer.h"
 #include "UICore/Core/Xml/xml_token.h"
+#include "UICore/Core/IOData/buffered_iodevice.h"
 #include "xml_node_impl.h"
 #include "xml_document_impl.h"
 #include "xml_tree_node.h"
 #include <stack>
+#include <cstring>
 
 namespace uicore
 {
@@ -48,45 +50,68 @@ namespace uicore
 
 	std::shared_ptr<XmlDocument> XmlDocument::load(const IODevicePtr &input, bool eat_whitespace)
 	{
-		auto doc = XmlDocument::create();
+		auto doc = std::make_shared<XmlDocumentImpl>();
+		doc->node_index = doc->allocate_tree_node(XmlNodeType::document);
 
 		auto tokenizer = XmlTokenizer::create(input);
 		tokenizer->set_eat_whitespace(eat_whitespace);
 
-		std::vector<XmlNodePtr> node_stack;
-		node_stack.push_back(doc);
+		// The tree is built directly from token references, bypassing the DOM node objects:
+		std::vector<unsigned int> node_stack;
+		node_stack.push_back(doc->node_index);
 
-		XmlToken cur_token;
+		std::string scratch;
+		XmlTokenRef cur_token;
 		tokenizer->next(&cur_token);
 		while (cur_token.type != XmlTokenType::null)
 		{
 			switch (cur_token.type)
 			{
 			case XmlTokenType::text:
-				node_stack.back()->append_child(doc->create_text(cur_token.value));
-				break;
-
 			case XmlTokenType::cdata:
-				node_stack.back()->append_child(doc->create_cdata(cur_token.value));
+			case XmlTokenType::comment:
+			{
+				XmlNodeType node_type = XmlNodeType::text;
+				if (cur_token.type == XmlTokenType::cdata)
+					node_type = XmlNodeType::cdata;
+				else if (cur_token.type == XmlTokenType::comment)
+					node_type = XmlNodeType::comment;
+
+				unsigned int index = doc->allocate_tree_node(node_type);
+				XmlTreeNode *tree_node = doc->nodes[index];
+				if (cur_token.value.has_entities)
+				{
+					scratch.clear();
+					cur_token.value.append_to(scratch);
+					tree_node->set_node_value(doc.get(), scratch);
+				}
+				else
+				{
+					tree_node->set_node_value(doc.get(), cur_token.value.data, cur_token.value.length);
+				}
+				doc->append_tree_child(node_stack.back(), index);
 				break;
+			}
 
 			case XmlTokenType::element:
 				if (cur_token.variant != XmlTokenVariant::end)
 				{
-					XmlString namespace_uri = XmlDocumentImpl::find_namespace_uri(cur_token.name, cur_token, node_stack.back());
-					auto element = doc->create_element(namespace_uri, cur_token.name);
-					node_stack.back()->append_child(element);
+					const XmlString *namespace_uri = doc->find_namespace_uri(cur_token.name, cur_token, node_stack.back(), scratch);
+
+					unsigned int element_index = doc->allocate_tree_node(XmlNodeType::element);
+					XmlTreeNode *element = doc->nodes[element_index];
+					element->namespace_uri = namespace_uri;
+					element->node_name = doc->intern(cur_token.name, scratch);
+					doc->append_tree_child(node_stack.back(), element_index);
 
-					int size = (int)cur_token.attributes.size();
-					for (int i = 0; i < size; i++)
+					for (const auto &attribute : cur_token.attributes)
 					{
-						XmlToken::Attribute &attribute = cur_token.attributes[i];
-						XmlString attribute_namespace_uri = XmlDocumentImpl::find_namespace_uri(attribute.first, cur_token, node_stack.back());
-						element->set_attribute(attribute_namespace_uri, attribute.first, attribute.second);
+						const XmlString *attribute_namespace_uri = doc->find_namespace_uri(attribute.first, cur_token, node_stack.back(), scratch);
+						doc->set_tree_attribute(element_index, attribute_namespace_uri, doc->intern(attribute.first, scratch), attribute.second, scratch);
 					}
 
 					if (cur_token.variant == XmlTokenVariant::begin)
-						node_stack.push_back(element);
+						node_stack.push_back(element_index);
 				}
 				else
 				{
@@ -98,10 +123,6 @@ namespace uicore
 			case XmlTokenType::null:
 				break;
 
-			case XmlTokenType::comment:
-				node_stack.back()->append_child(doc->create_comment(cur_token.value));
-				break;
-
 			case XmlTokenType::doctype:
 				break;
 
@@ -330,7 +351,7 @@ namespace uicore
 	{
 		auto element = allocate_dom_node(allocate_tree_node(XmlNodeType::element));
 		auto tree_node = element->get_tree_node();
-		tree_node->node_name = tag_name;
+		tree_node->set_node_name(this, tag_name);
 		return element;
 	}
 
@@ -338,8 +359,8 @@ namespace uicore
 	{
 		auto element = allocate_dom_node(allocate_tree_node(XmlNodeType::element));
 		auto tree_node = element->get_tree_node();
-		tree_node->namespace_uri = namespace_uri;
-		tree_node->node_name = qualified_name;
+		tree_node->set_namespace_uri(this, namespace_uri);
+		tree_node->set_node_name(this, qualified_name);
 		return element;
 	}
 
@@ -352,7 +373,7 @@ namespace uicore
 	{
 		auto text = allocate_dom_node(allocate_tree_node(XmlNodeType::text));
 		auto tree_node = text->get_tree_node();
-		tree_node->node_value = data;
+		tree_node->set_node_value(this, data);
 		return text;
 	}
 
@@ -360,7 +381,7 @@ namespace uicore
 	{
 		auto comment = allocate_dom_node(allocate_tree_node(XmlNodeType::comment));
 		auto tree_node = comment->get_tree_node();
-		tree_node->node_value = data;
+		tree_node->set_node_value(this, data);
 		return comment;
 	}
 
@@ -368,7 +389,7 @@ namespace uicore
 	{
 		auto cdata = allocate_dom_node(allocate_tree_node(XmlNodeType::cdata));
 		auto tree_node = cdata->get_tree_node();
-		tree_node->node_value = data;
+		tree_node->set_node_value(this, data);
 		return cdata;
 	}
 
@@ -376,7 +397,7 @@ namespace uicore
 	{
 		auto attribute = allocate_dom_node(allocate_tree_node(XmlNodeType::attribute));
 		auto tree_node = attribute->get_tree_node();
-		tree_node->node_name = name;
+		tree_node->set_node_name(this, name);
 		return attribute;
 	}
 
@@ -384,8 +405,8 @@ namespace uicore
 	{
 		auto attribute = allocate_dom_node(allocate_tree_node(XmlNodeType::attribute));
 		auto tree_node = attribute->get_tree_node();
-		tree_node->namespace_uri = namespace_uri;
-		tree_node->node_name = qualified_name;
+		tree_node->set_namespace_uri(this, namespace_uri);
+		tree_node->set_node_name(this, qualified_name);
 		return attribute;
 	}
 
@@ -436,7 +457,8 @@ namespace uicore
 
 	void XmlDocumentImpl::save(const IODevicePtr &output, bool insert_whitespace) const
 	{
-		auto writer = XmlWriter::create(output);
+		auto buffered_output = BufferedIODevice::create(output, 0);
+		auto writer = XmlWriter::create(buffered_output);
 		writer->set_insert_whitespace(insert_whitespace);
 
 		std::vector<XmlNodePtr> node_stack;
@@ -498,34 +520,118 @@ namespace uicore
 				node_stack.pop_back();
 			}
 		}
+
+		buffered_output->flush();
+	}
+
+	namespace
+	{
+		bool is_xmlns_attribute(const char *name, size_t name_length, const char *prefix, size_t prefix_length)
+		{
+			if (prefix_length == 0)
+				return name_length == 5 && memcmp(name, "xmlns", 5) == 0;
+			else
+				return name_length == prefix_length + 6 && memcmp(name, "xmlns:", 6) == 0 && memcmp(name + 6, prefix, prefix_length) == 0;
+		}
 	}
 
-	XmlString XmlDocumentImpl::find_namespace_uri(const XmlString &qualified_name, const XmlToken &search_token, const XmlNodePtr &search_node)
+	const XmlString *XmlDocumentImpl::find_namespace_uri(const XmlStringRef &qualified_name, const XmlTokenRef &search_token, unsigned int search_node_index, std::string &scratch)
 	{
-		static XmlString xmlns_prefix("xmlns:");
-		XmlString name = qualified_name;
-		XmlString prefix;
-		XmlString::size_type pos = name.find(':');
-		if (pos != XmlString::npos)
-			prefix = name.substr(0, pos);
+		const char *colon = static_cast<const char *>(memchr(qualified_name.data, ':', qualified_name.length));
+		const char *prefix = qualified_name.data;
+		size_t prefix_length = colon ? colon - qualified_name.data : 0;
+
+		for (const auto &attribute : search_token.attributes)
+		{
+			if (is_xmlns_attribute(attribute.first.data, attribute.first.length, prefix, prefix_length))
+				return intern(attribute.second, scratch);
+		}
+
+		// Same lookup as XmlNodeImpl::find_namespace_uri, but without creating DOM nodes for the ancestors:
+
+		if (search_node_index == node_index)
+			return nullptr;
+
+		if (prefix_length == 3 && memcmp(prefix, "xml", 3) == 0)
+			return strings.intern("xml", 3);
+		else if ((prefix_length == 5 && memcmp(prefix, "xmlns", 5) == 0) || qualified_name == "xmlns")
+			return strings.intern("xmlns", 5);
 
-		int size = (int)search_token.attributes.size();
-		for (int i = 0; i < size; i++)
+		for (const XmlTreeNode *cur = nodes[search_node_index]; cur; cur = cur->get_parent(this))
 		{
-			if (prefix.empty())
+			for (const XmlTreeNode *cur_attr = cur->get_first_attribute(this); cur_attr; cur_attr = cur_attr->get_next_sibling(this))
 			{
-				if (search_token.attributes[i].first == "xmlns")
-					return search_token.attributes[i].second;
+				const XmlString &name = cur_attr->get_node_name();
+				if (is_xmlns_attribute(name.data(), name.length(), prefix, prefix_length))
+					return strings.intern(cur_attr->node_value, cur_attr->node_value_length);
 			}
-			else
+		}
+		return nullptr;
+	}
+
+	const XmlString *XmlDocumentImpl::intern(const XmlStringRef &str, std::string &scratch)
+	{
+		if (!str.has_entities)
+			return strings.intern(str.data, str.length);
+
+		scratch.clear();
+		str.append_to(scratch);
+		return strings.intern(scratch);
+	}
+
+	void XmlDocumentImpl::append_tree_child(unsigned int parent_index, unsigned int child_index)
+	{
+		XmlTreeNode *tree_node = nodes[parent_index];
+		XmlTreeNode *new_tree_node = nodes[child_index];
+		if (tree_node->last_child != cl_null_node_index)
+		{
+			tree_node->get_last_child(this)->next_sibling = child_index;
+			new_tree_node->previous_sibling = tree_node->last_child;
+			tree_node->last_child = child_index;
+		}
+		else
+		{
+			tree_node->first_child = child_index;
+			tree_node->last_child = child_index;
+		}
+		new_tree_node->parent = parent_index;
+	}
+
+	void XmlDocumentImpl::set_tree_attribute(unsigned int element_index, const XmlString *namespace_uri, const XmlString *name, const XmlStringRef &value, std::string &scratch)
+	{
+		XmlTreeNode *element = nodes[element_index];
+
+		unsigned int attribute_index = element->first_attribute;
+		while (attribute_index != cl_null_node_index && (nodes[attribute_index]->node_name != name || nodes[attribute_index]->namespace_uri != namespace_uri))
+			attribute_index = nodes[attribute_index]->next_sibling;
+
+		if (attribute_index == cl_null_node_index)
+		{
+			// New attributes are inserted first, like XmlNodeImpl::add_attribute does
+			attribute_index = allocate_tree_node(XmlNodeType::attribute);
+			XmlTreeNode *attribute = nodes[attribute_index];
+			attribute->node_name = name;
+			attribute->namespace_uri = namespace_uri;
+			attribute->parent = element_index;
+			if (element->first_attribute != cl_null_node_index)
 			{
-				if (search_token.attributes[i].first.substr(0, 6) == xmlns_prefix &&
-					search_token.attributes[i].first.substr(6) == prefix)
-					return search_token.attributes[i].second;
+				nodes[element->first_attribute]->previous_sibling = attribute_index;
+				attribute->next_sibling = element->first_attribute;
 			}
+			element->first_attribute = attribute_index;
 		}
 
-		return search_node->find_namespace_uri(qualified_name);
+		XmlTreeNode *attribute = nodes[attribute_index];
+		if (value.has_entities)
+		{
+			scratch.clear();
+			value.append_to(scratch);
+			attribute->set_node_value(this, scratch);
+		}
+		else
+		{
+			attribute->set_node_value(this, value.data, value.length);
+		}
 	}
 
 	unsigned int XmlDocumentImpl::allocate_tree_node(XmlNodeType type)
@@ -30,6 +30,7 @@
 
 #include "UICore/Core/Xml/xml_document.h"
 #include "block_allocator.h"
+#include "xml_string_table.h"
 #include <vector>
 #include <stack>
 
@@ -38,7 +39,8 @@
 namespace uicore
 {
 	class XmlTreeNode;
-	class XmlToken;
+	class XmlTokenRef;
+	class XmlStringRef;
 	class XmlNodeImpl;
 
 	class XmlDocumentImpl : public XmlDocument
@@ -98,6 +100,8 @@ namespace uicore
 		void save(const IODevicePtr &output, bool insert_whitespace = true) const override;
 
 		BlockAllocator node_allocator;
+		BlockAllocator string_allocator;
+		XmlStringTable strings;
 		std::vector<XmlTreeNode *> nodes;
 		std::vector<int> free_nodes;
 		std::vector<XmlNodeImpl *> free_dom_nodes;
@@ -120,7 +124,10 @@ namespace uicore
 				return nodes[node_index];
 		}
 
-		static XmlString find_namespace_uri(const XmlString &qualified_name, const XmlToken &search_token, const XmlNodePtr &search_node);
+		const XmlString *find_namespace_uri(const XmlStringRef &qualified_name, const XmlTokenRef &search_token, unsigned int search_node_index, std::string &scratch);
+		const XmlString *intern(const XmlStringRef &str, std::string &scratch);
+		void append_tree_child(unsigned int parent_index, unsigned int child_index);
+		void set_tree_attribute(unsigned int element_index, const XmlString *namespace_uri, const XmlString *name, const XmlStringRef &value, std::string &scratch);
 
 		unsigned int allocate_tree_node(XmlNodeType type);
 		void free_tree_node(unsigned int node_index);
@@ -85,7 +85,7 @@ namespace uicore
 
 	XmlString XmlNodeImpl::prefix() const
 	{
-		XmlString node_name = get_tree_node()->get_node_name();
+		const XmlString &node_name = get_tree_node()->get_node_name();
 		XmlString::size_type pos = node_name.find(':');
 		if (pos != XmlString::npos)
 			return node_name.substr(0, pos);
@@ -105,7 +105,7 @@ namespace uicore
 
 	XmlString XmlNodeImpl::local_name() const
 	{
-		XmlString node_name = get_tree_node()->get_node_name();
+		const XmlString &node_name = get_tree_node()->get_node_name();
 		XmlString::size_type pos = node_name.find(':');
 		if (pos != XmlString::npos)
 			return node_name.substr(pos + 1);
@@ -450,12 +450,17 @@ namespace uicore
 
 	bool XmlNodeImpl::has_attribute(const XmlString &name) const
 	{
+		// Names are interned, so a name that is not in the string table cannot match any attribute
+		const XmlString *interned_name = _owner_document->strings.find(name);
+		if (!interned_name && !name.empty())
+			return false;
+
 		const XmlTreeNode *tree_node = get_tree_node();
 		unsigned int cur_index = tree_node->first_attribute;
 		const XmlTreeNode *cur_attribute = tree_node->get_first_attribute(_owner_document.get());
 		while (cur_attribute)
 		{
-			if (cur_attribute->get_node_name() == name)
+			if (cur_attribute->node_name == interned_name)
 				return true;
 
 			cur_index = cur_attribute->next_sibling;
@@ -476,12 +481,16 @@ namespace uicore
 
 	XmlString XmlNodeImpl::attribute(const XmlString &name, const XmlString &default_value) const
 	{
+		const XmlString *interned_name = _owner_document->strings.find(name);
+		if (!interned_name && !name.empty())
+			return default_value;
+
 		const XmlTreeNode *tree_node = get_tree_node();
 		unsigned int cur_index = tree_node->first_attribute;
 		const XmlTreeNode *cur_attribute = tree_node->get_first_attribute(_owner_document.get());
 		while (cur_attribute)
 		{
-			if (cur_attribute->get_node_name() == name)
+			if (cur_attribute->node_name == interned_name)
 				return cur_attribute->get_node_value();
 
 			cur_index = cur_attribute->next_sibling;
@@ -600,7 +609,7 @@ namespace uicore
 			const XmlTreeNode *cur_attr = cur->get_first_attribute(_owner_document.get());
 			while (cur_attr)
 			{
-				std::string node_name = cur_attr->get_node_name();
+				const XmlString &node_name = cur_attr->get_node_name();
 				if (prefix.empty())
 				{
 					if (node_name == xmlns_xmlns)
@@ -0,0 +1,102 @@
+/*
+**  UICore
+**  Copyright (c) 1997-2015 The UICore Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries UICore may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+#include "UICore/precomp.h"
+#include "xml_string_table.h"
+#include <cstring>
+#include <cstdint>
+
+namespace uicore
+{
+	const XmlString *XmlStringTable::intern(const char *data, size_t length)
+	{
+		if (length == 0)
+			return nullptr;
+
+		if ((strings.size() + 1) * 2 > buckets.size())
+			grow();
+
+		size_t mask = buckets.size() - 1;
+		for (size_t i = hash(data, length) & mask; ; i = (i + 1) & mask)
+		{
+			const XmlString *str = buckets[i];
+			if (!str)
+			{
+				strings.push_back(XmlString(data, length));
+				buckets[i] = &strings.back();
+				return buckets[i];
+			}
+			else if (str->length() == length && memcmp(str->data(), data, length) == 0)
+			{
+				return str;
+			}
+		}
+	}
+
+	const XmlString *XmlStringTable::find(const char *data, size_t length) const
+	{
+		if (length == 0 || buckets.empty())
+			return nullptr;
+
+		size_t mask = buckets.size() - 1;
+		for (size_t i = hash(data, length) & mask; ; i = (i + 1) & mask)
+		{
+			const XmlString *str = buckets[i];
+			if (!str)
+				return nullptr;
+			else if (str->length() == length && memcmp(str->data(), data, length) == 0)
+				return str;
+		}
+	}
+
+	size_t XmlStringTable::hash(const char *data, size_t length)
+	{
+		// FNV-1a
+		uint32_t h = 2166136261u;
+		for (size_t i = 0; i < length; i++)
+		{
+			h ^= static_cast<unsigned char>(data[i]);
+			h *= 16777619u;
+		}
+		return h;
+	}
+
+	void XmlStringTable::grow()
+	{
+		std::vector<const XmlString *> new_buckets(buckets.empty() ? 64 : buckets.size() * 2);
+		size_t mask = new_buckets.size() - 1;
+		for (const XmlString &str : strings)
+		{
+			size_t i = hash(str.data(), str.length()) & mask;
+			while (new_buckets[i])
+				i = (i + 1) & mask;
+			new_buckets[i] = &str;
+		}
+		buckets.swap(new_buckets);
+	}
+}
@@ -0,0 +1,58 @@
+/*
+**  UICore
+**  Copyright (c) 1997-2015 The UICore Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries UICore may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+#pragma once
+
+#include "UICore/Core/Xml/xml_node.h"
+#include <vector>
+#include <deque>
+
+namespace uicore
+{
+	/// \brief Per-document table of unique names.
+	///
+	/// Equal strings interned into the same table share a single XmlString, so names can be compared by pointer.
+	class XmlStringTable
+	{
+	public:
+		/// \brief Returns the shared copy of the string, adding it to the table if needed. Empty strings return nullptr.
+		const XmlString *intern(const char *data, size_t length);
+		const XmlString *intern(const XmlString &str) { return intern(str.data(), str.length()); }
+
+		/// \brief Returns the shared copy of the string, or nullptr if it is not in the table.
+		const XmlString *find(const char *data, size_t length) const;
+		const XmlString *find(const XmlString &str) const { return find(str.data(), str.length()); }
+
+	private:
+		static size_t hash(const char *data, size_t length);
+		void grow();
+
+		std::deque<XmlString> strings;
+		std::vector<const XmlString *> buckets;
+	};
+}
@@ -30,11 +30,13 @@
 #include "UICore/Core/Xml/xml_tokenizer.h"
 #include "UICore/Core/Xml/xml_token.h"
 #include "UICore/Core/IOData/iodevice.h"
+#include "UICore/Core/IOData/mapped_file.h"
 #include "UICore/Core/System/databuffer.h"
 #include "UICore/Core/Text/text.h"
 #include "UICore/Core/Text/string_format.h"
 #include "xml_tokenizer_impl.h"
 #include <algorithm>
+#include <iterator>
 #include <utility>
 
 namespace uicore
@@ -44,22 +46,62 @@ namespace uicore
 		return std::make_shared<XmlTokenizerImpl>(input);
 	}
 
+	std::shared_ptr<XmlTokenizer> XmlTokenizer::create(const DataBufferPtr &buffer)
+	{
+		return std::make_shared<XmlTokenizerImpl>(buffer);
+	}
+
 	/////////////////////////////////////////////////////////////////////////////
 
-	XmlTokenizerImpl::XmlTokenizerImpl(const IODevicePtr &input) : input(input)
+	void XmlStringRef::append_to(std::string &text) const
 	{
-		size = (size_t)input->size();
-		pos = 0;
+		if (has_entities)
+			XmlTokenizerImpl::unescape(text, data, length);
+		else
+			text.append(data, length);
+	}
+
+	/////////////////////////////////////////////////////////////////////////////
 
-		auto buffer = DataBuffer::create(size);
-		input->read(buffer->data(), buffer->size());
+	const XmlCharSet XmlTokenizerImpl::whitespace_chars(" \r\n\t");
+	const XmlCharSet XmlTokenizerImpl::tag_name_end_chars(" \r\n\t?/>");
+	const XmlCharSet XmlTokenizerImpl::attribute_name_end_chars(" \r\n\t=");
+
+	XmlTokenizerImpl::XmlTokenizerImpl(const IODevicePtr &input)
+	{
+		auto mapped_file = dynamic_cast<MappedFile*>(input.get());
+		if (mapped_file)
+		{
+			// Tokenize memory mapped files in place
+			long long start = std::min(mapped_file->position(), mapped_file->size());
+			set_buffer(mapped_file->view(start, mapped_file->size() - start));
+			mapped_file->seek_from_end(0);
+		}
+		else
+		{
+			auto buffer = DataBuffer::create((size_t)input->size());
+			input->read(buffer->data(), buffer->size());
+			set_buffer(buffer);
+		}
+	}
 
-		ByteOrderMark bom_type = Text::detect_bom(buffer->data(), buffer->size());
+	XmlTokenizerImpl::XmlTokenizerImpl(const DataBufferPtr &buffer)
+	{
+		set_buffer(buffer);
+	}
+
+	void XmlTokenizerImpl::set_buffer(const DataBufferPtr &new_buffer)
+	{
+		buffer = new_buffer;
+		data = buffer->data();
+		size = buffer->size();
+		pos = 0;
+
+		ByteOrderMark bom_type = Text::detect_bom(data, size);
 		switch (bom_type)
 		{
 		default:
 		case ByteOrderMark::none:
-			data = std::string(buffer->data(), buffer->size());
 			break;
 		case ByteOrderMark::utf32_be:
 		case ByteOrderMark::utf32_le:
@@ -70,7 +112,8 @@ namespace uicore
 			throw Exception("UTF-16 XML files not supported yet");
 			break;
 		case ByteOrderMark::utf8:
-			data = std::string(buffer->data() + 3, buffer->size() - 3);
+			data += 3;
+			size -= 3;
 			break;
 		}
 	}
@@ -86,29 +129,47 @@ namespace uicore
 	}
 
 	void XmlTokenizerImpl::next(XmlToken *out_token)
+	{
+		next(&ref_token);
+
+		out_token->type = ref_token.type;
+		out_token->variant = ref_token.variant;
+		out_token->name.assign(ref_token.name.data, ref_token.name.length);
+		out_token->value.clear();
+		ref_token.value.append_to(out_token->value);
+
+		size_t count = ref_token.attributes.size();
+		out_token->attributes.resize(count);
+		for (size_t i = 0; i < count; i++)
+		{
+			out_token->attributes[i].first.assign(ref_token.attributes[i].first.data, ref_token.attributes[i].first.length);
+			out_token->attributes[i].second.clear();
+			ref_token.attributes[i].second.append_to(out_token->attributes[i].second);
+		}
+	}
+
+	void XmlTokenizerImpl::next(XmlTokenRef *out_token)
 	{
 		out_token->type = XmlTokenType::null;
 		out_token->variant = XmlTokenVariant::single;
-		//	out_token->attributes.clear();
-		while (!out_token->attributes.empty())
-			out_token->attributes.pop_back();
+		out_token->name = XmlStringRef();
+		out_token->value = XmlStringRef();
+		out_token->attributes.clear();
 
 		if (!next_text_node(out_token))
 			next_tag_node(out_token);
 	}
 
-	bool XmlTokenizerImpl::next_text_node(XmlToken *out_token)
+	bool XmlTokenizerImpl::next_text_node(XmlTokenRef *out_token)
 	{
 		while (pos < size && data[pos] != '<')
 		{
-			std::string::size_type start_pos = pos;
-			std::string::size_type end_pos = data.find('<', start_pos);
-			if (end_pos == data.npos) end_pos = size;
+			size_t start_pos = pos;
+			size_t end_pos = find('<', start_pos);
+			if (end_pos == npos) end_pos = size;
 			pos = end_pos;
 
-			std::string text;
-			std::string text_orig = data.substr(start_pos, end_pos - start_pos);
-			unescape(text, text_orig);
+			XmlStringRef text = text_ref(start_pos, end_pos);
 			if (_eat_whitespace)
 			{
 				text = trim_whitespace(text);
@@ -123,7 +184,7 @@ namespace uicore
 		return false;
 	}
 
-	bool XmlTokenizerImpl::next_tag_node(XmlToken *out_token)
+	bool XmlTokenizerImpl::next_tag_node(XmlTokenRef *out_token)
 	{
 		if (pos == size || data[pos] != '<')
 			return false;
@@ -151,27 +212,27 @@ namespace uicore
 		}
 
 		// Extract the tag name:
-		std::string::size_type start_pos = pos;
-		std::string::size_type end_pos = data.find_first_of(" \r\n\t?/>", start_pos);
-		if (end_pos == data.npos)
+		size_t start_pos = pos;
+		size_t end_pos = find_first_of(tag_name_end_chars, start_pos);
+		if (end_pos == npos)
 			XmlTokenizerImpl::throw_exception("Premature end of XML data!");
 		pos = end_pos;
 
 		out_token->type = questionMark ? XmlTokenType::processing_instruction : XmlTokenType::element;
 		out_token->variant = closing ? XmlTokenVariant::end : XmlTokenVariant::begin;
-		out_token->name = data.substr(start_pos, end_pos - start_pos);
+		out_token->name = XmlStringRef(data + start_pos, end_pos - start_pos);
 
 		if (out_token->type == XmlTokenType::processing_instruction)
 		{
 			// Strip whitespace:
-			pos = data.find_first_not_of(" \r\n\t", pos);
-			if (pos == data.npos)
+			pos = find_first_not_of(whitespace_chars, pos);
+			if (pos == npos)
 				XmlTokenizerImpl::throw_exception("Premature end of XML data!");
 
-			end_pos = data.find_first_of("?", pos);
-			if (end_pos == data.npos)
+			end_pos = find('?', pos);
+			if (end_pos == npos)
 				XmlTokenizerImpl::throw_exception("Premature end of XML data!");
-			out_token->value = data.substr(pos, end_pos - pos);
+			out_token->value = XmlStringRef(data + pos, end_pos - pos);
 			pos = end_pos;
 		}
 		else // out_token->type == XmlTokenType::element
@@ -180,8 +241,8 @@ namespace uicore
 			while (true)
 			{
 				// Strip whitespace:
-				pos = data.find_first_not_of(" \r\n\t", pos);
-				if (pos == data.npos)
+				pos = find_first_not_of(whitespace_chars, pos);
+				if (pos == npos)
 					XmlTokenizerImpl::throw_exception("Premature end of XML data!");
 
 				// End of tag, stop searching for more attributes:
@@ -189,59 +250,49 @@ namespace uicore
 					break;
 
 				// Extract attribute name:
-				std::string::size_type start_pos = pos;
-				std::string::size_type end_pos = data.find_first_of(" \r\n\t=", start_pos);
-				if (end_pos == data.npos)
+				size_t start_pos = pos;
+				size_t end_pos = find_first_of(attribute_name_end_chars, start_pos);
+				if (end_pos == npos)
 					XmlTokenizerImpl::throw_exception("Premature end of XML data!");
 				pos = end_pos;
 
-				std::string attributeName = data.substr(start_pos, end_pos - start_pos);
+				XmlStringRef attribute_name(data + start_pos, end_pos - start_pos);
 
 				// Find seperator:
-				pos = data.find_first_not_of(" \r\n\t", pos);
-				if (pos == data.npos || pos == size - 1)
+				pos = find_first_not_of(whitespace_chars, pos);
+				if (pos == npos || pos == size - 1)
 					XmlTokenizerImpl::throw_exception("Premature end of XML data!");
 				if (data[pos++] != '=')
-					XmlTokenizerImpl::throw_exception(string_format("XML error(s), parser confused at line %1 (tag=%2, attributeName=%3)", get_line_number(), out_token->name, attributeName));
+					XmlTokenizerImpl::throw_exception(string_format("XML error(s), parser confused at line %1 (tag=%2, attributeName=%3)", get_line_number(), out_token->name.raw(), attribute_name.raw()));
 
 				// Strip whitespace:
-				pos = data.find_first_not_of(" \r\n\t", pos);
-				if (pos == data.npos)
+				pos = find_first_not_of(whitespace_chars, pos);
+				if (pos == npos)
 					XmlTokenizerImpl::throw_exception("Premature end of XML data!");
 
 				// Extract attribute value:
-				std::string::value_type const * first_of = " \r\n\t";
-				if (data[pos] == '"')
+				char quote = 0;
+				if (data[pos] == '"' || data[pos] == '\'')
 				{
-					first_of = "\"";
+					quote = data[pos];
 					pos++;
 					if (pos == size)
 						XmlTokenizerImpl::throw_exception("Premature end of XML data!");
 				}
-				else
-					if (data[pos] == '\'')
-					{
-						first_of = "'";
-						pos++;
-						if (pos == size)
-							XmlTokenizerImpl::throw_exception("Premature end of XML data!");
-					}
 
 				start_pos = pos;
-				end_pos = data.find_first_of(first_of, start_pos);
-				if (end_pos == data.npos)
+				end_pos = quote ? find(quote, start_pos) : find_first_of(whitespace_chars, start_pos);
+				if (end_pos == npos)
 					XmlTokenizerImpl::throw_exception("Premature end of XML data!");
 
-				std::string attributeValue;
-				std::string attributeValueOrig = data.substr(start_pos, end_pos - start_pos);
-				unescape(attributeValue, attributeValueOrig);
+				XmlStringRef attribute_value = text_ref(start_pos, end_pos);
 
 				pos = end_pos + 1;
 				if (pos == size)
 					XmlTokenizerImpl::throw_exception("Premature end of XML data!");
 
 				// Finally apply attribute to token:
-				out_token->attributes.push_back(XmlToken::Attribute(attributeName, attributeValue));
+				out_token->attributes.push_back(XmlTokenRef::Attribute(attribute_name, attribute_value));
 			}
 		}
 
@@ -262,22 +313,20 @@ namespace uicore
 		return true;
 	}
 
-	bool XmlTokenizerImpl::next_exclamation_mark_node(XmlToken *out_token)
+	bool XmlTokenizerImpl::next_exclamation_mark_node(XmlTokenRef *out_token)
 	{
 		if (pos + 2 >= size)
 			XmlTokenizerImpl::throw_exception("Premature end of XML data!");
 
-		if (data.compare(pos, 2, "--") == 0) // comment block
+		if (compare(pos, "--", 2)) // comment block
 		{
-			std::string::size_type start_pos = pos + 2;
-			std::string::size_type end_pos = data.find("-->", start_pos);
-			if (end_pos == data.npos)
+			size_t start_pos = pos + 2;
+			size_t end_pos = find("-->", start_pos);
+			if (end_pos == npos)
 				XmlTokenizerImpl::throw_exception("Premature end of XML data!");
 			pos = end_pos + 3;
 
-			std::string text;
-			std::string text_orig = data.substr(start_pos, end_pos - start_pos);
-			unescape(text, text_orig);
+			XmlStringRef text = text_ref(start_pos, end_pos);
 			if (_eat_whitespace)
 				text = trim_whitespace(text);
 
@@ -290,89 +339,80 @@ namespace uicore
 		if (pos + 7 >= size)
 			XmlTokenizerImpl::throw_exception("Premature end of XML data!");
 
-		if (data.compare(pos, 7, "DOCTYPE") == 0)
+		if (compare(pos, "DOCTYPE", 7))
 		{
 			// Strip whitespace:
-			pos = data.find_first_not_of(" \r\n\t", pos + 7);
-			if (pos == data.npos)
+			pos = find_first_not_of(whitespace_chars, pos + 7);
+			if (pos == npos)
 				XmlTokenizerImpl::throw_exception("Premature end of XML data!");
 
-			// Find doctype name:				
-			std::string::size_type name_start = pos;
-			std::string::size_type name_end = data.find_first_of(" \r\n\t?/>", name_start);
-			if (name_end == data.npos)
+			// Find doctype name:
+			size_t name_start = pos;
+			size_t name_end = find_first_of(tag_name_end_chars, name_start);
+			if (name_end == npos)
 				XmlTokenizerImpl::throw_exception("Premature end of XML data!");
 			pos = name_end;
 
 			// Strip whitespace:
-			pos = data.find_first_not_of(" \r\n\t", pos);
-			if (pos == data.npos)
+			pos = find_first_not_of(whitespace_chars, pos);
+			if (pos == npos)
 				XmlTokenizerImpl::throw_exception("Premature end of XML data!");
 
-			std::string::size_type public_start = data.npos;
-			std::string::size_type public_end = data.npos;
-			std::string::size_type system_start = data.npos;
-			std::string::size_type system_end = data.npos;
-			std::string::size_type subset_start = data.npos;
-			std::string::size_type subset_end = data.npos;
-
 			// Look for possible external id:
 			if (data[pos] != '[' && data[pos] != '>')
 			{
 				if (pos + 6 >= size)
 					XmlTokenizerImpl::throw_exception("Premature end of XML data!");
 
-				if (data.compare(pos, 6, "SYSTEM") == 0)
+				if (compare(pos, "SYSTEM", 6))
 				{
 					pos += 6;
 					if (pos == size)
 						XmlTokenizerImpl::throw_exception("Premature end of XML data!");
 
 					// Strip whitespace:
-					pos = data.find_first_not_of(" \r\n\t", pos);
-					if (pos == data.npos)
+					pos = find_first_not_of(whitespace_chars, pos);
+					if (pos == npos)
 						XmlTokenizerImpl::throw_exception("Premature end of XML data!");
 
 					// Read system literal:
-					std::string::value_type literal_char = data[pos];
+					char literal_char = data[pos];
 					if (literal_char != '\'' && literal_char != '"')
 						XmlTokenizerImpl::throw_exception("Premature end of XML data!");
 
-					system_start = pos + 1;
-					system_end = data.find(literal_char, system_start);
-					if (system_end == data.npos)
+					size_t system_end = find(literal_char, pos + 1);
+					if (system_end == npos)
 						XmlTokenizerImpl::throw_exception("Premature end of XML data!");
 					pos = system_end + 1;
 					if (pos >= size)
 						XmlTokenizerImpl::throw_exception("Premature end of XML data!");
 				}
-				else if (data.compare(pos, 6, "PUBLIC") == 0)
+				else if (compare(pos, "PUBLIC", 6))
 				{
 					pos += 6;
 					if (pos == size)
 						XmlTokenizerImpl::throw_exception("Premature end of XML data!");
 
 					// Strip whitespace:
-					pos = data.find_first_not_of(" \r\n\t", pos);
-					if (pos == data.npos)
+					pos = find_first_not_of(whitespace_chars, pos);
+					if (pos == npos)
 						XmlTokenizerImpl::throw_exception("Premature end of XML data!");
 
 					// Read public literal:
-					std::string::value_type literal_char = data[pos];
+					char literal_char = data[pos];
 					if (literal_char != '\'' && literal_char != '"')
 						XmlTokenizerImpl::throw_exception("Premature end of XML data!");
 
-					public_start = pos + 1;
-					public_end = data.find(literal_char, public_start);
-					if (public_end == data.npos)
+					size_t public_end = find(literal_char, pos + 1);
+					if (public_end == npos)
 						XmlTokenizerImpl::throw_exception("Premature end of XML data!");
 					pos = public_end + 1;
 					if (pos >= size)
 						XmlTokenizerImpl::throw_exception("Premature end of XML data!");
 
 					// Strip whitespace:
-					pos = data.find_first_not_of(" \r\n\t", pos);
-					if (pos == data.npos)
+					pos = find_first_not_of(whitespace_chars, pos);
+					if (pos == npos)
 						XmlTokenizerImpl::throw_exception("Premature end of XML data!");
 
 					// Read system literal:
@@ -380,9 +420,8 @@ namespace uicore
 					if (literal_char != '\'' && literal_char != '"')
 						XmlTokenizerImpl::throw_exception("Premature end of XML data!");
 
-					system_start = pos + 1;
-					system_end = data.find(literal_char, system_start);
-					if (system_end == data.npos)
+					size_t system_end = find(literal_char, pos + 1);
+					if (system_end == npos)
 						XmlTokenizerImpl::throw_exception("Premature end of XML data!");
 					pos = system_end + 1;
 					if (pos >= size)
@@ -392,24 +431,21 @@ namespace uicore
 					XmlTokenizerImpl::throw_exception(string_format("Error in XML stream, line %1 (unknown external identifier type in DOCTYPE)", get_line_number()));
 
 				// Strip whitespace:
-				pos = data.find_first_not_of(" \r\n\t", pos);
-				if (pos == data.npos)
+				pos = find_first_not_of(whitespace_chars, pos);
+				if (pos == npos)
 					XmlTokenizerImpl::throw_exception("Premature end of XML data!");
 			}
 
 			// Look for possible internal subset:
 			if (data[pos] == '[')
 			{
-				subset_start = pos + 1;
-
 				// Search for the end of the internal subset:
 				// (to avoid parsing it, we search backwards)
-				std::string::size_type end_pos = data.find('>', pos + 1);
-				if (end_pos == data.npos)
+				size_t end_pos = find('>', pos + 1);
+				if (end_pos == npos)
 					XmlTokenizerImpl::throw_exception("Premature end of XML data!");
 
-				subset_end = data.rfind(']', end_pos);
-				if (subset_end == data.npos)
+				if (std::find(std::reverse_iterator<const char*>(data + end_pos), std::reverse_iterator<const char*>(data), ']') == std::reverse_iterator<const char*>(data))
 					XmlTokenizerImpl::throw_exception(string_format("Error in XML stream, line %1 (expected end of internal subset in DOCTYPE)", get_line_number()));
 
 				pos = end_pos;
@@ -423,19 +459,17 @@ namespace uicore
 			out_token->type = XmlTokenType::doctype;
 			return true;
 		}
-		else if (data.compare(pos, 7, "[CDATA[") == 0)
+		else if (compare(pos, "[CDATA[", 7))
 		{
-			std::string::size_type start_pos = pos + 7;
-			std::string::size_type end_pos = data.find("]]>", start_pos);
-			if (end_pos == data.npos)
+			size_t start_pos = pos + 7;
+			size_t end_pos = find("]]>", start_pos);
+			if (end_pos == npos)
 				XmlTokenizerImpl::throw_exception("Premature end of XML data!");
 			pos = end_pos + 3;
 
-			std::string value = data.substr(start_pos, end_pos - start_pos);
-
 			out_token->type = XmlTokenType::cdata;
 			out_token->variant = XmlTokenVariant::single;
-			out_token->value = value;
+			out_token->value = XmlStringRef(data + start_pos, end_pos - start_pos);
 			return true;
 		}
 		else
@@ -453,65 +487,103 @@ namespace uicore
 	int XmlTokenizerImpl::get_line_number()
 	{
 		int line = 1;
-		std::string::size_type tmp_pos = 0;
-
-		std::string::const_iterator it;
-		for (it = data.begin(); it != data.end() && tmp_pos <= pos; ++it, tmp_pos++)
+		for (size_t tmp_pos = 0; tmp_pos < size && tmp_pos <= pos; tmp_pos++)
 		{
-			if ((*it) == '\n')
+			if (data[tmp_pos] == '\n')
 				line++;
 		}
-
 		return line;
 	}
 
-	inline void XmlTokenizerImpl::unescape(std::string &unescaped, const std::string &text)
+	size_t XmlTokenizerImpl::find(char c, size_t start) const
 	{
-		static const std::string quot("&quot;");
-		static const std::string apos("&apos;");
-		static const std::string lt("&lt;");
-		static const std::string gt("&gt;");
-		static const std::string amp("&amp;");
-
-		unescaped = text;
-		unescape(unescaped, quot, '"');
-		unescape(unescaped, apos, '\'');
-		unescape(unescaped, lt, '<');
-		unescape(unescaped, gt, '>');
-		unescape(unescaped, amp, '&');
+		if (start >= size)
+			return npos;
+		const void *result = memchr(data + start, c, size - start);
+		return result ? static_cast<const char*>(result) - data : npos;
 	}
 
-	inline void XmlTokenizerImpl::unescape(std::string &text, const std::string &search, std::string::value_type replace)
+	size_t XmlTokenizerImpl::find(const char *str, size_t start) const
 	{
-		std::string::size_type read_pos = 0;
-		std::string::size_type length = text.length();
-		std::string::size_type search_length = search.length();
+		size_t length = strlen(str);
 		while (true)
 		{
-			std::string::size_type next_match = text.find(search, read_pos);
-			if (next_match == std::string::npos)
-				break;
+			start = find(str[0], start);
+			if (start == npos || start + length > size)
+				return npos;
+			if (memcmp(data + start, str, length) == 0)
+				return start;
+			start++;
+		}
+	}
 
-			std::string::size_type copy_size = length - (next_match + search_length);
-			if (copy_size > 0)
-				memmove(&text[next_match + 1], &text[next_match + search_length], copy_size * sizeof(std::string::value_type));
-			text[next_match] = replace;
-			length -= search_length - 1;
-			read_pos = next_match + 1;
-			if (read_pos > length)
-				break;
+	size_t XmlTokenizerImpl::find_first_of(const XmlCharSet &chars, size_t start) const
+	{
+		for (size_t i = start; i < size; i++)
+		{
+			if (chars.contains(data[i]))
+				return i;
+		}
+		return npos;
+	}
+
+	size_t XmlTokenizerImpl::find_first_not_of(const XmlCharSet &chars, size_t start) const
+	{
+		for (size_t i = start; i < size; i++)
+		{
+			if (!chars.contains(data[i]))
+				return i;
 		}
-		text.resize(length);
+		return npos;
 	}
 
-	inline std::string XmlTokenizerImpl::trim_whitespace(const std::string &text)
+	XmlStringRef XmlTokenizerImpl::text_ref(size_t start, size_t end) const
 	{
-		std::string::size_type pos_start = text.find_first_not_of(" \t\r\n");
-		if (pos_start == std::string::npos)
-			return std::string();
-		std::string::size_type pos_end = text.find_last_not_of(" \t\r\n");
-		if (pos_end == std::string::npos)
-			return std::string();
-		return text.substr(pos_start, pos_end - pos_start + 1);
+		return XmlStringRef(data + start, end - start, memchr(data + start, '&', end - start) != nullptr);
+	}
+
+	XmlStringRef XmlTokenizerImpl::trim_whitespace(const XmlStringRef &text)
+	{
+		const char *begin = text.data;
+		const char *end = text.data + text.length;
+		while (begin != end && (*begin == ' ' || *begin == '\t' || *begin == '\r' || *begin == '\n'))
+			begin++;
+		while (end != begin && (end[-1] == ' ' || end[-1] == '\t' || end[-1] == '\r' || end[-1] == '\n'))
+			end--;
+		return XmlStringRef(begin, end - begin, text.has_entities && memchr(begin, '&', end - begin) != nullptr);
+	}
+
+	void XmlTokenizerImpl::unescape(std::string &unescaped, const char *text, size_t length)
+	{
+		static const struct { const char *entity; size_t length; char replace; } entities[] =
+		{
+			{ "&quot;", 6, '"' },
+			{ "&apos;", 6, '\'' },
+			{ "&lt;", 4, '<' },
+			{ "&gt;", 4, '>' },
+			{ "&amp;", 5, '&' }
+		};
+
+		size_t pos = 0;
+		while (pos < length)
+		{
+			const char *amp = static_cast<const char*>(memchr(text + pos, '&', length - pos));
+			size_t end = amp ? amp - text : length;
+			unescaped.append(text + pos, end - pos);
+			if (end == length)
+				break;
+
+			pos = end + 1;
+			unescaped.push_back('&');
+			for (const auto &entity : entities)
+			{
+				if (end + entity.length <= length && memcmp(text + end, entity.entity, entity.length) == 0)
+				{
+					unescaped.back() = entity.replace;
+					pos = end + entity.length;
+					break;
+				}
+			}
+		}
 	}
 }
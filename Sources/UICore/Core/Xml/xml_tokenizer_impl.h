@@ -29,34 +29,63 @@
 #pragma once
 
 #include "UICore/Core/Xml/xml_tokenizer.h"
+#include <string>
+#include <cstring>
 
 namespace uicore
 {
+	class XmlCharSet
+	{
+	public:
+		XmlCharSet(const char *chars) { memset(table, 0, sizeof(table)); for (; *chars; chars++) table[static_cast<unsigned char>(*chars)] = true; }
+		bool contains(char c) const { return table[static_cast<unsigned char>(c)]; }
+
+	private:
+		bool table[256];
+	};
+
 	class XmlTokenizerImpl : public XmlTokenizer
 	{
 	public:
 		XmlTokenizerImpl(const IODevicePtr &input);
+		XmlTokenizerImpl(const DataBufferPtr &buffer);
 
 		bool eat_whitespace() const override;
 		void set_eat_whitespace(bool enable = true) override;
 		void next(XmlToken *out_token) override;
+		void next(XmlTokenRef *out_token) override;
+
+		static void unescape(std::string &text_out, const char *text_in, size_t length);
 
 	private:
-		IODevicePtr input;
-		std::string::size_type pos = 0, size = 0;
-		std::string data;
+		DataBufferPtr buffer;
+		const char *data = nullptr;
+		size_t pos = 0, size = 0;
 		bool _eat_whitespace = true;
+		XmlTokenRef ref_token;
+
+		static const size_t npos = std::string::npos;
+		static const XmlCharSet whitespace_chars;
+		static const XmlCharSet tag_name_end_chars;
+		static const XmlCharSet attribute_name_end_chars;
+
+		void set_buffer(const DataBufferPtr &buffer);
 
 		static void throw_exception(const std::string &str);
-		bool next_text_node(XmlToken *out_token);
-		bool next_tag_node(XmlToken *out_token);
-		bool next_exclamation_mark_node(XmlToken *out_token);
+		bool next_text_node(XmlTokenRef *out_token);
+		bool next_tag_node(XmlTokenRef *out_token);
+		bool next_exclamation_mark_node(XmlTokenRef *out_token);
 
 		// used to get the line number when there is an error in the xml file
 		int get_line_number();
 
-		void unescape(std::string &text_out, const std::string &text_in);
-		void unescape(std::string &text, const std::string &search, std::string::value_type replace);
-		std::string trim_whitespace(const std::string &text);
+		size_t find(char c, size_t start) const;
+		size_t find(const char *str, size_t start) const;
+		size_t find_first_of(const XmlCharSet &chars, size_t start) const;
+		size_t find_first_not_of(const XmlCharSet &chars, size_t start) const;
+		bool compare(size_t start, const char *str, size_t length) const { return start + length <= size && memcmp(data + start, str, length) == 0; }
+
+		XmlStringRef text_ref(size_t start, size_t end) const;
+		static XmlStringRef trim_whitespace(const XmlStringRef &text);
 	};
 }
@@ -30,6 +30,7 @@
 
 #include "block_allocator.h"
 #include "xml_document_impl.h"
+#include <cstring>
 
 namespace uicore
 {
@@ -38,9 +39,11 @@ namespace uicore
 	class XmlTreeNode : public BlockAllocated
 	{
 	public:
-		std::string node_name;
-		std::string node_value;
-		std::string namespace_uri;
+		const XmlString *node_name = nullptr; // Interned in XmlDocumentImpl::strings
+		const XmlString *namespace_uri = nullptr; // Interned in XmlDocumentImpl::strings
+		const char *node_value = nullptr; // Allocated from XmlDocumentImpl::string_allocator
+		unsigned int node_value_length = 0;
+		unsigned int node_value_capacity = 0;
 		XmlNodeType node_type = XmlNodeType::element;
 		unsigned int parent = cl_null_node_index;
 		unsigned int first_child = cl_null_node_index;
@@ -52,9 +55,9 @@ namespace uicore
 
 		void reset()
 		{
-			node_name.clear();
-			node_value.clear();
-			namespace_uri.clear();
+			node_name = nullptr;
+			namespace_uri = nullptr;
+			node_value_length = 0;
 			node_type = XmlNodeType::element;
 			parent = cl_null_node_index;
 			first_child = cl_null_node_index;
@@ -64,34 +67,53 @@ namespace uicore
 			first_attribute = cl_null_node_index;
 		}
 
-		std::string get_node_name() const
+		const XmlString &get_node_name() const
 		{
-			return node_name;
+			return node_name ? *node_name : empty_string();
 		}
 
-		std::string get_node_value() const
+		XmlString get_node_value() const
 		{
-			return node_value;
+			return XmlString(node_value, node_value_length);
 		}
 
-		std::string get_namespace_uri() const
+		const XmlString &get_namespace_uri() const
 		{
-			return namespace_uri;
+			return namespace_uri ? *namespace_uri : empty_string();
 		}
 
 		void set_node_name(XmlDocumentImpl *owner_document, const XmlString &str)
 		{
-			node_name = str;
+			node_name = owner_document->strings.intern(str);
 		}
 
 		void set_node_value(XmlDocumentImpl *owner_document, const XmlString &str)
 		{
-			node_value = str;
+			set_node_value(owner_document, str.data(), str.length());
+		}
+
+		void set_node_value(XmlDocumentImpl *owner_document, const char *data, size_t length)
+		{
+			// Reuse the old storage if the new value fits. Otherwise the old storage is only released together with the document.
+			if (length > node_value_capacity)
+			{
+				node_value = static_cast<const char *>(owner_document->string_allocator.allocate((int)length));
+				node_value_capacity = (unsigned int)length;
+			}
+			if (length > 0)
+				memcpy(const_cast<char *>(node_value), data, length);
+			node_value_length = (unsigned int)length;
 		}
 
 		void set_namespace_uri(XmlDocumentImpl *owner_document, const XmlString &str)
 		{
-			namespace_uri = str;
+			namespace_uri = owner_document->strings.intern(str);
+		}
+
+		static const XmlString &empty_string()
+		{
+			static const XmlString empty;
+			return empty;
 		}
 
 		XmlTreeNode *get_parent(XmlDocumentImpl *owner_document)
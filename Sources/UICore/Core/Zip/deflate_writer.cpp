@@ -0,0 +1,189 @@
+/*
+**  UICore
+**  Copyright (c) 1997-2015 The UICore Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries UICore may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+#include "UICore/precomp.h"
+#include "UICore/Core/Zip/deflate_writer.h"
+#include "UICore/Core/System/exception.h"
+#include "miniz.h"
+#include <vector>
+#include <algorithm>
+#include <cstring>
+
+#undef min
+#undef max
+
+namespace uicore
+{
+	class DeflateWriterImpl : public DeflateWriter
+	{
+	public:
+		DeflateWriterImpl(const IODevicePtr &output, bool raw, int compression_level, ZLibCompression::CompressionMode mode);
+		~DeflateWriterImpl();
+
+		void flush() override;
+		void finish() override;
+		long long compressed_size() const override { return bytes_out; }
+
+		long long size() const override { return bytes_in; }
+
+		long long seek(long long position) override;
+		long long seek_from_current(long long offset) override { return seek(bytes_in + offset); }
+		long long seek_from_end(long long offset) override { return seek(bytes_in + offset); }
+
+		int try_read(void *data, int size) override { return (int)try_read_64(data, size); }
+		long long try_read_64(void *data, long long size) override { throw Exception("Cannot read from a DeflateWriter"); }
+		void write(const void *data, int size) override { write_64(data, size); }
+		void write_64(const void *data, long long size) override;
+
+		void close() override;
+
+		DeflateWriterImpl(const DeflateWriterImpl &) = delete;
+		DeflateWriterImpl &operator=(const DeflateWriterImpl &) = delete;
+
+	private:
+		void deflate(int flush);
+
+		IODevicePtr output;
+		mz_stream zs;
+		std::vector<unsigned char> zbuffer;
+		bool finished = false;
+
+		// mz_stream::total_in and total_out are only 32 bit on some platforms
+		long long bytes_in = 0;
+		long long bytes_out = 0;
+	};
+
+	std::shared_ptr<DeflateWriter> DeflateWriter::create(const IODevicePtr &output, bool raw, int compression_level, ZLibCompression::CompressionMode mode)
+	{
+		return std::make_shared<DeflateWriterImpl>(output, raw, compression_level, mode);
+	}
+
+	DeflateWriterImpl::DeflateWriterImpl(const IODevicePtr &output, bool raw, int compression_level, ZLibCompression::CompressionMode mode) : output(output), zbuffer(64 * 1024)
+	{
+		const int window_bits = 15;
+
+		int strategy = MZ_DEFAULT_STRATEGY;
+		switch (mode)
+		{
+		case ZLibCompression::default_strategy: strategy = MZ_DEFAULT_STRATEGY; break;
+		case ZLibCompression::filtered: strategy = MZ_FILTERED; break;
+		case ZLibCompression::huffman_only: strategy = MZ_HUFFMAN_ONLY; break;
+		case ZLibCompression::rle: strategy = MZ_RLE; break;
+		case ZLibCompression::fixed: strategy = MZ_FIXED; break;
+		}
+
+		memset(&zs, 0, sizeof(mz_stream));
+		int result = mz_deflateInit2(&zs, compression_level, MZ_DEFLATED, raw ? -window_bits : window_bits, 8, strategy); // Undocumented: if wbits is negative, zlib skips header check
+		if (result != MZ_OK)
+			throw Exception("Zlib deflateInit failed");
+	}
+
+	DeflateWriterImpl::~DeflateWriterImpl()
+	{
+		try
+		{
+			finish();
+		}
+		catch (...)
+		{
+		}
+		mz_deflateEnd(&zs);
+	}
+
+	long long DeflateWriterImpl::seek(long long position)
+	{
+		if (position != bytes_in)
+			throw Exception("DeflateWriter cannot seek");
+		return position;
+	}
+
+	void DeflateWriterImpl::write_64(const void *data, long long size)
+	{
+		if (finished)
+			throw Exception("Cannot write to a finished DeflateWriter");
+
+		const unsigned char *src = static_cast<const unsigned char *>(data);
+		while (size > 0)
+		{
+			// avail_in is 32 bit
+			unsigned int amount = (unsigned int)std::min(size, 0x40000000LL);
+			zs.next_in = src;
+			zs.avail_in = amount;
+			deflate(MZ_NO_FLUSH);
+			bytes_in += amount;
+			src += amount;
+			size -= amount;
+		}
+	}
+
+	void DeflateWriterImpl::flush()
+	{
+		if (!finished)
+			deflate(MZ_SYNC_FLUSH);
+	}
+
+	void DeflateWriterImpl::finish()
+	{
+		if (!finished)
+		{
+			finished = true;
+			deflate(MZ_FINISH);
+		}
+	}
+
+	void DeflateWriterImpl::close()
+	{
+		finish();
+		output->close();
+	}
+
+	void DeflateWriterImpl::deflate(int flush)
+	{
+		while (true)
+		{
+			zs.next_out = zbuffer.data();
+			zs.avail_out = (unsigned int)zbuffer.size();
+
+			int result = mz_deflate(&zs, flush);
+			if (result == MZ_STREAM_ERROR) throw Exception("Zip stream structure was inconsistent!");
+			if (result == MZ_PARAM_ERROR) throw Exception("Invalid zlib deflate parameter");
+			if (result != MZ_OK && result != MZ_STREAM_END && result != MZ_BUF_ERROR) throw Exception("Zlib deflate failed while compressing data!");
+
+			long long zsize = zbuffer.size() - zs.avail_out;
+			if (zsize > 0)
+			{
+				output->write(zbuffer.data(), zsize);
+				bytes_out += zsize;
+			}
+
+			// Done when all input is consumed and deflate had room to spare for pending output
+			if (result == MZ_STREAM_END || (zs.avail_in == 0 && zs.avail_out != 0))
+				break;
+		}
+	}
+}
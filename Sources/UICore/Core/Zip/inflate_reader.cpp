@@ -0,0 +1,170 @@
+/*
+**  UICore
+**  Copyright (c) 1997-2015 The UICore Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries UICore may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+#include "UICore/precomp.h"
+#include "UICore/Core/Zip/inflate_reader.h"
+#include "UICore/Core/System/exception.h"
+#include "miniz.h"
+#include <vector>
+#include <algorithm>
+#include <cstring>
+
+#undef min
+#undef max
+
+namespace uicore
+{
+	// try_read_64 reads the bit buffer of the decompressor through mz_stream::state, which points to miniz's private
+	// inflate_state. In miniz 9.1.14 that struct begins with the tinfl_decompressor. Check this again when updating miniz,
+	// as a different layout would give back the wrong number of bytes and break reading whatever follows the stream.
+	static_assert(MZ_VERNUM == 0x91E0, "InflateReader depends on the inflate_state layout of miniz 9.1.14");
+
+	class InflateReaderImpl : public InflateReader
+	{
+	public:
+		InflateReaderImpl(const IODevicePtr &input, bool raw);
+		~InflateReaderImpl() { mz_inflateEnd(&zs); }
+
+		bool is_end_of_stream() const override { return end_of_stream; }
+
+		long long size() const override { throw Exception("The size of an InflateReader is unknown"); }
+
+		long long seek(long long position) override;
+		long long seek_from_current(long long offset) override { return seek(bytes_out + offset); }
+		long long seek_from_end(long long offset) override { throw Exception("InflateReader cannot seek from the end"); }
+
+		int try_read(void *data, int size) override { return (int)try_read_64(data, size); }
+		long long try_read_64(void *data, long long size) override;
+		void write(const void *data, int size) override { write_64(data, size); }
+		void write_64(const void *data, long long size) override { throw Exception("Cannot write to an InflateReader"); }
+
+		void close() override { input->close(); }
+
+		InflateReaderImpl(const InflateReaderImpl &) = delete;
+		InflateReaderImpl &operator=(const InflateReaderImpl &) = delete;
+
+	private:
+		IODevicePtr input;
+		mz_stream zs;
+		std::vector<unsigned char> zbuffer;
+		bool end_of_input = false;
+		bool end_of_stream = false;
+
+		// mz_stream::total_out is only 32 bit on some platforms
+		long long bytes_out = 0;
+	};
+
+	std::shared_ptr<InflateReader> InflateReader::create(const IODevicePtr &input, bool raw)
+	{
+		return std::make_shared<InflateReaderImpl>(input, raw);
+	}
+
+	InflateReaderImpl::InflateReaderImpl(const IODevicePtr &input, bool raw) : input(input), zbuffer(64 * 1024)
+	{
+		const int window_bits = 15;
+
+		memset(&zs, 0, sizeof(mz_stream));
+		int result = mz_inflateInit2(&zs, raw ? -window_bits : window_bits);
+		if (result != MZ_OK)
+			throw Exception("Zlib inflateInit failed");
+	}
+
+	long long InflateReaderImpl::seek(long long position)
+	{
+		if (position < bytes_out)
+			throw Exception("InflateReader cannot seek backwards");
+
+		// Decompress and discard until the position is reached
+		unsigned char skip_buffer[4096];
+		while (position > bytes_out)
+		{
+			if (try_read_64(skip_buffer, std::min(position - bytes_out, (long long)sizeof(skip_buffer))) == 0)
+				break;
+		}
+		return bytes_out;
+	}
+
+	long long InflateReaderImpl::try_read_64(void *data, long long size)
+	{
+		if (size < 0)
+			throw Exception("Read failed");
+
+		unsigned char *dest = static_cast<unsigned char *>(data);
+		long long pos = 0;
+		while (pos < size && !end_of_stream)
+		{
+			if (zs.avail_in == 0 && !end_of_input)
+			{
+				zs.next_in = zbuffer.data();
+				zs.avail_in = (unsigned int)input->try_read(zbuffer.data(), zbuffer.size());
+				end_of_input = zs.avail_in == 0;
+			}
+
+			// avail_out is 32 bit
+			unsigned int amount = (unsigned int)std::min(size - pos, 0x40000000LL);
+			zs.next_out = dest + pos;
+			zs.avail_out = amount;
+
+			int result = mz_inflate(&zs, MZ_NO_FLUSH);
+			if (result == MZ_NEED_DICT) throw Exception("Zlib inflate wants a dictionary!");
+			if (result == MZ_DATA_ERROR) throw Exception("Zip data stream is corrupted");
+			if (result == MZ_STREAM_ERROR) throw Exception("Zip stream structure was inconsistent!");
+			if (result == MZ_MEM_ERROR) throw Exception("Zlib did not have enough memory to decompress file!");
+			if (result != MZ_OK && result != MZ_STREAM_END && result != MZ_BUF_ERROR) throw Exception("Zlib inflate failed while decompressing data!");
+
+			long long produced = amount - zs.avail_out;
+			pos += produced;
+			bytes_out += produced;
+
+			if (result == MZ_STREAM_END)
+			{
+				end_of_stream = true;
+
+				// Give back the input that belongs to whatever follows the compressed stream.
+				// The decompressor may also have read a few bytes ahead into its bit buffer (see the static_assert above).
+				long long unused = zs.avail_in + reinterpret_cast<const tinfl_decompressor *>(zs.state)->m_num_bits / 8;
+				if (unused > 0)
+				{
+					try
+					{
+						input->seek_from_current(-unused);
+					}
+					catch (const Exception &)
+					{
+					}
+				}
+				zs.avail_in = 0;
+			}
+			else if (produced == 0 && zs.avail_in == 0 && end_of_input)
+			{
+				throw Exception("Unexpected end of compressed data");
+			}
+		}
+		return pos;
+	}
+}
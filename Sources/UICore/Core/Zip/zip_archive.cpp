@@ -0,0 +1,340 @@
+/*
+**  UICore
+**  Copyright (c) 1997-2015 The UICore Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries UICore may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+#include "UICore/precomp.h"
+#include "UICore/Core/Zip/zip_archive.h"
+#include "UICore/Core/Zip/inflate_reader.h"
+#include "UICore/Core/IOData/mapped_file.h"
+#include "UICore/Core/IOData/memory_device.h"
+#include "UICore/Core/System/exception.h"
+#include <unordered_map>
+#include <algorithm>
+#include <mutex>
+
+#undef min
+#undef max
+
+namespace uicore
+{
+	class ZipArchiveEntry
+	{
+	public:
+		std::string name;
+		unsigned int flags = 0;
+		unsigned int compression_method = 0;
+		long long compressed_size = 0;
+		long long uncompressed_size = 0;
+		long long local_header_offset = 0;
+	};
+
+	class ZipArchiveImpl : public ZipArchive
+	{
+	public:
+		ZipArchiveImpl(const std::string &filename);
+
+		std::vector<std::string> files() const override;
+		bool exists(const std::string &name) const override { return find(name) != nullptr; }
+		long long file_size(const std::string &name) const override { return entry(name).uncompressed_size; }
+		IODevicePtr open_file(const std::string &name) override;
+		DataBufferPtr read_all_bytes(const std::string &name) override;
+
+	private:
+		void read_central_directory();
+		const ZipArchiveEntry *find(const std::string &name) const;
+		const ZipArchiveEntry &entry(const std::string &name) const;
+		DataBufferPtr compressed_data(const ZipArchiveEntry &entry);
+
+		static unsigned int read_uint16(const unsigned char *p) { return p[0] | (p[1] << 8); }
+		static unsigned int read_uint32(const unsigned char *p) { return p[0] | (p[1] << 8) | (p[2] << 16) | ((unsigned int)p[3] << 24); }
+
+		MappedFilePtr file;
+		std::vector<ZipArchiveEntry> entries;
+		std::unordered_map<std::string, size_t> index;
+	};
+
+	/// \brief Deflated file in a zip archive
+	///
+	/// Seeking backwards restarts decompression from the beginning of the file.
+	class ZipArchiveFileDevice : public IODevice
+	{
+	public:
+		ZipArchiveFileDevice(const DataBufferPtr &compressed, long long uncompressed_size) : compressed(compressed), uncompressed_size(uncompressed_size) { restart(); }
+
+		long long size() const override { return uncompressed_size; }
+
+		long long seek(long long position) override
+		{
+			position = std::max(std::min(position, uncompressed_size), 0LL);
+			if (position < pos)
+				restart();
+			pos = reader->seek(position);
+			return pos;
+		}
+
+		long long seek_from_current(long long offset) override { return seek(pos + offset); }
+		long long seek_from_end(long long offset) override { return seek(uncompressed_size + offset); }
+
+		int try_read(void *data, int size) override { return (int)try_read_64(data, size); }
+		long long try_read_64(void *data, long long size) override
+		{
+			long long bytes_read = reader->try_read_64(data, std::min(size, uncompressed_size - pos));
+			pos += bytes_read;
+			return bytes_read;
+		}
+
+		void write(const void *data, int size) override { write_64(data, size); }
+		void write_64(const void *data, long long size) override { throw Exception("Cannot write to a file in a zip archive"); }
+
+	private:
+		void restart()
+		{
+			reader = InflateReader::create(MemoryDevice::open(compressed), true);
+			pos = 0;
+		}
+
+		DataBufferPtr compressed;
+		long long uncompressed_size;
+		InflateReaderPtr reader;
+		long long pos = 0;
+	};
+
+	class ZipArchiveMounts
+	{
+	public:
+		static ZipArchiveMounts *instance()
+		{
+			static ZipArchiveMounts mounts;
+			return &mounts;
+		}
+
+		static std::string normalize(std::string path)
+		{
+			std::replace(path.begin(), path.end(), '\\', '/');
+			while (!path.empty() && path.back() == '/')
+				path.pop_back();
+			return path;
+		}
+
+		std::mutex mutex;
+		std::vector<std::pair<std::string, ZipArchivePtr>> archives;
+	};
+
+	ZipArchivePtr ZipArchive::open(const std::string &filename)
+	{
+		return std::make_shared<ZipArchiveImpl>(filename);
+	}
+
+	void ZipArchive::mount(const std::string &path, const ZipArchivePtr &archive)
+	{
+		auto mounts = ZipArchiveMounts::instance();
+		std::string mount_path = ZipArchiveMounts::normalize(path);
+		std::unique_lock<std::mutex> lock(mounts->mutex);
+		auto it = std::find_if(mounts->archives.begin(), mounts->archives.end(), [&](const std::pair<std::string, ZipArchivePtr> &mount) { return mount.first == mount_path; });
+		if (it != mounts->archives.end())
+			it->second = archive;
+		else
+			mounts->archives.push_back({ mount_path, archive });
+	}
+
+	void ZipArchive::unmount(const std::string &path)
+	{
+		auto mounts = ZipArchiveMounts::instance();
+		std::string mount_path = ZipArchiveMounts::normalize(path);
+		std::unique_lock<std::mutex> lock(mounts->mutex);
+		mounts->archives.erase(std::remove_if(mounts->archives.begin(), mounts->archives.end(), [&](const std::pair<std::string, ZipArchivePtr> &mount) { return mount.first == mount_path; }), mounts->archives.end());
+	}
+
+	bool ZipArchive::find_mounted(const std::string &filename, ZipArchivePtr &out_archive, std::string &out_name)
+	{
+		auto mounts = ZipArchiveMounts::instance();
+		std::unique_lock<std::mutex> lock(mounts->mutex);
+		if (mounts->archives.empty())
+			return false;
+
+		std::string path = ZipArchiveMounts::normalize(filename);
+		for (auto it = mounts->archives.rbegin(); it != mounts->archives.rend(); ++it)
+		{
+			const std::string &mount_path = it->first;
+			if (path.size() > mount_path.size() && path[mount_path.size()] == '/' && path.compare(0, mount_path.size(), mount_path) == 0)
+			{
+				std::string name = path.substr(mount_path.size() + 1);
+				while (name.compare(0, 2, "./") == 0)
+					name = name.substr(2);
+
+				if (it->second->exists(name))
+				{
+					out_archive = it->second;
+					out_name = name;
+					return true;
+				}
+			}
+		}
+		return false;
+	}
+
+	ZipArchiveImpl::ZipArchiveImpl(const std::string &filename) : file(MappedFile::open(filename, MappedFileUsage::random))
+	{
+		read_central_directory();
+	}
+
+	void ZipArchiveImpl::read_central_directory()
+	{
+		const unsigned char *data = reinterpret_cast<const unsigned char *>(file->data());
+		long long size = file->size();
+
+		// The end of central directory record is followed by a comment of up to 64 KB
+		const long long end_record_size = 22;
+		long long end_record = -1;
+		for (long long pos = size - end_record_size; pos >= 0 && pos >= size - end_record_size - 0xffff; pos--)
+		{
+			if (read_uint32(data + pos) == 0x06054b50)
+			{
+				end_record = pos;
+				break;
+			}
+		}
+		if (end_record == -1)
+			throw Exception("Not a zip archive");
+
+		unsigned int entry_count = read_uint16(data + end_record + 10);
+		long long directory_size = read_uint32(data + end_record + 12);
+		long long directory_offset = read_uint32(data + end_record + 16);
+		if (entry_count == 0xffff || directory_offset == 0xffffffff)
+			throw Exception("Zip64 archives are not supported");
+		if (directory_offset + directory_size > end_record)
+			throw Exception("Zip archive central directory is corrupt");
+
+		entries.reserve(entry_count);
+		index.reserve(entry_count);
+
+		const long long header_size = 46;
+		long long pos = directory_offset;
+		for (unsigned int i = 0; i < entry_count; i++)
+		{
+			const unsigned char *header = data + pos;
+			if (pos + header_size > end_record || read_uint32(header) != 0x02014b50)
+				throw Exception("Zip archive central directory is corrupt");
+
+			unsigned int name_length = read_uint16(header + 28);
+			unsigned int extra_length = read_uint16(header + 30);
+			unsigned int comment_length = read_uint16(header + 32);
+			if (pos + header_size + name_length > end_record)
+				throw Exception("Zip archive central directory is corrupt");
+
+			ZipArchiveEntry entry;
+			entry.name.assign(reinterpret_cast<const char *>(header + header_size), name_length);
+			entry.flags = read_uint16(header + 8);
+			entry.compression_method = read_uint16(header + 10);
+			entry.compressed_size = read_uint32(header + 20);
+			entry.uncompressed_size = read_uint32(header + 24);
+			entry.local_header_offset = read_uint32(header + 42);
+			if (entry.compressed_size == 0xffffffff || entry.uncompressed_size == 0xffffffff || entry.local_header_offset == 0xffffffff)
+				throw Exception("Zip64 archives are not supported");
+
+			pos += header_size + name_length + extra_length + comment_length;
+
+			std::replace(entry.name.begin(), entry.name.end(), '\\', '/');
+			if (entry.name.empty() || entry.name.back() == '/')
+				continue; // Directory entry
+
+			index[entry.name] = entries.size();
+			entries.push_back(std::move(entry));
+		}
+	}
+
+	std::vector<std::string> ZipArchiveImpl::files() const
+	{
+		std::vector<std::string> names;
+		names.reserve(entries.size());
+		for (const auto &entry : entries)
+			names.push_back(entry.name);
+		return names;
+	}
+
+	const ZipArchiveEntry *ZipArchiveImpl::find(const std::string &name) const
+	{
+		auto it = index.find(name);
+		if (it == index.end() && name.find('\\') != std::string::npos)
+		{
+			std::string zip_name = name;
+			std::replace(zip_name.begin(), zip_name.end(), '\\', '/');
+			it = index.find(zip_name);
+		}
+		return it != index.end() ? &entries[it->second] : nullptr;
+	}
+
+	const ZipArchiveEntry &ZipArchiveImpl::entry(const std::string &name) const
+	{
+		const ZipArchiveEntry *entry = find(name);
+		if (!entry)
+			throw Exception("File not found in zip archive: " + name);
+		return *entry;
+	}
+
+	DataBufferPtr ZipArchiveImpl::compressed_data(const ZipArchiveEntry &entry)
+	{
+		if (entry.flags & 1)
+			throw Exception("Encrypted zip archive files are not supported: " + entry.name);
+		if (entry.compression_method != 0 && entry.compression_method != 8)
+			throw Exception("Unsupported zip compression method: " + entry.name);
+
+		// The local header may have a different extra field length than the central directory
+		const unsigned char *data = reinterpret_cast<const unsigned char *>(file->data());
+		const long long header_size = 30;
+		if (entry.local_header_offset + header_size > file->size() || read_uint32(data + entry.local_header_offset) != 0x04034b50)
+			throw Exception("Zip archive local file header is corrupt: " + entry.name);
+
+		long long offset = entry.local_header_offset + header_size + read_uint16(data + entry.local_header_offset + 26) + read_uint16(data + entry.local_header_offset + 28);
+		if (offset + entry.compressed_size > file->size())
+			throw Exception("Zip archive file data is truncated: " + entry.name);
+
+		return file->view(offset, entry.compressed_size);
+	}
+
+	IODevicePtr ZipArchiveImpl::open_file(const std::string &name)
+	{
+		const ZipArchiveEntry &file_entry = entry(name);
+		auto data = compressed_data(file_entry);
+		if (file_entry.compression_method == 0)
+			return MemoryDevice::open(data);
+		else
+			return std::make_shared<ZipArchiveFileDevice>(data, file_entry.uncompressed_size);
+	}
+
+	DataBufferPtr ZipArchiveImpl::read_all_bytes(const std::string &name)
+	{
+		const ZipArchiveEntry &file_entry = entry(name);
+		auto data = compressed_data(file_entry);
+		if (file_entry.compression_method == 0)
+			return data;
+
+		auto buffer = DataBuffer::create((size_t)file_entry.uncompressed_size);
+		InflateReader::create(MemoryDevice::open(data), true)->read(buffer->data(), buffer->size());
+		return buffer;
+	}
+}
@@ -28,20 +28,166 @@
 
 #include "UICore/precomp.h"
 #include "UICore/Core/Zip/zlib_compression.h"
+#include "UICore/Core/Zip/deflate_writer.h"
+#include "UICore/Core/Zip/inflate_reader.h"
 #include "UICore/Core/System/databuffer.h"
 #include "UICore/Core/IOData/memory_device.h"
+#include "UICore/Core/System/system.h"
+#include "UICore/Core/System/exception.h"
 
 #define INCLUDED_FROM_ZLIB_COMPRESSION_CPP
 #include "miniz.h"
+#include <algorithm>
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <exception>
+
+#undef min
+#undef max
 
 namespace uicore
 {
 	DataBufferPtr ZLibCompression::compress(const DataBufferPtr &data, bool raw, int compression_level, CompressionMode mode)
 	{
-		const int window_bits = 15;
-
-		auto zbuffer = DataBuffer::create(1024 * 1024);
 		auto output = MemoryDevice::create();
+		auto writer = DeflateWriter::create(output, raw, compression_level, mode);
+		writer->write_64(data->data(), data->size());
+		writer->finish();
+		return output->buffer();
+	}
+
+	class ParallelDeflateBlock
+	{
+	public:
+		std::vector<unsigned char> output;
+		size_t output_size = 0;
+		unsigned int adler = 1;
+	};
+
+	class ParallelDeflate
+	{
+	public:
+		ParallelDeflate(const DataBufferPtr &data, int compression_level, int strategy) : data(data), compression_level(compression_level), strategy(strategy)
+		{
+			blocks.resize((data->size() + block_size - 1) / block_size);
+		}
+
+		void compress_blocks()
+		{
+			const int window_bits = 15;
+
+			mz_stream zs;
+			memset(&zs, 0, sizeof(mz_stream));
+			if (mz_deflateInit2(&zs, compression_level, MZ_DEFLATED, -window_bits, 8, strategy) != MZ_OK)
+				throw Exception("Zlib deflateInit failed");
+
+			try
+			{
+				while (true)
+				{
+					size_t index = next_block++;
+					if (index >= blocks.size())
+						break;
+					compress_block(zs, index);
+				}
+			}
+			catch (...)
+			{
+				mz_deflateEnd(&zs);
+				throw;
+			}
+			mz_deflateEnd(&zs);
+		}
+
+		static const size_t block_size = 256 * 1024;
+		static const size_t dictionary_size = 32 * 1024;
+
+		DataBufferPtr data;
+		int compression_level;
+		int strategy;
+		std::vector<ParallelDeflateBlock> blocks;
+		std::atomic<size_t> next_block{ 0 };
+
+	private:
+		void compress_block(mz_stream &zs, size_t index)
+		{
+			const unsigned char *input = reinterpret_cast<const unsigned char *>(data->data());
+			size_t start = index * block_size;
+			size_t length = std::min(block_size, data->size() - start);
+			bool last_block = index + 1 == blocks.size();
+
+			ParallelDeflateBlock &block = blocks[index];
+			block.adler = (unsigned int)mz_adler32(MZ_ADLER32_INIT, input + start, length);
+
+			mz_deflateReset(&zs);
+
+			// zlib's deflateSetDictionary is missing in miniz. Compressing the preceding data and discarding the
+			// output leaves the same window behind. The sync flush byte aligns the stream for the block that follows.
+			if (start > 0)
+			{
+				size_t dict_length = std::min(dictionary_size, start);
+				block.output.resize(mz_deflateBound(&zs, dict_length) + 64);
+				zs.next_in = input + start - dict_length;
+				zs.avail_in = (unsigned int)dict_length;
+				deflate(zs, block, MZ_SYNC_FLUSH);
+				block.output_size = 0;
+			}
+
+			block.output.resize(mz_deflateBound(&zs, length) + 64);
+			zs.next_in = input + start;
+			zs.avail_in = (unsigned int)length;
+			deflate(zs, block, last_block ? MZ_FINISH : MZ_SYNC_FLUSH);
+		}
+
+		static void deflate(mz_stream &zs, ParallelDeflateBlock &block, int flush)
+		{
+			while (true)
+			{
+				if (block.output_size == block.output.size())
+					block.output.resize(block.output.size() * 2);
+
+				zs.next_out = block.output.data() + block.output_size;
+				zs.avail_out = (unsigned int)(block.output.size() - block.output_size);
+
+				int result = mz_deflate(&zs, flush);
+				if (result == MZ_STREAM_ERROR) throw Exception("Zip stream structure was inconsistent!");
+				if (result == MZ_PARAM_ERROR) throw Exception("Invalid zlib deflate parameter");
+				if (result != MZ_OK && result != MZ_STREAM_END && result != MZ_BUF_ERROR) throw Exception("Zlib deflate failed while compressing data!");
+
+				block.output_size = block.output.size() - zs.avail_out;
+
+				if (result == MZ_STREAM_END || (zs.avail_in == 0 && zs.avail_out != 0))
+					break;
+			}
+		}
+	};
+
+	// Adler-32 of two concatenated buffers, given the checksum of each and the length of the second
+	static unsigned int adler32_combine(unsigned int adler1, unsigned int adler2, unsigned long long length2)
+	{
+		const unsigned int base = 65521;
+		unsigned int remainder = (unsigned int)(length2 % base);
+		unsigned int sum1 = adler1 & 0xffff;
+		unsigned int sum2 = (unsigned int)(((unsigned long long)remainder * sum1) % base);
+		sum1 += (adler2 & 0xffff) + base - 1;
+		sum2 += ((adler1 >> 16) & 0xffff) + ((adler2 >> 16) & 0xffff) + base - remainder;
+		if (sum1 >= base) sum1 -= base;
+		if (sum1 >= base) sum1 -= base;
+		if (sum2 >= (base << 1)) sum2 -= (base << 1);
+		if (sum2 >= base) sum2 -= base;
+		return sum1 | (sum2 << 16);
+	}
+
+	DataBufferPtr ZLibCompression::compress_parallel(const DataBufferPtr &data, bool raw, int compression_level, CompressionMode mode, int num_threads)
+	{
+		if (num_threads <= 0)
+			num_threads = System::num_cores();
+
+		size_t num_blocks = (data->size() + ParallelDeflate::block_size - 1) / ParallelDeflate::block_size;
+		num_threads = (int)std::min((size_t)num_threads, num_blocks);
+		if (num_threads <= 1)
+			return compress(data, raw, compression_level, mode);
 
 		int strategy = MZ_DEFAULT_STRATEGY;
 		switch (mode)
@@ -53,83 +199,101 @@ namespace uicore
 		case fixed: strategy = MZ_FIXED; break;
 		}
 
-		mz_stream zs = { nullptr };
-		int result = mz_deflateInit2(&zs, compression_level, MZ_DEFLATED, raw ? -window_bits : window_bits, 8, strategy); // Undocumented: if wbits is negative, zlib skips header check
-		if (result != MZ_OK)
-			throw Exception("Zlib deflateInit failed");
+		ParallelDeflate deflate(data, compression_level, strategy);
 
-		try
+		std::vector<std::exception_ptr> errors(num_threads);
+		std::vector<std::thread> threads;
+		for (int i = 1; i < num_threads; i++)
 		{
-			zs.next_in = (unsigned char *)data->data();
-			zs.avail_in = data->size();
-			while (true)
+			threads.push_back(std::thread([&deflate, &errors, i]()
 			{
-				zs.next_out = (unsigned char *)zbuffer->data();
-				zs.avail_out = zbuffer->size();
+				try
+				{
+					deflate.compress_blocks();
+				}
+				catch (...)
+				{
+					errors[i] = std::current_exception();
+				}
+			}));
+		}
 
-				int result = mz_deflate(&zs, MZ_FINISH);
-				if (result == MZ_NEED_DICT) throw Exception("Zlib deflate wants a dictionary!");
-				if (result == MZ_DATA_ERROR) throw Exception("Zip data stream is corrupted");
-				if (result == MZ_STREAM_ERROR) throw Exception("Zip stream structure was inconsistent!");
-				if (result == MZ_MEM_ERROR) throw Exception("Zlib did not have enough memory to compress file!");
-				if (result == MZ_BUF_ERROR) throw Exception("Not enough data in buffer when Z_FINISH was used");
-				if (result != MZ_OK && result != MZ_STREAM_END) throw Exception("Zlib deflate failed while compressing zip file!");
-				int zsize = zbuffer->size() - zs.avail_out;
-				if (zsize == 0)
-					break;
-				output->write(zbuffer->data(), zsize);
-				if (result == MZ_STREAM_END)
-					break;
-			}
-			mz_deflateEnd(&zs);
+		try
+		{
+			deflate.compress_blocks();
 		}
 		catch (...)
 		{
-			mz_deflateEnd(&zs);
-			throw;
+			errors[0] = std::current_exception();
 		}
 
-		return output->buffer();
-	}
+		for (auto &thread : threads)
+			thread.join();
 
-	DataBufferPtr ZLibCompression::decompress(const DataBufferPtr &data, bool raw)
-	{
-		const int window_bits = 15;
+		for (auto &error : errors)
+		{
+			if (error)
+				std::rethrow_exception(error);
+		}
 
-		auto zbuffer = DataBuffer::create(1024 * 1024);
-		auto output = MemoryDevice::create();
+		size_t output_size = raw ? 0 : 6;
+		for (auto &block : deflate.blocks)
+			output_size += block.output_size;
 
-		mz_stream zs = { nullptr };
-		int result = mz_inflateInit2(&zs, raw ? -window_bits : window_bits);
-		if (result != MZ_OK)
-			throw Exception("Zlib inflateInit failed");
+		auto output = DataBuffer::create(output_size);
+		unsigned char *dest = reinterpret_cast<unsigned char *>(output->data());
 
+		if (!raw)
+		{
+			// Same header as tdefl writes: 32 KB window, level hint in FLEVEL and check bits in FCHECK
+			unsigned int level_hint = compression_level <= 1 ? 0 : compression_level <= 5 ? 1 : compression_level == 6 ? 2 : 3;
+			unsigned int header = (0x78 << 8) | (level_hint << 6);
+			if (header % 31 != 0)
+				header += 31 - header % 31;
+			*(dest++) = (unsigned char)(header >> 8);
+			*(dest++) = (unsigned char)header;
+		}
 
-		zs.next_in = (unsigned char *)data->data();
-		zs.avail_in = data->size();
+		unsigned int adler = MZ_ADLER32_INIT;
+		size_t start = 0;
+		for (auto &block : deflate.blocks)
+		{
+			memcpy(dest, block.output.data(), block.output_size);
+			dest += block.output_size;
 
-		// Continue feeding zlib data until we get our data:
-		while (true)
+			size_t length = std::min(ParallelDeflate::block_size, data->size() - start);
+			adler = adler32_combine(adler, block.adler, length);
+			start += length;
+		}
+
+		if (!raw)
 		{
-			zs.next_out = (unsigned char *)zbuffer->data();
-			zs.avail_out = zbuffer->size();
+			*(dest++) = (unsigned char)(adler >> 24);
+			*(dest++) = (unsigned char)(adler >> 16);
+			*(dest++) = (unsigned char)(adler >> 8);
+			*(dest++) = (unsigned char)adler;
+		}
 
-			// Decompress data:
-			int result = mz_inflate(&zs, 0);
-			if (result == MZ_NEED_DICT) throw Exception("Zlib inflate wants a dictionary!");
-			if (result == MZ_DATA_ERROR) throw Exception("Zip data stream is corrupted");
-			if (result == MZ_STREAM_ERROR) throw Exception("Zip stream structure was inconsistent!");
-			if (result == MZ_MEM_ERROR) throw Exception("Zlib did not have enough memory to decompress file!");
-			if (result == MZ_BUF_ERROR) throw Exception("Not enough data in buffer when Z_FINISH was used");
-			if (result != MZ_OK && result != MZ_STREAM_END) throw Exception("Zlib inflate failed while decompressing zip file!");
+		return output;
+	}
+
+	DataBufferPtr ZLibCompression::decompress(const DataBufferPtr &data, bool raw)
+	{
+		auto reader = InflateReader::create(MemoryDevice::open(data), raw);
 
-			output->write(zbuffer->data(), zbuffer->size() - zs.avail_out);
+		auto output = DataBuffer::create(0);
+		size_t size = 0;
+		while (true)
+		{
+			if (size == output->size())
+				output->set_size(std::max(size * 2, (size_t)64 * 1024));
 
-			if (result == MZ_STREAM_END)
+			long long bytes_read = reader->try_read_64(output->data() + size, output->size() - size);
+			if (bytes_read == 0)
 				break;
+			size += (size_t)bytes_read;
 		}
-		mz_inflateEnd(&zs);
-
-		return output->buffer();
+		output->set_size(size);
+		return output;
 	}
 }
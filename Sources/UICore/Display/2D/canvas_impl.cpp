@@ -29,6 +29,7 @@
 
 #include "UICore/precomp.h"
 #include "canvas_impl.h"
+#include "display_list.h"
 #include "UICore/Display/2D/render_batcher.h"
 #include "UICore/Display/Render/graphic_context_impl.h"
 
@@ -110,8 +111,18 @@ namespace uicore
 		batcher.update_batcher_matrix(_gc, canvas_transform, canvas_projection, canvas_y_axis);
 	}
 
+	void CanvasImpl::record_unsupported()
+	{
+		if (recording)
+			recording->add_unsupported();
+	}
+
 	void CanvasImpl::set_batcher(RenderBatcher *new_batcher)
 	{
+		// Only the triangle and path batchers record what they draw
+		if (recording && new_batcher != batcher.get_triangle_batcher() && new_batcher != batcher.get_path_batcher())
+			record_unsupported();
+
 		if (batcher.set_batcher(gc(), new_batcher))
 			update_batcher_matrix();
 	}
@@ -202,6 +213,8 @@ namespace uicore
 
 	void CanvasImpl::clear(const Colorf &color)
 	{
+		record_unsupported();
+
 		if (!cliprects.empty()) // D3D target doesn't restrict clear to the scissor rect
 		{
 			batcher.flush();
@@ -238,6 +251,8 @@ namespace uicore
 
 	void CanvasImpl::set_clip(const Rectf &rect)
 	{
+		record_unsupported();
+
 		batcher.flush();
 
 		if (!cliprects.empty())
@@ -249,6 +264,8 @@ namespace uicore
 
 	void CanvasImpl::push_clip(const Rectf &rect)
 	{
+		record_unsupported();
+
 		batcher.flush();
 
 		if (!cliprects.empty())
@@ -267,6 +284,8 @@ namespace uicore
 
 	void CanvasImpl::push_clip()
 	{
+		record_unsupported();
+
 		batcher.flush();
 
 		if (cliprects.empty())
@@ -283,6 +302,8 @@ namespace uicore
 
 	void CanvasImpl::pop_clip()
 	{
+		record_unsupported();
+
 		if (!cliprects.empty())
 		{
 			batcher.flush();
@@ -298,6 +319,8 @@ namespace uicore
 
 	void CanvasImpl::reset_clip()
 	{
+		record_unsupported();
+
 		if (!cliprects.empty())
 		{
 			batcher.flush();
@@ -43,6 +43,7 @@ namespace uicore
 {
 	class RenderBatcher;
 	class RenderBatchTriangle;
+	class DisplayList;
 
 	enum MapMode
 	{
@@ -100,6 +101,12 @@ namespace uicore
 		std::vector<Rectf> cliprects;
 		CanvasBatcher batcher;
 
+		/// Display list capturing the drawing commands, if any
+		DisplayList *recording = nullptr;
+
+		/// Called by drawing functions that are not captured by display lists
+		void record_unsupported();
+
 	private:
 		void calculate_map_mode_matrices();
 		MapMode top_down_map_mode() const;
@@ -0,0 +1,184 @@
+/*
+**  UICore
+**  Copyright (c) 1997-2015 The UICore Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries UICore may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+#include "UICore/precomp.h"
+#include "display_list.h"
+#include "canvas_impl.h"
+#include "path_impl.h"
+#include "render_batch_triangle.h"
+#include <cmath>
+
+namespace uicore
+{
+	unsigned int DisplayList::current_generation = 0;
+
+	void DisplayList::begin_record(const CanvasPtr &canvas, const Mat4f &origin)
+	{
+		clear();
+		record_origin = origin;
+		record_pixel_ratio = canvas->pixel_ratio();
+		generation = current_generation;
+		static_cast<CanvasImpl*>(canvas.get())->recording = this;
+	}
+
+	void DisplayList::end_record(const CanvasPtr &canvas)
+	{
+		static_cast<CanvasImpl*>(canvas.get())->recording = nullptr;
+		valid = true;
+	}
+
+	bool DisplayList::can_replay(const CanvasPtr &canvas, const Mat4f &origin) const
+	{
+		if (!valid || unsupported || generation != current_generation || canvas->pixel_ratio() != record_pixel_ratio)
+			return false;
+
+		for (int i = 0; i < 16; i++)
+		{
+			if (i != 12 && i != 13 && origin.matrix[i] != record_origin.matrix[i])
+				return false;
+		}
+
+		// Glyphs and path edges are placed on the pixel grid, so only whole pixel offsets give the same result
+		for (int i = 12; i < 14; i++)
+		{
+			float offset = (origin.matrix[i] - record_origin.matrix[i]) * record_pixel_ratio;
+			if (std::abs(offset - std::round(offset)) > 0.001f)
+				return false;
+		}
+		return true;
+	}
+
+	void DisplayList::replay(const CanvasPtr &canvas, const Mat4f &origin) const
+	{
+		Mat4f old_transform = canvas->transform();
+		Mat4f offset = Mat4f::translate(origin.matrix[12] - record_origin.matrix[12], origin.matrix[13] - record_origin.matrix[13], 0.0f);
+
+		RenderBatchTriangle *triangle_batcher = static_cast<CanvasImpl*>(canvas.get())->batcher.get_triangle_batcher();
+
+		int current_transform = -1;
+		for (const auto &command : commands)
+		{
+			if (command.transform != current_transform)
+			{
+				canvas->set_transform(offset * transforms[command.transform]);
+				current_transform = command.transform;
+			}
+
+			switch (command.type)
+			{
+			case CommandType::image:
+			{
+				const ImageCommand &image = images[command.index];
+				triangle_batcher->draw_image(canvas, image.src, Rectf(image.dest.p.x, image.dest.p.y, image.dest.r.x, image.dest.r.y), image.color, image.texture);
+				break;
+			}
+			case CommandType::image_quad:
+			{
+				const ImageCommand &image = images[command.index];
+				triangle_batcher->draw_image(canvas, image.src, image.dest, image.color, image.texture);
+				break;
+			}
+			case CommandType::glyph_subpixel:
+			{
+				const ImageCommand &image = images[command.index];
+				triangle_batcher->draw_glyph_subpixel(canvas, image.src, Rectf(image.dest.p.x, image.dest.p.y, image.dest.r.x, image.dest.r.y), image.color, image.texture);
+				break;
+			}
+			case CommandType::fill:
+				paths[command.index].path->fill(canvas, paths[command.index].brush);
+				break;
+			case CommandType::stroke:
+				paths[command.index].path->stroke(canvas, paths[command.index].pen);
+				break;
+			}
+		}
+
+		canvas->set_transform(old_transform);
+	}
+
+	void DisplayList::clear()
+	{
+		commands.clear();
+		images.clear();
+		paths.clear();
+		transforms.clear();
+		valid = false;
+		unsupported = false;
+	}
+
+	void DisplayList::invalidate_all()
+	{
+		current_generation++;
+	}
+
+	void DisplayList::add_image(const Mat4f &transform, const Rectf &src, const Rectf &dest, const Colorf &color, const Texture2DPtr &texture)
+	{
+		ImageCommand image = { src, Quadf(dest), color, texture };
+		commands.push_back({ CommandType::image, transform_index(transform), (int)images.size() });
+		images.push_back(image);
+	}
+
+	void DisplayList::add_image(const Mat4f &transform, const Rectf &src, const Quadf &dest, const Colorf &color, const Texture2DPtr &texture)
+	{
+		ImageCommand image = { src, dest, color, texture };
+		commands.push_back({ CommandType::image_quad, transform_index(transform), (int)images.size() });
+		images.push_back(image);
+	}
+
+	void DisplayList::add_glyph_subpixel(const Mat4f &transform, const Rectf &src, const Rectf &dest, const Colorf &color, const Texture2DPtr &texture)
+	{
+		ImageCommand image = { src, Quadf(dest), color, texture };
+		commands.push_back({ CommandType::glyph_subpixel, transform_index(transform), (int)images.size() });
+		images.push_back(image);
+	}
+
+	void DisplayList::add_fill(const Mat4f &transform, const PathImpl &path, const Brush &brush)
+	{
+		PathCommand command;
+		command.path = path.clone();
+		command.brush = brush;
+		commands.push_back({ CommandType::fill, transform_index(transform), (int)paths.size() });
+		paths.push_back(command);
+	}
+
+	void DisplayList::add_stroke(const Mat4f &transform, const PathImpl &path, const Pen &pen)
+	{
+		PathCommand command;
+		command.path = path.clone();
+		command.pen = pen;
+		commands.push_back({ CommandType::stroke, transform_index(transform), (int)paths.size() });
+		paths.push_back(command);
+	}
+
+	int DisplayList::transform_index(const Mat4f &transform)
+	{
+		if (transforms.empty() || !(transforms.back() == transform))
+			transforms.push_back(transform);
+		return (int)transforms.size() - 1;
+	}
+}
@@ -0,0 +1,127 @@
+/*
+**  UICore
+**  Copyright (c) 1997-2015 The UICore Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries UICore may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+#pragma once
+
+#include "UICore/Display/2D/canvas.h"
+#include "UICore/Display/2D/brush.h"
+#include "UICore/Display/2D/pen.h"
+#include "UICore/Display/2D/path.h"
+#include "UICore/Display/Render/texture_2d.h"
+#include "UICore/Core/Math/quad.h"
+#include <vector>
+
+namespace uicore
+{
+	class PathImpl;
+
+	/// Drawing commands captured from a canvas, so they can be drawn again without repeating the work that produced them
+	///
+	/// Commands are stored with the canvas transform they were drawn with. A list can be replayed at a different position
+	/// if the transform only differs by a whole pixel translation.
+	///
+	/// Only images, glyphs and paths drawn through the canvas are captured. Other canvas drawing marks the list as unsupported.
+	/// Drawing directly on the graphic context bypasses the canvas and can not be detected, so it must not be used while recording.
+	class DisplayList
+	{
+	public:
+		/// Starts capturing the commands drawn on the canvas. The commands are still drawn as normal.
+		///
+		/// The origin is the transform that positions the drawing. It is compared against the origin given when replaying.
+		void begin_record(const CanvasPtr &canvas, const Mat4f &origin);
+		void end_record(const CanvasPtr &canvas);
+
+		/// Test if the list can be replayed at the specified origin
+		bool can_replay(const CanvasPtr &canvas, const Mat4f &origin) const;
+
+		/// Draws the recorded commands, offset by the difference between the specified origin and the one used when recording
+		void replay(const CanvasPtr &canvas, const Mat4f &origin) const;
+
+		/// Throws away the recorded commands
+		void clear();
+
+		/// Makes every display list unusable. Called when resources they may reference, such as glyph textures, are reused.
+		static void invalidate_all();
+
+		void add_image(const Mat4f &transform, const Rectf &src, const Rectf &dest, const Colorf &color, const Texture2DPtr &texture);
+		void add_image(const Mat4f &transform, const Rectf &src, const Quadf &dest, const Colorf &color, const Texture2DPtr &texture);
+		void add_glyph_subpixel(const Mat4f &transform, const Rectf &src, const Rectf &dest, const Colorf &color, const Texture2DPtr &texture);
+		void add_fill(const Mat4f &transform, const PathImpl &path, const Brush &brush);
+		void add_stroke(const Mat4f &transform, const PathImpl &path, const Pen &pen);
+
+		/// Marks the list as not replayable because something was drawn that can not be captured
+		void add_unsupported() { unsupported = true; }
+
+	private:
+		enum class CommandType
+		{
+			image,
+			image_quad,
+			glyph_subpixel,
+			fill,
+			stroke
+		};
+
+		struct Command
+		{
+			CommandType type;
+			int transform;
+			int index;
+		};
+
+		struct ImageCommand
+		{
+			Rectf src;
+			Quadf dest;
+			Colorf color;
+			Texture2DPtr texture;
+		};
+
+		struct PathCommand
+		{
+			std::shared_ptr<Path> path;
+			Brush brush;
+			Pen pen;
+		};
+
+		int transform_index(const Mat4f &transform);
+
+		std::vector<Command> commands;
+		std::vector<ImageCommand> images;
+		std::vector<PathCommand> paths;
+		std::vector<Mat4f> transforms;
+
+		Mat4f record_origin;
+		float record_pixel_ratio = 0.0f;
+		unsigned int generation = 0;
+		bool valid = false;
+		bool unsupported = false;
+
+		static unsigned int current_generation;
+	};
+}
@@ -32,6 +32,7 @@
 #include "path_impl.h"
 #include "canvas_impl.h"
 #include "render_batch_path.h"
+#include "display_list.h"
 #include "../Font/font_impl.h"
 
 namespace uicore
@@ -184,19 +185,34 @@ namespace uicore
 
 	void PathImpl::stroke(const CanvasPtr &canvas, const Pen &pen)
 	{
-		RenderBatchPath *batcher = static_cast<CanvasImpl*>(canvas.get())->batcher.get_path_batcher();
+		CanvasImpl *canvas_impl = static_cast<CanvasImpl*>(canvas.get());
+		if (canvas_impl->recording)
+			canvas_impl->recording->add_stroke(canvas->transform(), *this, pen);
+
+		RenderBatchPath *batcher = canvas_impl->batcher.get_path_batcher();
 		batcher->stroke(canvas, *this, pen);
 	}
 
 	void PathImpl::fill(const CanvasPtr &canvas, const Brush &brush)
 	{
-		RenderBatchPath *batcher = static_cast<CanvasImpl*>(canvas.get())->batcher.get_path_batcher();
+		CanvasImpl *canvas_impl = static_cast<CanvasImpl*>(canvas.get());
+		if (canvas_impl->recording)
+			canvas_impl->recording->add_fill(canvas->transform(), *this, brush);
+
+		RenderBatchPath *batcher = canvas_impl->batcher.get_path_batcher();
 		batcher->fill(canvas, *this, brush);
 	}
 
 	void PathImpl::fill_and_stroke(const CanvasPtr &canvas, const Pen &pen, const Brush &brush)
 	{
-		RenderBatchPath *batcher = static_cast<CanvasImpl*>(canvas.get())->batcher.get_path_batcher();
+		CanvasImpl *canvas_impl = static_cast<CanvasImpl*>(canvas.get());
+		if (canvas_impl->recording)
+		{
+			canvas_impl->recording->add_fill(canvas->transform(), *this, brush);
+			canvas_impl->recording->add_stroke(canvas->transform(), *this, pen);
+		}
+
+		RenderBatchPath *batcher = canvas_impl->batcher.get_path_batcher();
 		batcher->fill(canvas, *this, brush);
 		batcher->stroke(canvas, *this, pen);
 	}
@@ -99,6 +99,8 @@ namespace uicore
 
 	void RenderBatchLine::set_batcher_active(const CanvasPtr &canvas, int num_vertices)
 	{
+		static_cast<CanvasImpl*>(canvas.get())->record_unsupported();
+
 		if (position + num_vertices > max_vertices)
 			static_cast<CanvasImpl*>(canvas.get())->batcher.flush();
 
@@ -75,6 +75,8 @@ namespace uicore
 
 	void RenderBatchLineTexture::set_batcher_active(const CanvasPtr &canvas, int num_vertices, const Texture2DPtr &texture)
 	{
+		static_cast<CanvasImpl*>(canvas.get())->record_unsupported();
+
 		if (position + num_vertices > max_vertices)
 			static_cast<CanvasImpl*>(canvas.get())->batcher.flush();
 
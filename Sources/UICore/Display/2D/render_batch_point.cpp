@@ -64,6 +64,8 @@ namespace uicore
 
 	void RenderBatchPoint::set_batcher_active(const CanvasPtr &canvas, int num_vertices)
 	{
+		static_cast<CanvasImpl*>(canvas.get())->record_unsupported();
+
 		if (position + num_vertices > max_vertices)
 			static_cast<CanvasImpl*>(canvas.get())->batcher.flush();
 
@@ -30,6 +30,7 @@
 #include "UICore/precomp.h"
 #include "render_batch_triangle.h"
 #include "canvas_impl.h"
+#include "display_list.h"
 #include "UICore/Display/Render/blend_state_description.h"
 #include "UICore/Display/2D/canvas.h"
 #include "UICore/Core/Math/quad.h"
@@ -48,6 +49,8 @@ namespace uicore
 
 	void RenderBatchTriangle::draw_sprite(const CanvasPtr &canvas, const Pointf texture_position[4], const Pointf dest_position[4], const Texture2DPtr &texture, const Colorf &color)
 	{
+		static_cast<CanvasImpl*>(canvas.get())->record_unsupported();
+
 		int texindex = set_batcher_active(canvas, texture);
 
 		to_sprite_vertex(texture_position[0], dest_position[0], vertices[position++], texindex, color);
@@ -60,6 +63,8 @@ namespace uicore
 
 	void RenderBatchTriangle::fill_triangle(const CanvasPtr &canvas, const Vec2f *triangle_positions, const Vec4f *triangle_colors, int num_vertices)
 	{
+		static_cast<CanvasImpl*>(canvas.get())->record_unsupported();
+
 		int texindex = set_batcher_active(canvas, num_vertices);
 
 
@@ -76,6 +81,8 @@ namespace uicore
 
 	void RenderBatchTriangle::fill_triangle(const CanvasPtr &canvas, const Vec2f *triangle_positions, const Colorf &color, int num_vertices)
 	{
+		static_cast<CanvasImpl*>(canvas.get())->record_unsupported();
+
 		int texindex = set_batcher_active(canvas, num_vertices);
 
 
@@ -92,6 +99,8 @@ namespace uicore
 
 	void RenderBatchTriangle::fill_triangles(const CanvasPtr &canvas, const Vec2f *positions, const Vec2f *texture_positions, int num_vertices, const Texture2DPtr &texture, const Colorf &color)
 	{
+		static_cast<CanvasImpl*>(canvas.get())->record_unsupported();
+
 		int texindex = set_batcher_active(canvas, texture);
 
 		for (; num_vertices > 0; num_vertices--)
@@ -108,6 +117,8 @@ namespace uicore
 
 	void RenderBatchTriangle::fill_triangles(const CanvasPtr &canvas, const Vec2f *positions, const Vec2f *texture_positions, int num_vertices, const Texture2DPtr &texture, const Colorf *colors)
 	{
+		static_cast<CanvasImpl*>(canvas.get())->record_unsupported();
+
 		int texindex = set_batcher_active(canvas, texture);
 
 		for (; num_vertices > 0; num_vertices--)
@@ -131,6 +142,10 @@ namespace uicore
 
 	void RenderBatchTriangle::draw_image(const CanvasPtr &canvas, const Rectf &src, const Rectf &dest, const Colorf &color, const Texture2DPtr &texture)
 	{
+		DisplayList *recording = static_cast<CanvasImpl*>(canvas.get())->recording;
+		if (recording)
+			recording->add_image(canvas->transform(), src, dest, color, texture);
+
 		int texindex = set_batcher_active(canvas, texture);
 
 		vertices[position + 0].position = to_position(dest.left, dest.top);
@@ -159,6 +174,10 @@ namespace uicore
 
 	void RenderBatchTriangle::draw_image(const CanvasPtr &canvas, const Rectf &src, const Quadf &dest, const Colorf &color, const Texture2DPtr &texture)
 	{
+		DisplayList *recording = static_cast<CanvasImpl*>(canvas.get())->recording;
+		if (recording)
+			recording->add_image(canvas->transform(), src, dest, color, texture);
+
 		int texindex = set_batcher_active(canvas, texture);
 
 		vertices[position + 0].position = to_position(dest.p.x, dest.p.y);
@@ -187,6 +206,10 @@ namespace uicore
 
 	void RenderBatchTriangle::draw_glyph_subpixel(const CanvasPtr &canvas, const Rectf &src, const Rectf &dest, const Colorf &color, const Texture2DPtr &texture)
 	{
+		DisplayList *recording = static_cast<CanvasImpl*>(canvas.get())->recording;
+		if (recording)
+			recording->add_glyph_subpixel(canvas->transform(), src, dest, color, texture);
+
 		int texindex = set_batcher_active(canvas, texture, true, color);
 
 		vertices[position + 0].position = to_position(dest.left, dest.top);
@@ -215,6 +238,8 @@ namespace uicore
 
 	void RenderBatchTriangle::fill(const CanvasPtr &canvas, float x1, float y1, float x2, float y2, const Colorf &color)
 	{
+		static_cast<CanvasImpl*>(canvas.get())->record_unsupported();
+
 		int texindex = set_batcher_active(canvas);
 
 		vertices[position + 0].position = to_position(x1, y1);
@@ -90,6 +90,7 @@ namespace uicore
 	{
 		// Try inserting in current active texture
 		Node *node;
+		RootNode *root = active_root;
 		if (!active_root)
 		{
 			// Create an initial root, if it does not exist
@@ -112,7 +113,10 @@ namespace uicore
 				{
 					node = root_nodes[index]->node.insert(texture_size, next_id);
 					if (node)	// We found space in a previous texture
+					{
+						root = root_nodes[index];
 						break;
+					}
 				}
 			}
 
@@ -121,11 +125,13 @@ namespace uicore
 				if (texture_size.width > initial_texture_size.width || texture_size.height > initial_texture_size.height)
 				{
 					// If the specified size is greater than the initial size,  then create a texture using the specified size
-					node = add_new_root(context, texture_size)->node.insert(texture_size, next_id);
+					root = add_new_root(context, texture_size);
+					node = root->node.insert(texture_size, next_id);
 				}
 				else
 				{
-					node = add_new_root(context, initial_texture_size)->node.insert(texture_size, next_id);
+					root = add_new_root(context, initial_texture_size);
+					node = root->node.insert(texture_size, next_id);
 				}
 			}
 
@@ -135,7 +141,7 @@ namespace uicore
 
 		next_id++;
 
-		return TextureGroupImage(active_root->texture, node->image_rect);
+		return TextureGroupImage(root->texture, node->image_rect);
 	}
 
 	TextureGroupImpl::RootNode *TextureGroupImpl::add_new_root(const GraphicContextPtr &context, const Size &texture_size)
@@ -40,6 +40,7 @@
 #include "UICore/Display/2D/path.h"
 #include "UICore/Core/IOData/path_help.h"
 #include "UICore/Core/IOData/file.h"
+#include "UICore/Core/Zip/zip_archive.h"
 #include "UICore/Display/2D/canvas_impl.h"
 
 #ifdef WIN32
@@ -76,6 +77,8 @@ namespace uicore
 
 	FontFamily_Impl::FontFamily_Impl(const std::string &family_name) : _family_name(family_name), texture_group(TextureGroup::create(Size(256, 256)))
 	{
+		// Glyph caches evict glyphs when over budget, so reuse the freed space in every texture
+		texture_group->set_allocation_policy(TextureGroupAllocationPolicy::search_previous_textures);
 	}
 
 	FontFamily_Impl::~FontFamily_Impl()
@@ -96,7 +99,18 @@ namespace uicore
 
 	void FontFamily_Impl::add(const FontDescription &desc, const std::string &ttf_filename)
 	{
-		add(desc, !ttf_filename.empty() ? File::read_all_bytes(ttf_filename) : nullptr);
+		if (ttf_filename.empty())
+		{
+			add(desc, DataBufferPtr());
+			return;
+		}
+
+		ZipArchivePtr archive;
+		std::string archive_name;
+		if (ZipArchive::find_mounted(ttf_filename, archive, archive_name))
+			add(desc, archive->read_all_bytes(archive_name));
+		else
+			add(desc, File::read_all_bytes(ttf_filename));
 	}
 
 	void FontFamily_Impl::add(const FontDescription &desc, const DataBufferPtr &font_databuffer)
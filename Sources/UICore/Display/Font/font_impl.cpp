@@ -72,7 +72,9 @@ namespace uicore
 				font_cache = font_family->copy_font(new_selected, pixel_ratio);
 
 			font_engine = font_cache.engine.get();
-			GlyphCache *glyph_cache = font_cache.glyph_cache.get();
+			glyph_cache = font_cache.glyph_cache.get();
+			if (glyph_cache_budget > 0)
+				glyph_cache->set_budget(glyph_cache_budget);
 			PathCache *path_cache = font_cache.path_cache.get();
 
 			const FontMetrics &metrics = font_engine->get_metrics();
@@ -135,50 +137,28 @@ namespace uicore
 	{
 		select_font_family(canvas);
 
-		float dest_x = 0;
-		float dest_y = 0;
-
-		int character_counter = 0;
-
-		float font_height = selected_metrics.height();
-		float font_ascent = selected_metrics.ascent();
-		float line_spacing = std::round(selected_line_height); // TBD: do we want to round this?
-
-		//TODO: Fix me, so we do not need to line split
-
-		std::vector<std::string> lines = Text::split(text, "\n", false);
-		for (std::vector<std::string>::size_type i = 0; i < lines.size(); i++)
+		std::vector<Rectf> rects;
+		std::vector<int> byte_offsets;
+		TextRun *run = text_runs.get(text, selected_pixel_ratio);
+		if (run)
 		{
-			float xpos = dest_x;
-			float ypos = dest_y;
-
-			std::string &textline = lines[i];
-			std::string::size_type string_length = textline.length();
-
-			// Scan the string
-
-			UTF8_Reader reader(textline.data(), textline.length());
-			while (!reader.is_end())
+			if (!run->indexed)
 			{
-				unsigned int glyph = reader.character();
-				std::string::size_type glyph_pos = reader.position();
-				reader.next();
-
-				GlyphMetrics metrics = font_draw->get_metrics(canvas, glyph);
-
-				Rectf position(xpos, ypos - font_ascent, Sizef(metrics.advance.width, metrics.advance.height + font_height));
-				if (position.contains(point))
-				{
-					return glyph_pos + character_counter;
-				}
-
-				xpos += metrics.advance.width;
-				ypos += metrics.advance.height;
+				index_run(canvas, text, run->character_rects, run->byte_offsets);
+				run->indexed = true;
 			}
+		}
+		else
+		{
+			index_run(canvas, text, rects, byte_offsets);
+		}
 
-			dest_y += line_spacing;
-
-			character_counter += string_length + 1;		// (Including the '\n')
+		const std::vector<Rectf> &character_rects = run ? run->character_rects : rects;
+		const std::vector<int> &character_offsets = run ? run->byte_offsets : byte_offsets;
+		for (size_t i = 0; i < character_rects.size(); i++)
+		{
+			if (text[character_offsets[i]] != '\n' && character_rects[i].contains(point))
+				return character_offsets[i];
 		}
 		return -1;	// Not found
 	}
@@ -186,11 +166,31 @@ namespace uicore
 	std::vector<Rectf> Font_Impl::character_indices(const CanvasPtr &canvas, const std::string &text)
 	{
 		select_font_family(canvas);
-		std::vector<Rectf> index_store;
 
+		TextRun *run = text_runs.get(text, selected_pixel_ratio);
+		if (!run)
+		{
+			std::vector<Rectf> index_store;
+			std::vector<int> byte_offsets;
+			index_run(canvas, text, index_store, byte_offsets);
+			return index_store;
+		}
+
+		if (!run->indexed)
+		{
+			index_run(canvas, text, run->character_rects, run->byte_offsets);
+			run->indexed = true;
+		}
+		return run->character_rects;
+	}
+
+	void Font_Impl::index_run(const CanvasPtr &canvas, const std::string &text, std::vector<Rectf> &index_store, std::vector<int> &byte_offsets)
+	{
 		float dest_x = 0;
 		float dest_y = 0;
 
+		int character_counter = 0;
+
 		float font_height = selected_metrics.height();
 		float font_ascent = selected_metrics.ascent();
 		float line_spacing = std::round(selected_line_height); // TBD: do we want to round this?
@@ -204,6 +204,7 @@ namespace uicore
 			float ypos = dest_y;
 
 			std::string &textline = lines[i];
+			std::string::size_type string_length = textline.length();
 
 			// Scan the string
 
@@ -211,12 +212,14 @@ namespace uicore
 			while (!reader.is_end())
 			{
 				unsigned int glyph = reader.character();
+				std::string::size_type glyph_pos = reader.position();
 				reader.next();
 
 				GlyphMetrics metrics = font_draw->get_metrics(canvas, glyph);
 
 				Rectf position(xpos, ypos - font_ascent, Sizef(metrics.advance.width, metrics.advance.height + font_height));
 				index_store.push_back(position);
+				byte_offsets.push_back(glyph_pos + character_counter);
 				xpos += metrics.advance.width;
 				ypos += metrics.advance.height;
 			}
@@ -224,9 +227,13 @@ namespace uicore
 			dest_y += line_spacing;
 
 			if (i != lines.size() - 1)
+			{
 				index_store.push_back(Rect());	// Store the '\n' as a empty rect
+				byte_offsets.push_back(character_counter + string_length);
+			}
+
+			character_counter += string_length + 1;		// (Including the '\n')
 		}
-		return index_store;
 	}
 
 	const FontMetrics &Font_Impl::font_metrics(const CanvasPtr &canvas)
@@ -249,6 +256,22 @@ namespace uicore
 		return nullptr;
 	}
 
+	GlyphCacheStats Font_Impl::glyph_cache_stats() const
+	{
+		if (glyph_cache)
+			return glyph_cache->stats();
+		return GlyphCacheStats();
+	}
+
+	void Font_Impl::set_glyph_cache_budget(int atlas_pixels)
+	{
+		if (atlas_pixels <= 0)
+			throw Exception("Glyph cache budget must be positive");
+		glyph_cache_budget = atlas_pixels;
+		if (glyph_cache)
+			glyph_cache->set_budget(atlas_pixels);
+	}
+
 	void Font_Impl::draw_text(const CanvasPtr &canvas, const Pointf &position, const std::string &text, const Colorf &color)
 	{
 		select_font_family(canvas);
@@ -272,6 +295,21 @@ namespace uicore
 	GlyphMetrics Font_Impl::measure_text(const CanvasPtr &canvas, const std::string &string)
 	{
 		select_font_family(canvas);
+
+		TextRun *run = text_runs.get(string, selected_pixel_ratio);
+		if (!run)
+			return measure_run(canvas, string);
+
+		if (!run->measured)
+		{
+			run->metrics = measure_run(canvas, string);
+			run->measured = true;
+		}
+		return run->metrics;
+	}
+
+	GlyphMetrics Font_Impl::measure_run(const CanvasPtr &canvas, const std::string &string)
+	{
 		GlyphMetrics total_metrics;
 
 		float line_spacing = std::round(selected_line_height); // TBD: do we want to round this?
@@ -326,6 +364,7 @@ namespace uicore
 		{
 			selected_description.set_height(value);
 			font_engine = nullptr;
+			text_runs.clear();
 		}
 	}
 
@@ -335,12 +374,17 @@ namespace uicore
 		{
 			selected_description.set_weight(value);
 			font_engine = nullptr;
+			text_runs.clear();
 		}
 	}
 
 	void Font_Impl::set_line_height(float height)
 	{
-		selected_line_height = height;
+		if (selected_line_height != height)
+		{
+			selected_line_height = height;
+			text_runs.clear();
+		}
 		// (Don't need to reset the font engine)
 	}
 
@@ -350,12 +394,14 @@ namespace uicore
 		{
 			selected_description.set_style(setting);
 			font_engine = nullptr;
+			text_runs.clear();
 		}
 	}
 
 	void Font_Impl::set_scalable(float height_threshold)
 	{
 		selected_height_threshold = height_threshold;
+		text_runs.clear();	// The threshold is applied when the font is selected again, such as for another pixel ratio
 		// (Don't need to reset the font engine)
 	}
 }
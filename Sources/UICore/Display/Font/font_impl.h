@@ -39,6 +39,7 @@
 #include <map>
 #include "glyph_cache.h"
 #include "path_cache.h"
+#include "text_run_cache.h"
 #include "font_family_impl.h"
 
 #include "FontDraw/font_draw_subpixel.h"
@@ -70,11 +71,15 @@ namespace uicore
 		int character_index(const CanvasPtr &canvas, const std::string &text, const Pointf &point) override;
 		std::vector<Rectf> character_indices(const CanvasPtr &canvas, const std::string &text) override;
 		FontHandle *handle(const CanvasPtr &canvas) override;
+		GlyphCacheStats glyph_cache_stats() const override;
+		void set_glyph_cache_budget(int atlas_pixels) override;
 
 		void glyph_path(const CanvasPtr &canvas, unsigned int glyph_index, const PathPtr &out_path, GlyphMetrics &out_metrics);
 
 	private:
 		void select_font_family(const CanvasPtr &canvas);
+		GlyphMetrics measure_run(const CanvasPtr &canvas, const std::string &string);
+		void index_run(const CanvasPtr &canvas, const std::string &text, std::vector<Rectf> &out_rects, std::vector<int> &out_byte_offsets);
 
 		FontDescription selected_description;
 		float selected_line_height = 0.0f;
@@ -86,10 +91,14 @@ namespace uicore
 		FontMetrics selected_metrics;
 
 		FontEngine *font_engine = nullptr;	// If null, use select_font_family() to update
+		GlyphCache *glyph_cache = nullptr;
+		int glyph_cache_budget = 0;	// 0 = leave the cache budget unchanged
 		std::shared_ptr<FontFamily_Impl> font_family;
 
 		Font_Draw *font_draw = nullptr;
 
+		TextRunCache text_runs;	// Cleared when anything but the pixel ratio affecting the measurements changes
+
 		Font_DrawSubPixel font_draw_subpixel;
 		Font_DrawFlat font_draw_flat;
 		Font_DrawScaled font_draw_scaled;
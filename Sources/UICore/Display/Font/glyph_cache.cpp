@@ -42,12 +42,16 @@
 #include "UICore/Core/Text/text.h"
 #include "UICore/Core/Text/utf8_reader.h"
 #include "UICore/Display/2D/render_batch_triangle.h"
+#include "UICore/Display/2D/canvas_impl.h"
+#include "UICore/Display/2D/display_list.h"
+#include <algorithm>
 
 namespace uicore
 {
 	GlyphCache::GlyphCache()
 	{
 		glyph_list.reserve(256);
+		hash_table.resize(512, -1);
 	}
 
 	GlyphCache::~GlyphCache()
@@ -56,34 +60,120 @@ namespace uicore
 
 	Font_TextureGlyph *GlyphCache::get_glyph(const CanvasPtr &canvas, FontEngine *font_engine, unsigned int glyph)
 	{
-		auto size = glyph_list.size();
-		for (int cnt = 0; cnt < size; cnt++)
+		Font_TextureGlyph *font_glyph = find_glyph(glyph);
+		if (font_glyph)
 		{
-			if (glyph_list[cnt]->glyph == glyph)
-				return &(*glyph_list[cnt]);
+			cache_stats.hits++;
+			font_glyph->last_used = ++use_counter;
+			return font_glyph;
 		}
 
+		cache_stats.misses++;
+
 		// If glyph does not exist, create one automatically
 		FontPixelBuffer pb = font_engine->get_font_glyph(glyph);
-		if (pb.glyph)	// Ignore invalid glyphs
-			insert_glyph(canvas, pb);
+		if (!pb.glyph)	// Ignore invalid glyphs
+			return nullptr;
+
+		insert_glyph(canvas, pb);
 
-		// Search for the glyph again
-		size = glyph_list.size();
-		for (int cnt = 0; cnt < size; cnt++)
+		font_glyph = glyph_list.back().get();
+		font_glyph->last_used = ++use_counter;
+		return font_glyph->glyph == glyph ? font_glyph : nullptr;
+	}
+
+	Font_TextureGlyph *GlyphCache::find_glyph(unsigned int glyph)
+	{
+		size_t mask = hash_table.size() - 1;
+		for (size_t slot = hash_slot(glyph, mask); hash_table[slot] != -1; slot = (slot + 1) & mask)
 		{
-			if (glyph_list[cnt]->glyph == glyph)
-				return &(*glyph_list[cnt]);
+			Font_TextureGlyph *font_glyph = glyph_list[hash_table[slot]].get();
+			if (font_glyph->glyph == glyph)
+				return font_glyph;
 		}
-
 		return nullptr;
 	}
 
+	void GlyphCache::add_to_list(std::unique_ptr<Font_TextureGlyph> font_glyph)
+	{
+		// Keep the load factor at or below 50% so probe sequences stay short
+		if ((glyph_list.size() + 1) * 2 > hash_table.size())
+			rebuild_hash_table(hash_table.size() * 2);
+
+		size_t mask = hash_table.size() - 1;
+		size_t slot = hash_slot(font_glyph->glyph, mask);
+		while (hash_table[slot] != -1)
+			slot = (slot + 1) & mask;
+		hash_table[slot] = (int)glyph_list.size();
+
+		if (font_glyph->sub_texture.texture())
+			cache_stats.atlas_pixels += font_glyph->sub_texture.geometry().width() * font_glyph->sub_texture.geometry().height();
+
+		glyph_list.push_back(std::move(font_glyph));
+		cache_stats.glyph_count = (int)glyph_list.size();
+	}
+
+	void GlyphCache::rebuild_hash_table(size_t slot_count)
+	{
+		hash_table.assign(slot_count, -1);
+		size_t mask = slot_count - 1;
+		for (size_t index = 0; index < glyph_list.size(); index++)
+		{
+			size_t slot = hash_slot(glyph_list[index]->glyph, mask);
+			while (hash_table[slot] != -1)
+				slot = (slot + 1) & mask;
+			hash_table[slot] = (int)index;
+		}
+	}
+
+	void GlyphCache::evict(const CanvasPtr &canvas, int needed_pixels)
+	{
+		// Evict down to three quarters of the budget, so that the cost of sorting and rebuilding the hash table is spread over many inserts
+		int target_pixels = std::max(atlas_budget - atlas_budget / 4 - needed_pixels, 0);
+		if (cache_stats.atlas_pixels <= target_pixels)
+			return;
+
+		// Glyphs already queued in the batcher must be drawn before their texture space is reused
+		static_cast<CanvasImpl*>(canvas.get())->batcher.flush();
+
+		std::vector<int> lru_order(glyph_list.size());
+		for (size_t index = 0; index < lru_order.size(); index++)
+			lru_order[index] = (int)index;
+		std::sort(lru_order.begin(), lru_order.end(), [&](int a, int b) { return glyph_list[a]->last_used < glyph_list[b]->last_used; });
+
+		for (int index : lru_order)
+		{
+			if (cache_stats.atlas_pixels <= target_pixels)
+				break;
+
+			std::unique_ptr<Font_TextureGlyph> &font_glyph = glyph_list[index];
+			if (font_glyph->sub_texture.texture())
+			{
+				cache_stats.atlas_pixels -= font_glyph->sub_texture.geometry().width() * font_glyph->sub_texture.geometry().height();
+				texture_group->remove(font_glyph->sub_texture);
+			}
+			font_glyph.reset();
+			cache_stats.evictions++;
+		}
+
+		glyph_list.erase(std::remove(glyph_list.begin(), glyph_list.end(), nullptr), glyph_list.end());
+		cache_stats.glyph_count = (int)glyph_list.size();
+		rebuild_hash_table(hash_table.size());
+
+		// Retained display lists may still refer to the texture space of the evicted glyphs
+		DisplayList::invalidate_all();
+	}
+
 	void GlyphCache::set_texture_group(const TextureGroupPtr &new_texture_group)
 	{
 		texture_group = new_texture_group;
 	}
 
+	void GlyphCache::set_budget(int atlas_pixels)
+	{
+		atlas_budget = atlas_pixels;
+	}
+
 	GlyphMetrics GlyphCache::get_metrics(FontEngine *font_engine, const CanvasPtr &canvas, unsigned int glyph)
 	{
 		Font_TextureGlyph *gptr = get_glyph(canvas, font_engine, glyph);
@@ -105,15 +195,22 @@ namespace uicore
 		if (!pb.empty_buffer)
 		{
 			PixelBufferPtr buffer_with_border = PixelBuffer::add_border(pb.buffer, glyph_border_size, pb.buffer_rect);
+			Size buffer_size = buffer_with_border->size();
+
+			int needed_pixels = buffer_size.width * buffer_size.height;
+			if (cache_stats.atlas_pixels + needed_pixels > atlas_budget)
+				evict(canvas, needed_pixels);
+
 			GraphicContextPtr gc = canvas->gc();
-			TextureGroupImage sub_texture = texture_group->add(gc, buffer_with_border->size());
+			TextureGroupImage sub_texture = texture_group->add(gc, buffer_size);
 			font_glyph->texture = sub_texture.texture();
 			font_glyph->geometry = Rect(sub_texture.geometry().left + glyph_border_size, sub_texture.geometry().top + glyph_border_size, pb.buffer_rect.size());
 			font_glyph->size = pb.size;
-			sub_texture.texture()->set_subimage(gc, sub_texture.geometry().left, sub_texture.geometry().top, buffer_with_border, buffer_with_border->size());
+			font_glyph->sub_texture = sub_texture;
+			sub_texture.texture()->set_subimage(gc, sub_texture.geometry().left, sub_texture.geometry().top, buffer_with_border, buffer_size);
 		}
 
-		glyph_list.push_back(std::move(font_glyph));
+		add_to_list(std::move(font_glyph));
 	}
 
 	void GlyphCache::insert_glyph(const CanvasPtr &canvas, unsigned int glyph, TextureGroupImage &sub_texture, const Pointf &offset, const Sizef &size, const GlyphMetrics &glyph_metrics)
@@ -131,6 +228,6 @@ namespace uicore
 			font_glyph->geometry = sub_texture.geometry();
 		}
 
-		glyph_list.push_back(std::move(font_glyph));
+		add_to_list(std::move(font_glyph));
 	}
 }
@@ -75,6 +75,12 @@ namespace uicore
 		Sizef size;
 
 		GlyphMetrics metrics;
+
+		/// \brief Space allocated in the texture group, including the border. Empty if the cache does not own the space.
+		TextureGroupImage sub_texture;
+
+		/// \brief Use counter value when the glyph was last looked up
+		uint64_t last_used = 0;
 	};
 
 	class GlyphCache
@@ -84,6 +90,8 @@ namespace uicore
 		virtual ~GlyphCache();
 
 		/// \brief Get a glyph. Returns NULL if the glyph was not found
+		///
+		/// The returned pointer is only valid until the next call, as inserting a glyph may evict others.
 		Font_TextureGlyph *get_glyph(const CanvasPtr &canvas, FontEngine *font_engine, unsigned int glyph);
 
 		GlyphMetrics get_metrics(FontEngine *font_engine, const CanvasPtr &canvas, unsigned int glyph);
@@ -93,10 +101,29 @@ namespace uicore
 
 		void set_texture_group(const TextureGroupPtr &new_texture_group);
 
+		/// \brief Sets the maximum texture area, in pixels, the cached glyphs may occupy before the least recently used are evicted
+		void set_budget(int atlas_pixels);
+		int budget() const { return atlas_budget; }
+
+		const GlyphCacheStats &stats() const { return cache_stats; }
+
 	private:
+		Font_TextureGlyph *find_glyph(unsigned int glyph);
+		void add_to_list(std::unique_ptr<Font_TextureGlyph> font_glyph);
+		void evict(const CanvasPtr &canvas, int needed_pixels);
+		void rebuild_hash_table(size_t slot_count);
+		static unsigned int hash_slot(unsigned int glyph, size_t mask) { return (glyph * 2654435761u) & mask; }
+
 		std::vector<std::unique_ptr<Font_TextureGlyph>> glyph_list;
+		std::vector<int> hash_table;	// Open addressing with linear probing. Index into glyph_list, or -1 for an empty slot
 		TextureGroupPtr texture_group;
 
+		uint64_t use_counter = 0;
+		int atlas_budget = default_budget;
+		GlyphCacheStats cache_stats;
+
+		static const int default_budget = 1024 * 1024;
+
 		static const int glyph_border_size = 1;
 	};
 }
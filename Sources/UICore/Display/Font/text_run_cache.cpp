@@ -0,0 +1,64 @@
+/*
+**  UICore
+**  Copyright (c) 1997-2015 The UICore Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries UICore may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+#include "UICore/precomp.h"
+#include "text_run_cache.h"
+
+namespace uicore
+{
+	TextRun *TextRunCache::get(const std::string &text, float pixel_ratio)
+	{
+		if (text.length() > max_text_length)
+			return nullptr;
+
+		Key key = { text, pixel_ratio };
+		auto it = runs.find(key);
+		if (it != runs.end())
+		{
+			lru_order.splice(lru_order.begin(), lru_order, it->second.lru_position);
+			return &it->second.run;
+		}
+
+		if (runs.size() >= max_runs)
+		{
+			runs.erase(runs.find(*lru_order.back()));
+			lru_order.pop_back();
+		}
+
+		it = runs.insert(std::make_pair(std::move(key), Entry())).first;
+		lru_order.push_front(&it->first);
+		it->second.lru_position = lru_order.begin();
+		return &it->second.run;
+	}
+
+	void TextRunCache::clear()
+	{
+		runs.clear();
+		lru_order.clear();
+	}
+}
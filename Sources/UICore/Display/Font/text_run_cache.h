@@ -0,0 +1,99 @@
+/*
+**  UICore
+**  Copyright (c) 1997-2015 The UICore Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries UICore may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+#pragma once
+
+#include "UICore/Display/Font/glyph_metrics.h"
+#include "UICore/Core/Math/rect.h"
+#include <list>
+#include <unordered_map>
+
+namespace uicore
+{
+	/// \brief Measurements of a string of text, filled in as they are requested
+	class TextRun
+	{
+	public:
+		/// \brief True if metrics has been set
+		bool measured = false;
+
+		/// \brief Result of Font::measure_text
+		GlyphMetrics metrics;
+
+		/// \brief True if character_rects and byte_offsets have been set
+		bool indexed = false;
+
+		/// \brief Result of Font::character_indices
+		std::vector<Rectf> character_rects;
+
+		/// \brief Position in the text of the character for each rectangle
+		std::vector<int> byte_offsets;
+	};
+
+	/// \brief Least recently used cache of measured text runs
+	class TextRunCache
+	{
+	public:
+		/// \brief Returns the cached run for the text, or a new empty run. Returns nullptr if the text is too long to be cached
+		///
+		/// The returned pointer is only valid until the next call, as adding a run may evict others.
+		TextRun *get(const std::string &text, float pixel_ratio);
+
+		/// \brief Removes all runs
+		void clear();
+
+	private:
+		class Key
+		{
+		public:
+			std::string text;
+			float pixel_ratio;
+
+			bool operator==(const Key &other) const { return pixel_ratio == other.pixel_ratio && text == other.text; }
+		};
+
+		class KeyHash
+		{
+		public:
+			size_t operator()(const Key &key) const { return std::hash<std::string>()(key.text) ^ std::hash<float>()(key.pixel_ratio); }
+		};
+
+		class Entry
+		{
+		public:
+			TextRun run;
+			std::list<const Key *>::iterator lru_position;
+		};
+
+		std::unordered_map<Key, Entry, KeyHash> runs;
+		std::list<const Key *> lru_order;	// Most recently used first
+
+		static const size_t max_runs = 256;
+		static const size_t max_text_length = 1024;
+	};
+}
@@ -29,7 +29,10 @@
 #include "UICore/precomp.h"
 #include "png_loader.h"
 #include "UICore/Core/Zip/zlib_compression.h"
+#include "UICore/Core/Zip/inflate_reader.h"
+#include "UICore/Core/IOData/memory_device.h"
 #include "UICore/Core/System/system.h"
+#include "UICore/Core/IOData/mapped_file.h"
 #include "UICore/Display/ImageFormats/PNGWriter/png_writer.h"
 
 namespace uicore
@@ -75,6 +78,9 @@ namespace uicore
 
 		std::map<std::string, DataBufferPtr> chunks;
 
+		// Chunks of memory mapped files are referenced instead of copied
+		auto mapped_file = dynamic_cast<MappedFile*>(file.get());
+
 		std::vector<DataBufferPtr> idat_chunks;
 		uint64_t total_idat_size = 0;
 
@@ -85,8 +91,17 @@ namespace uicore
 			name[4] = 0;
 			file->read(name, 4);
 
-			auto data = DataBuffer::create(length);
-			file->read(data->data(), data->size());
+			DataBufferPtr data;
+			if (mapped_file)
+			{
+				data = mapped_file->view(mapped_file->position(), length);
+				mapped_file->seek_from_current(length);
+			}
+			else
+			{
+				data = DataBuffer::create(length);
+				file->read(data->data(), data->size());
+			}
 
 			unsigned int crc32 = file->read_uint32();
 
@@ -110,12 +125,19 @@ namespace uicore
 		if (total_idat_size >= (1 << 31))
 			throw Exception("PNG image file too big!");
 
-		idat = DataBuffer::create((int)total_idat_size);
-		int idat_pos = 0;
-		for (auto & idat_chunk : idat_chunks)
+		if (idat_chunks.size() == 1)
 		{
-			memcpy(idat->data() + idat_pos, idat_chunk->data(), idat_chunk->size());
-			idat_pos += idat_chunk->size();
+			idat = idat_chunks.front();
+		}
+		else
+		{
+			idat = DataBuffer::create((int)total_idat_size);
+			int idat_pos = 0;
+			for (auto & idat_chunk : idat_chunks)
+			{
+				memcpy(idat->data() + idat_pos, idat_chunk->data(), idat_chunk->size());
+				idat_pos += idat_chunk->size();
+			}
 		}
 
 		ihdr = chunks["IHDR"];
@@ -218,7 +240,19 @@ namespace uicore
 
 	void PNGLoader::decode_image()
 	{
-		DataBufferPtr image_data = ZLibCompression::decompress(idat, false);
+		DataBufferPtr image_data;
+		if (interlace_method == 0)
+		{
+			// The decompressed size is known, so inflate straight into a buffer of that size
+			size_t scanline_size = (image_width * bit_depth * get_image_data_channels() + 7) / 8;
+			image_data = DataBuffer::create((1 + scanline_size) * image_height);
+			auto reader = InflateReader::create(MemoryDevice::open(idat), false);
+			image_data->set_size((size_t)reader->try_read_64(image_data->data(), image_data->size()));
+		}
+		else
+		{
+			image_data = ZLibCompression::decompress(idat, false);
+		}
 
 		create_image();
 		create_scanline_buffers();
@@ -28,7 +28,10 @@
 
 #include "UICore/precomp.h"
 #include "png_writer.h"
+#include "UICore/Core/Zip/deflate_writer.h"
 #include "UICore/Core/Zip/zlib_compression.h"
+#include "UICore/Core/System/system.h"
+#include "UICore/Core/IOData/memory_device.h"
 
 namespace uicore
 {
@@ -119,49 +122,72 @@ namespace uicore
 		int bytes_per_pixel = image->bytes_per_pixel();
 		
 		std::vector<unsigned char> scanline_orig;
-		std::vector<unsigned char> scanline_filtered;
 		scanline_orig.resize((image->width() + 1) * bytes_per_pixel);
-		scanline_filtered.resize(image->width() * bytes_per_pixel + 1);
+		size_t filtered_size = image->width() * bytes_per_pixel + 1;
+		
+		// Large images are compressed on all cores. This needs the entire filtered image in memory, so smaller ones are streamed.
+		if (System::num_cores() > 1 && filtered_size * height >= 4 * 1024 * 1024)
+		{
+			auto filtered = DataBuffer::create(filtered_size * height);
+			for (int y = 0; y < height; y++)
+				filter_scanline(y, scanline_orig, reinterpret_cast<unsigned char *>(filtered->data()) + y * filtered_size);
+			
+			auto idat = ZLibCompression::compress_parallel(filtered, false);
+			write_chunk("IDAT", idat->data(), idat->size());
+			return;
+		}
+		
+		std::vector<unsigned char> scanline_filtered;
+		scanline_filtered.resize(filtered_size);
 		
-		auto idat_uncompressed = DataBuffer::create(height * scanline_filtered.size());
+		// Scanlines are compressed as they are produced
+		auto idat = MemoryDevice::create();
+		auto idat_writer = DeflateWriter::create(idat, false);
 		
 		for (int y = 0; y < height; y++)
 		{
-			// Grab scanline
-			memcpy(scanline_orig.data() + bytes_per_pixel, image->line(y), scanline_orig.size() - bytes_per_pixel);
-
-			// Convert to big endian for 16 bit
-			if (bytes_per_pixel == 8)
-			{
-				for (size_t x = 0; x < scanline_orig.size(); x+=2)
-				{
-					std::swap(scanline_orig[x], scanline_orig[x + 1]);
-				}
-			}
-
-			// Filter scanline
-			/*
-			scanline_filtered[0] = 0; // None filter type
-			for (int i = bytes_per_pixel; i < scanline_orig.size(); i++)
-			{
-				scanline_filtered[i - bytes_per_pixel + 1] = scanline_orig[i];
-			}
-			*/
-			scanline_filtered[0] = 1; // Sub filter type
-			for (int i = bytes_per_pixel; i < scanline_orig.size(); i++)
-			{
-				unsigned char a = scanline_orig[i - bytes_per_pixel];
-				unsigned char x = scanline_orig[i];
-				scanline_filtered[i - bytes_per_pixel + 1] = x - a;
-			}
+			filter_scanline(y, scanline_orig, scanline_filtered.data());
 			
 			// Output scanline
-			memcpy(idat_uncompressed->data<unsigned char>() + y * scanline_filtered.size(), scanline_filtered.data(), scanline_filtered.size());
+			idat_writer->write(scanline_filtered.data(), scanline_filtered.size());
 		}
 		
-		DataBufferPtr idat = ZLibCompression::compress(idat_uncompressed, false);
+		idat_writer->finish();
 		
-		write_chunk("IDAT", idat->data(), idat->size());
+		write_chunk("IDAT", idat->buffer()->data(), idat->buffer()->size());
+	}
+	
+	void PNGWriter::filter_scanline(int y, std::vector<unsigned char> &scanline_orig, unsigned char *scanline_filtered)
+	{
+		int bytes_per_pixel = image->bytes_per_pixel();
+		
+		// Grab scanline
+		memcpy(scanline_orig.data() + bytes_per_pixel, image->line(y), scanline_orig.size() - bytes_per_pixel);
+
+		// Convert to big endian for 16 bit
+		if (bytes_per_pixel == 8)
+		{
+			for (size_t x = 0; x < scanline_orig.size(); x+=2)
+			{
+				std::swap(scanline_orig[x], scanline_orig[x + 1]);
+			}
+		}
+
+		// Filter scanline
+		/*
+		scanline_filtered[0] = 0; // None filter type
+		for (int i = bytes_per_pixel; i < scanline_orig.size(); i++)
+		{
+			scanline_filtered[i - bytes_per_pixel + 1] = scanline_orig[i];
+		}
+		*/
+		scanline_filtered[0] = 1; // Sub filter type
+		for (int i = bytes_per_pixel; i < scanline_orig.size(); i++)
+		{
+			unsigned char a = scanline_orig[i - bytes_per_pixel];
+			unsigned char x = scanline_orig[i];
+			scanline_filtered[i - bytes_per_pixel + 1] = x - a;
+		}
 	}
 	
 	void PNGWriter::write_chunk(const char name[4], const void *data, int size)
@@ -46,6 +46,7 @@ namespace uicore
 		void write_magic();
 		void write_headers();
 		void write_data();
+		void filter_scanline(int y, std::vector<unsigned char> &scanline_orig, unsigned char *scanline_filtered);
 		
 		void write_chunk(const char name[4], const void *data, int size);
 		
@@ -29,6 +29,7 @@
 #include "UICore/precomp.h"
 #include <iostream>
 #include "UICore/Core/IOData/file.h"
+#include "UICore/Core/IOData/mapped_file.h"
 #include "UICore/Core/IOData/path_help.h"
 #include "UICore/Display/ImageFormats/dds_format.h"
 #include "UICore/Display/Image/pixel_buffer.h"
@@ -39,7 +40,7 @@ namespace uicore
 {
 	PixelBufferSetPtr DDSFormat::load(const std::string &filename)
 	{
-		auto file = File::open_existing(filename);
+		auto file = MappedFile::open(filename, MappedFileUsage::sequential);
 		return load(file);
 	}
 
@@ -29,6 +29,7 @@
 #include "UICore/precomp.h"
 #include "UICore/Core/IOData/path_help.h"
 #include "UICore/Core/IOData/file.h"
+#include "UICore/Core/Zip/zip_archive.h"
 #include "UICore/Display/ImageFormats/image_file.h"
 #include "UICore/Display/ImageFormats/image_file_type.h"
 #include "UICore/Display/Image/pixel_buffer.h"
@@ -57,6 +58,12 @@ namespace uicore
 	PixelBufferPtr ImageFile::load(const std::string &filename, const std::string &type, bool srgb)
 	{
 		SetupDisplay::start();
+
+		ZipArchivePtr archive;
+		std::string archive_name;
+		if (ZipArchive::find_mounted(filename, archive, archive_name))
+			return load(archive->open_file(archive_name), type.empty() ? Text::to_lower(FilePath::extension(filename)) : type, srgb);
+
 		auto &types = *SetupDisplay::get_image_provider_factory_types();
 		if (type != "")
 		{
@@ -30,6 +30,7 @@
 #include "UICore/precomp.h"
 #include <iostream>
 #include "UICore/Core/IOData/file.h"
+#include "UICore/Core/IOData/mapped_file.h"
 #include "UICore/Core/IOData/path_help.h"
 #include "UICore/Display/ImageFormats/jpeg_format.h"
 #include "UICore/Core/System/databuffer.h"
@@ -42,7 +43,7 @@ namespace uicore
 {
 	PixelBufferPtr JPEGFormat::load(const std::string &filename, bool srgb)
 	{
-		auto file = File::open_existing(filename);
+		auto file = MappedFile::open(filename, MappedFileUsage::sequential);
 		return JPEGLoader::load(file, srgb);
 	}
 
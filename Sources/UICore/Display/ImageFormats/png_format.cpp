@@ -30,6 +30,8 @@
 #include "UICore/precomp.h"
 #include "UICore/Core/System/exception.h"
 #include "UICore/Core/IOData/file.h"
+#include "UICore/Core/IOData/buffered_iodevice.h"
+#include "UICore/Core/IOData/mapped_file.h"
 #include "UICore/Core/IOData/path_help.h"
 #include "UICore/Core/Text/text.h"
 #include "UICore/Display/Image/pixel_buffer.h"
@@ -43,7 +45,7 @@ namespace uicore
 {
 	PixelBufferPtr PNGFormat::load(const std::string &filename, bool srgb)
 	{
-		auto file = File::open_existing(filename);
+		auto file = MappedFile::open(filename, MappedFileUsage::sequential);
 		return PNGLoader::load(file, srgb);
 	}
 
@@ -54,8 +56,9 @@ namespace uicore
 
 	void PNGFormat::save(PixelBufferPtr buffer, const std::string &filename)
 	{
-		auto file = File::create_always(filename);
+		auto file = BufferedIODevice::create(File::create_always(filename), 0);
 		save(buffer, file);
+		file->flush();
 	}
 
 	void PNGFormat::save(PixelBufferPtr buffer, const IODevicePtr &iodev)
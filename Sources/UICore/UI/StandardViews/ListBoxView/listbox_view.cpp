@@ -29,6 +29,7 @@
 
 #include "UICore/precomp.h"
 #include "UICore/UI/StandardViews/listbox_view.h"
+#include "UICore/UI/StandardViews/scrollbar_view.h"
 #include "UICore/UI/StandardViews/label_view.h"
 #include "UICore/UI/Events/key_event.h"
 #include "UICore/UI/Events/pointer_event.h"
@@ -39,6 +40,7 @@ namespace uicore
 	ListBoxBaseView::ListBoxBaseView() : impl(new ListBoxBaseViewImpl())
 	{
 		impl->listbox = this;
+		impl->column_view = content_view();
 		content_view()->style()->set("flex-direction: column");
 		
 		set_focus_policy(FocusPolicy::accept);
@@ -46,6 +48,11 @@ namespace uicore
 		slots.connect(sig_key_press(), [this](KeyEvent *e) { impl->on_key_press(*e); });
 		slots.connect(sig_pointer_press(), [this](PointerEvent *e) { impl->on_pointer_press(*e); });
 		slots.connect(sig_pointer_release(), [this](PointerEvent *e) { impl->on_pointer_release(*e); });
+		slots.connect(sig_pointer_move(), [this](PointerEvent *e) { impl->on_pointer_move(*e); });
+		slots.connect(sig_pointer_leave(), [this](PointerEvent *e) { if (impl->rows_view) impl->on_pointer_leave(*e); });
+
+		// Scrolling changes which rows are in view
+		slots.connect(scrollbar_y_view()->sig_scroll(), [this]() { if (impl->rows_view) set_needs_layout(); });
 	}
 
 	ListBoxBaseView::~ListBoxBaseView()
@@ -55,10 +62,21 @@ namespace uicore
 	void ListBoxBaseView::set_items(const std::vector<std::shared_ptr<View>> &items)
 	{
 		impl->selected_item = -1;
+		impl->hot_item = -1;
+
+		if (impl->rows_view)
+		{
+			impl->clear_rows();
+			impl->rows_view.reset();
+			impl->row_factory = nullptr;
+			impl->source_item_count = 0;
+			set_content_view(impl->column_view);
+		}
 		
 		for (auto view = content_view()->last_child(); view != nullptr; view = content_view()->last_child())
 			view->remove_from_parent();
 		
+		impl->items = items;
 		for (auto &item : items)
 		{
 			content_view()->add_child(item);
@@ -66,6 +84,46 @@ namespace uicore
 			slots.connect(item->sig_pointer_leave(), [this](PointerEvent *e) { impl->on_pointer_leave(*e); });
 		}
 	}
+
+	void ListBoxBaseView::set_item_source(int item_count, const std::function<std::shared_ptr<View>(int index, const std::shared_ptr<View> &recycled_view)> &row_factory, float row_height)
+	{
+		if (item_count < 0)
+			throw Exception("Listbox item count can not be negative");
+
+		impl->selected_item = -1;
+		impl->hot_item = -1;
+
+		for (auto view = impl->column_view->last_child(); view != nullptr; view = impl->column_view->last_child())
+			view->remove_from_parent();
+		impl->items.clear();
+
+		impl->clear_rows();
+		if (!impl->rows_view)
+		{
+			impl->rows_view = std::make_shared<ListBoxRowsView>(impl.get());
+			set_content_view(impl->rows_view);
+		}
+
+		impl->row_factory = row_factory;
+		impl->source_item_count = item_count;
+		impl->fixed_row_height = row_height;
+		impl->row_height = row_height;
+		impl->rows_view->set_needs_layout();
+	}
+
+	void ListBoxBaseView::update_item_source()
+	{
+		if (impl->rows_view)
+		{
+			impl->clear_rows();
+			impl->rows_view->set_needs_layout();
+		}
+	}
+
+	int ListBoxBaseView::item_count() const
+	{
+		return impl->item_count();
+	}
 	
 	int ListBoxBaseView::selected_item() const
 	{
@@ -74,33 +132,45 @@ namespace uicore
 	
 	void ListBoxBaseView::set_selected_item(int index)
 	{
-		/*
 		if (index == impl->selected_item)
 			return;
 		
-		if (index < -1 || index >= (int) content_view()->children().size())
+		if (index < -1 || index >= impl->item_count())
 			throw Exception("Listbox index out of bounds");
 
-		if (impl->selected_item != -1)
-			content_view()->children().at(impl->selected_item)->set_state("selected", false);
+		auto old_selected_item = impl->item_view(impl->selected_item);
+		if (old_selected_item)
+			old_selected_item->set_state("selected", false);
 		
 		if (index != -1)
 		{
 			if (impl->hot_item == index)
 				impl->set_hot_item(-1);
 
-			auto new_selected_item = content_view()->children().at(index);
-			new_selected_item->set_state("selected", true);
-			
-			// To do: call set_content_offset() if new_selected_item is not within range (maybe add a helper on ScrollBaseView for this?)
+			auto new_selected_item = impl->item_view(index);
+			if (new_selected_item)
+				new_selected_item->set_state("selected", true);
 		}
 		
 		impl->selected_item = index;
-		*/
+
+		if (index != -1)
+			impl->scroll_to_item(index);
 	}
 
 	Signal<void()> &ListBoxBaseView::sig_selection_changed()
 	{
 		return impl->sig_selection_changed;
 	}
+
+	void ListBoxBaseView::layout_children(const CanvasPtr &canvas)
+	{
+		if (impl->rows_view)
+			impl->measure_row_height(canvas);
+
+		ScrollBaseView::layout_children(canvas);
+
+		if (impl->rows_view)
+			impl->update_rows(canvas);
+	}
 }
@@ -29,6 +29,7 @@
 
 #include "UICore/precomp.h"
 #include "UICore/UI/StandardViews/listbox_view.h"
+#include "UICore/UI/StandardViews/scrollbar_view.h"
 #include "UICore/UI/Events/pointer_event.h"
 #include "UICore/UI/Events/key_event.h"
 #include "listbox_view_impl.h"
@@ -37,8 +38,8 @@ namespace uicore
 {
 	void ListBoxBaseViewImpl::on_key_press(KeyEvent &e)
 	{
-		/*
-		if (listbox->content_view()->children().empty())
+		int count = item_count();
+		if (count == 0)
 			return;
 
 		if (e.key() == Key::up)
@@ -48,14 +49,21 @@ namespace uicore
 		}
 		else if (e.key() == Key::down)
 		{
-			listbox->set_selected_item(uicore::min(selected_item + 1, (int)listbox->content_view()->children().size() - 1));
+			listbox->set_selected_item(uicore::min(selected_item + 1, count - 1));
 			sig_selection_changed();
 		}
-		*/
 	}
 
 	void ListBoxBaseViewImpl::on_pointer_press(PointerEvent &e)
 	{
+		if (e.button() == PointerButton::wheel_up || e.button() == PointerButton::wheel_down)
+		{
+			// Scrolling changes which rows are in view
+			if (rows_view)
+				listbox->set_needs_layout();
+			return;
+		}
+
 		if (e.button() != PointerButton::left)
 			return;
 
@@ -85,37 +93,42 @@ namespace uicore
 
 	int ListBoxBaseViewImpl::get_selection_index(PointerEvent &e)
 	{
+		if (rows_view)
+		{
+			Pointf pos = e.pos(rows_view);
+			if (row_height <= 0.0f || pos.x < 0.0f || pos.x >= rows_view->geometry().content_width || pos.y < 0.0f)
+				return -1;
+			int index = (int)(pos.y / row_height);
+			return index < source_item_count ? index : -1;
+		}
+
 		int index = 0;
-		for (const auto &view : listbox->content_view()->children())
+		for (const auto &view : items)
 		{
 			if (view->geometry().border_box().contains(e.pos(listbox->content_view())))
 				return index;
 			index++;
 		}
 		return -1;
-
 	}
 
 	void ListBoxBaseViewImpl::set_hot_item(int index)
 	{
-		/*
 		if ((index == hot_item) || (index == selected_item))		// Selected item state has priority
 			return;
 
-		if (index < -1 || index >= (int) listbox->content_view()->children().size())
+		if (index < -1 || index >= item_count())
 			throw Exception("Listbox index out of bounds");
 
-		if (hot_item != -1)
-			listbox->content_view()->children().at(hot_item)->set_state("hot", false);
+		auto old_hot_item = item_view(hot_item);
+		if (old_hot_item)
+			old_hot_item->set_state("hot", false);
 
-		if (index != -1)
-		{
-			auto new_selected_item = listbox->content_view()->children().at(index);
-			new_selected_item->set_state("hot", true);
-		}
+		auto new_hot_item = item_view(index);
+		if (new_hot_item)
+			new_hot_item->set_state("hot", true);
 
 		hot_item = index;
-		*/
 	}
 
 	void ListBoxBaseViewImpl::on_pointer_enter(PointerEvent &e)
@@ -128,4 +141,180 @@ namespace uicore
 		set_hot_item(-1);
 	}
 
+	void ListBoxBaseViewImpl::on_pointer_move(PointerEvent &e)
+	{
+		// Rows of an item source are recycled, so hot tracking follows the pointer instead of enter and leave events on rows
+		if (rows_view)
+			set_hot_item(get_selection_index(e));
+	}
+
+	int ListBoxBaseViewImpl::item_count() const
+	{
+		return rows_view ? source_item_count : (int)items.size();
+	}
+
+	std::shared_ptr<View> ListBoxBaseViewImpl::item_view(int index) const
+	{
+		if (rows_view)
+		{
+			if (index >= first_row && index < first_row + (int)rows.size())
+				return rows[index - first_row];
+			return nullptr;
+		}
+
+		if (index >= 0 && index < (int)items.size())
+			return items[index];
+		return nullptr;
+	}
+
+	void ListBoxBaseViewImpl::scroll_to_item(int index)
+	{
+		float top = 0.0f;
+		float bottom = 0.0f;
+		if (rows_view)
+		{
+			top = index * row_height;
+			bottom = top + row_height;
+		}
+		else
+		{
+			Rectf box = items[index]->geometry().margin_box();
+			top = box.top;
+			bottom = box.bottom;
+		}
+
+		auto scroll_y = listbox->scrollbar_y_view();
+		float viewport_height = listbox->content_view()->parent()->geometry().content_height;
+		double position = scroll_y->position();
+		if (top < position)
+			scroll_y->set_position(top);
+		else if (bottom > position + viewport_height)
+			scroll_y->set_position(bottom - viewport_height);
+	}
+
+	void ListBoxBaseViewImpl::measure_row_height(const CanvasPtr &canvas)
+	{
+		if (fixed_row_height > 0.0f || row_height > 0.0f || source_item_count == 0)
+			return;
+
+		std::shared_ptr<View> recycled_view;
+		if (!recycled_rows.empty())
+		{
+			recycled_view = recycled_rows.back();
+			recycled_rows.pop_back();
+		}
+
+		auto view = row_factory(0, recycled_view);
+		if (recycled_view && view != recycled_view)
+			recycled_view->remove_from_parent();
+		if (!view->parent())
+			rows_view->add_child(view);
+		view->set_hidden(true);
+		recycled_rows.push_back(view);
+
+		float width = listbox->geometry().content_width;
+		row_height = uicore::max(view->preferred_margin_height(canvas, width), 1.0f);
+	}
+
+	void ListBoxBaseViewImpl::update_rows(const CanvasPtr &canvas)
+	{
+		float viewport_top = listbox->content_offset().y;
+		float viewport_height = rows_view->parent()->geometry().content_height;
+
+		int new_first_row = 0;
+		int new_end_row = 0;
+		if (row_height > 0.0f)
+		{
+			new_first_row = uicore::max((int)(viewport_top / row_height) - overscan_rows, 0);
+			new_end_row = uicore::min((int)std::ceil((viewport_top + viewport_height) / row_height) + overscan_rows, source_item_count);
+			new_end_row = uicore::max(new_end_row, new_first_row);
+		}
+
+		std::vector<std::shared_ptr<View>> new_rows(new_end_row - new_first_row);
+
+		for (size_t i = 0; i < rows.size(); i++)
+		{
+			int index = first_row + (int)i;
+			if (index >= new_first_row && index < new_end_row)
+			{
+				new_rows[index - new_first_row] = rows[i];
+			}
+			else
+			{
+				rows[i]->set_hidden(true);
+				recycled_rows.push_back(rows[i]);
+			}
+		}
+
+		for (size_t i = 0; i < new_rows.size(); i++)
+		{
+			if (new_rows[i])
+				continue;
+
+			std::shared_ptr<View> recycled_view;
+			if (!recycled_rows.empty())
+			{
+				recycled_view = recycled_rows.back();
+				recycled_rows.pop_back();
+			}
+
+			int index = new_first_row + (int)i;
+			auto view = row_factory(index, recycled_view);
+			if (recycled_view && view != recycled_view)
+				recycled_view->remove_from_parent();
+			if (!view->parent())
+				rows_view->add_child(view);
+			view->set_hidden(false);
+			apply_row_states(index, view);
+			new_rows[i] = view;
+		}
+
+		first_row = new_first_row;
+		rows.swap(new_rows);
+
+		rows_view->layout_children(canvas);
+	}
+
+	void ListBoxBaseViewImpl::clear_rows()
+	{
+		for (auto &row : rows)
+			row->remove_from_parent();
+		for (auto &row : recycled_rows)
+			row->remove_from_parent();
+		rows.clear();
+		recycled_rows.clear();
+		first_row = 0;
+		row_height = fixed_row_height;
+	}
+
+	void ListBoxBaseViewImpl::apply_row_states(int index, const std::shared_ptr<View> &view)
+	{
+		view->set_state("selected", index == selected_item);
+		view->set_state("hot", index == hot_item);
+	}
+
+	void ListBoxRowsView::layout_children(const CanvasPtr &canvas)
+	{
+		float width = geometry().content_width;
+		for (size_t i = 0; i < impl->rows.size(); i++)
+		{
+			const auto &row = impl->rows[i];
+			float top = (impl->first_row + (int)i) * impl->row_height;
+			row->set_geometry(ViewGeometry::from_margin_box(row->style_cascade(), Rectf(0.0f, top, width, top + impl->row_height)));
+			row->layout_children(canvas);
+		}
+	}
+
+	float ListBoxRowsView::calculate_preferred_width(const CanvasPtr &canvas)
+	{
+		float width = 0.0f;
+		for (const auto &row : impl->rows)
+			width = uicore::max(width, row->preferred_margin_width(canvas));
+		return width;
+	}
+
+	float ListBoxRowsView::calculate_preferred_height(const CanvasPtr &canvas, float width)
+	{
+		return impl->source_item_count * impl->row_height;
+	}
 }
@@ -30,6 +30,24 @@
 
 namespace uicore
 {
+	class ListBoxBaseViewImpl;
+
+	/// Content view of a list box showing rows created on demand
+	class ListBoxRowsView : public View
+	{
+	public:
+		ListBoxRowsView(ListBoxBaseViewImpl *impl) : impl(impl) { }
+
+		void layout_children(const CanvasPtr &canvas) override;
+
+	protected:
+		float calculate_preferred_width(const CanvasPtr &canvas) override;
+		float calculate_preferred_height(const CanvasPtr &canvas, float width) override;
+
+	private:
+		ListBoxBaseViewImpl *impl;
+	};
+
 	class ListBoxBaseViewImpl
 	{
 	public:
@@ -38,9 +56,19 @@ namespace uicore
 		void on_pointer_release(PointerEvent &e);
 		void on_pointer_enter(PointerEvent &e);
 		void on_pointer_leave(PointerEvent &e);
+		void on_pointer_move(PointerEvent &e);
 
 		void set_hot_item(int index);
 
+		int item_count() const;
+		std::shared_ptr<View> item_view(int index) const;
+		void scroll_to_item(int index);
+
+		void measure_row_height(const CanvasPtr &canvas);
+		void update_rows(const CanvasPtr &canvas);
+		void clear_rows();
+		void apply_row_states(int index, const std::shared_ptr<View> &view);
+
 		ListBoxBaseView *listbox = nullptr;
 		int selected_item = -1;
 		int hot_item = -1;
@@ -48,6 +76,27 @@ namespace uicore
 
 		Signal<void()> sig_selection_changed;
 
+		// Item views set by set_items
+		std::vector<std::shared_ptr<View>> items;
+
+		// Item source set by set_item_source
+		std::shared_ptr<ListBoxRowsView> rows_view;
+		std::shared_ptr<View> column_view;
+		std::function<std::shared_ptr<View>(int index, const std::shared_ptr<View> &recycled_view)> row_factory;
+		int source_item_count = 0;
+		float fixed_row_height = 0.0f;
+		float row_height = 0.0f;
+
+		// Realized rows, covering the items from first_row to first_row + rows.size()
+		int first_row = 0;
+		std::vector<std::shared_ptr<View>> rows;
+
+		// Row views scrolled out of view, waiting to be handed back to the row factory
+		std::vector<std::shared_ptr<View>> recycled_rows;
+
+		// Rows created above and below the viewport
+		static const int overscan_rows = 4;
+
 	private:
 		int get_selection_index(PointerEvent &e);
 	};
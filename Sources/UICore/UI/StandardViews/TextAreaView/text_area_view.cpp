@@ -52,7 +52,7 @@ namespace uicore
 	TextAreaBaseView::TextAreaBaseView() : impl(new TextAreaBaseViewImpl())
 	{
 		impl->textfield = this;
-		impl->text_lines.resize(1);
+		impl->text_lines.assign({ std::string() });
 		impl->selection.set_view(this);
 
 		set_focus_policy(FocusPolicy::accept);
@@ -98,26 +98,15 @@ namespace uicore
 
 	std::string TextAreaBaseView::text() const
 	{
-		size_t length = 0;
-		for (const auto &line : impl->text_lines) length += line.length() + 1;
-
-		std::string all_text;
-		all_text.reserve(length);
-		for (const auto &line : impl->text_lines)
-		{
-			if (!all_text.empty())
-				all_text.push_back('\n');
-			all_text += line;
-		}
-
-		return all_text;
+		return impl->get_text(Vec2i(), Vec2i(impl->text_lines.back().size(), impl->text_lines.size() - 1));
 	}
 
 	void TextAreaBaseView::set_text(const std::string &text)
 	{
-		impl->text_lines = Text::split(text, "\n", false);
-		if (impl->text_lines.empty())
-			impl->text_lines.resize(1);
+		std::vector<std::string> lines = Text::split(text, "\n", false);
+		if (lines.empty())
+			lines.resize(1);
+		impl->text_lines.assign(std::move(lines));
 
 		impl->selection.reset();
 		impl->cursor_pos = Vec2i();
@@ -255,47 +244,59 @@ namespace uicore
 		float baseline = font_metrics.baseline_offset();
 		float top_y = baseline - font_metrics.ascent();
 		float bottom_y = baseline + font_metrics.descent();
+		float line_height = font_metrics.line_height();
 
 		Colorf color = style_cascade().computed_value("color").color();
 
-		float cursor_advance = canvas->grid_fit({ font->measure_text(canvas, impl->text_lines[impl->cursor_pos.y].substr(0, impl->cursor_pos.x)).advance.width, 0.0f }).x;
+		float cursor_advance = canvas->grid_fit({ impl->advance(canvas, font, impl->cursor_pos), 0.0f }).x;
 
 		// Keep cursor in view
 		impl->scroll_pos.x = std::min(impl->scroll_pos.x, cursor_advance);
 		impl->scroll_pos.x = std::max(impl->scroll_pos.x, cursor_advance - geometry().content_width + 1.0f);
 
-		size_t line_start_y = -impl->scroll_pos.y;
+		float cursor_top = line_height * impl->cursor_pos.y;
+		impl->scroll_pos.y = std::min(impl->scroll_pos.y, cursor_top);
+		impl->scroll_pos.y = std::max(impl->scroll_pos.y, cursor_top + line_height - geometry().content_height);
+
+		// Only lines intersecting the content box are drawn
+		int first_line = std::max((int)std::floor(impl->scroll_pos.y / line_height), 0);
+		int end_line = std::min((int)std::ceil((impl->scroll_pos.y + geometry().content_height) / line_height), (int)impl->text_lines.size());
 
-		for (size_t line_index = 0; line_index < impl->text_lines.size(); line_index++)
+		Vec2i selection_start = impl->selection.start();
+		Vec2i selection_end = impl->selection.end();
+		bool has_selection = selection_start != selection_end;
+
+		for (int line_index = first_line; line_index < end_line; line_index++)
 		{
-			std::string txt_before = impl->get_text_before_selection(line_index);
-			std::string txt_selected = impl->get_selected_text(line_index);
-			std::string txt_after = impl->get_text_after_selection(line_index);
+			const std::string &text = impl->text_lines[line_index];
+			float line_start_y = line_height * line_index - impl->scroll_pos.y;
+
+			if (!has_selection || line_index < selection_start.y || line_index > selection_end.y)
+			{
+				font->draw_text(canvas, -impl->scroll_pos.x, baseline + line_start_y, text, color);
+				continue;
+			}
 
-			float advance_before = font->measure_text(canvas, txt_before).advance.width;
-			float advance_selected = font->measure_text(canvas, txt_selected).advance.width;
+			int selected_begin = line_index == selection_start.y ? selection_start.x : 0;
+			int selected_end = line_index == selection_end.y ? selection_end.x : (int)text.length();
 
-			// Measure text for get_character_index()
-			impl->last_measured_rects = font->character_indices(canvas, txt_before + txt_selected + txt_after);
-			for (auto &box : impl->last_measured_rects)
-				box.translate(-impl->scroll_pos.x, line_start_y);
+			float advance_before = impl->advance(canvas, font, Vec2i(selected_begin, line_index));
+			float advance_after = impl->advance(canvas, font, Vec2i(selected_end, line_index));
 
-			if (!txt_selected.empty())
+			if (selected_begin != selected_end)
 			{
-				Rectf selection_rect = Rectf(advance_before - impl->scroll_pos.x, top_y + line_start_y, advance_before + advance_selected - impl->scroll_pos.x, bottom_y + line_start_y);
+				Rectf selection_rect = Rectf(advance_before - impl->scroll_pos.x, top_y + line_start_y, advance_after - impl->scroll_pos.x, bottom_y + line_start_y);
 				Path::rect(selection_rect)->fill(canvas, focus_view() == this ? Brush::solid_rgb8(51, 153, 255) : Brush::solid_rgb8(200, 200, 200));
 			}
 
-			font->draw_text(canvas, -impl->scroll_pos.x, baseline + line_start_y, txt_before, color);
-			font->draw_text(canvas, advance_before - impl->scroll_pos.x, baseline + line_start_y, txt_selected, focus_view() == this ? Colorf(255, 255, 255) : color);
-			font->draw_text(canvas, advance_before + advance_selected - impl->scroll_pos.x, baseline + line_start_y, txt_after, color);
-
-			line_start_y += font_metrics.line_height();
+			font->draw_text(canvas, -impl->scroll_pos.x, baseline + line_start_y, text.substr(0, selected_begin), color);
+			font->draw_text(canvas, advance_before - impl->scroll_pos.x, baseline + line_start_y, text.substr(selected_begin, selected_end - selected_begin), focus_view() == this ? Colorf(255, 255, 255) : color);
+			font->draw_text(canvas, advance_after - impl->scroll_pos.x, baseline + line_start_y, text.substr(selected_end), color);
 		}
 
 		if (impl->cursor_blink_visible)
 		{
-			auto cursor_pos = canvas->grid_fit({ cursor_advance - impl->scroll_pos.x, top_y - impl->scroll_pos.y + font_metrics.line_height() * impl->cursor_pos.y });
+			auto cursor_pos = canvas->grid_fit({ cursor_advance - impl->scroll_pos.x, top_y - impl->scroll_pos.y + line_height * impl->cursor_pos.y });
 			Path::rect(cursor_pos.x, cursor_pos.y, 1.0f, bottom_y - top_y)->fill(canvas, Brush(color));
 		}
 
@@ -340,6 +341,40 @@ namespace uicore
 		return font;
 	}
 
+	const std::vector<Rectf> &TextAreaBaseViewImpl::glyph_boxes(const CanvasPtr &canvas, const FontPtr &font, int line)
+	{
+		if (measured_font != font)
+		{
+			text_lines.invalidate_measurements();
+			measured_font = font;
+		}
+
+		TextAreaLine &text_line = text_lines.line(line);
+		if (!text_line.measured)
+		{
+			text_line.glyph_boxes = font->character_indices(canvas, text_line.text);
+			text_line.measured = true;
+		}
+		return text_line.glyph_boxes;
+	}
+
+	float TextAreaBaseViewImpl::advance(const CanvasPtr &canvas, const FontPtr &font, Vec2i pos)
+	{
+		const std::vector<Rectf> &boxes = glyph_boxes(canvas, font, pos.y);
+		const std::string &text = text_lines[pos.y];
+
+		// Glyph boxes are per character, while positions are byte offsets into UTF-8 text
+		size_t characters = 0;
+		for (int i = 0; i < pos.x; i++)
+		{
+			if ((text[i] & 0xc0) != 0x80)
+				characters++;
+		}
+
+		characters = std::min(characters, boxes.size());
+		return characters > 0 ? boxes[characters - 1].right : 0.0f;
+	}
+
 	void TextAreaBaseViewImpl::start_blink()
 	{
 		blink_timer->func_expired() = [&]()
@@ -576,7 +611,7 @@ namespace uicore
 
 	void TextAreaBaseViewImpl::select_all()
 	{
-		selection.set_head_and_tail(Vec2i(), Vec2i(text_lines.back().size(), text_lines.size()));
+		selection.set_head_and_tail(Vec2i(), Vec2i(text_lines.back().size(), text_lines.size() - 1));
 	}
 
 	void TextAreaBaseViewImpl::move_line(int steps, bool ctrl, bool shift, bool stay_on_line)
@@ -771,29 +806,16 @@ namespace uicore
 		}
 		else if (cursor_pos.x > 0)
 		{
-			save_undo();
-
 			UTF8_Reader utf8_reader(text_lines[cursor_pos.y].data(), text_lines[cursor_pos.y].length());
 			utf8_reader.set_position(cursor_pos.x);
 			utf8_reader.prev();
 			int new_cursor_pos = utf8_reader.position();
 
-			text_lines[cursor_pos.y].erase(text_lines[cursor_pos.y].begin() + new_cursor_pos, text_lines[cursor_pos.y].begin() + cursor_pos.x);
-			cursor_pos.x = new_cursor_pos;
-
-			textfield->set_needs_render();
+			replace(Vec2i(new_cursor_pos, cursor_pos.y), cursor_pos, std::string());
 		}
 		else if (cursor_pos.y > 0)
 		{
-			save_undo();
-
-			cursor_pos.y--;
-			cursor_pos.x = text_lines[cursor_pos.y].length();
-
-			text_lines[cursor_pos.y] += text_lines[cursor_pos.y + 1];
-			text_lines.erase(text_lines.begin() + cursor_pos.y + 1);
-
-			textfield->set_needs_render();
+			replace(Vec2i(text_lines[cursor_pos.y - 1].length(), cursor_pos.y - 1), cursor_pos, std::string());
 		}
 	}
 
@@ -801,45 +823,18 @@ namespace uicore
 	{
 		if (selection.start() != selection.end())
 		{
-			save_undo();
-
-			auto start = selection.start();
-			auto end = selection.end();
-
-			if (start.y == end.y)
-			{
-				text_lines[start.y].erase(text_lines[start.y].begin() + start.x, text_lines[start.y].begin() + end.x);
-			}
-			else
-			{
-				text_lines[start.y].erase(text_lines[start.y].begin() + start.x, text_lines[start.y].end());
-				text_lines[end.y].erase(text_lines[end.y].begin(), text_lines[end.y].begin() + end.x);
-				text_lines.erase(text_lines.begin() + start.y + 1, text_lines.begin() + end.y);
-			}
-
-			cursor_pos = start;
-			selection.reset();
-
-			textfield->set_needs_render();
+			replace(selection.start(), selection.end(), std::string());
 		}
 		else if (cursor_pos.x < text_lines[cursor_pos.y].length())
 		{
-			save_undo();
-
 			UTF8_Reader utf8_reader(text_lines[cursor_pos.y].data(), text_lines[cursor_pos.y].length());
 			utf8_reader.set_position(cursor_pos.x);
-			text_lines[cursor_pos.y].erase(text_lines[cursor_pos.y].begin() + cursor_pos.x, text_lines[cursor_pos.y].begin() + cursor_pos.x + utf8_reader.char_length());
 
-			textfield->set_needs_render();
+			replace(cursor_pos, Vec2i(cursor_pos.x + utf8_reader.char_length(), cursor_pos.y), std::string());
 		}
 		else if (cursor_pos.y + 1 < text_lines.size())
 		{
-			save_undo();
-
-			text_lines[cursor_pos.y] += text_lines[cursor_pos.y + 1];
-			text_lines.erase(text_lines.begin() + cursor_pos.y + 1);
-
-			textfield->set_needs_render();
+			replace(cursor_pos, Vec2i(0, cursor_pos.y + 1), std::string());
 		}
 	}
 
@@ -880,167 +875,164 @@ namespace uicore
 
 	void TextAreaBaseViewImpl::undo()
 	{
-		/*
 		if (undo_buffer.empty())
 			return;
 
-		UndoInfo info;
-		info.text = text;
-		info.cursor_pos = cursor_pos;
-		info.selection_start = selection.start();
-		info.selection_length = selection.length();
-		redo_buffer.push_back(info);
+		UndoInfo info = undo_buffer.back();
+		undo_buffer.pop_back();
 
-		text = undo_buffer.back().text;
-		cursor_pos = undo_buffer.back().cursor_pos;
-		selection.set(undo_buffer.back().selection_start, undo_buffer.back().selection_length);
+		replace_text(info.start, text_end(info.start, info.inserted), info.removed);
+		cursor_pos = info.cursor_pos;
+		selection.reset();
 
-		undo_buffer.pop_back();
+		redo_buffer.push_back(info);
+		needs_new_undo_step = true;
 
 		textfield->set_needs_render();
-		*/
 	}
 
 	void TextAreaBaseViewImpl::redo()
 	{
-		/*
 		if (redo_buffer.empty())
 			return;
 
-		UndoInfo info;
-		info.text = text;
-		info.cursor_pos = cursor_pos;
-		info.selection_start = selection.start();
-		info.selection_length = selection.length();
-		undo_buffer.push_back(info);
+		UndoInfo info = redo_buffer.back();
+		redo_buffer.pop_back();
 
-		text = redo_buffer.back().text;
-		cursor_pos = redo_buffer.back().cursor_pos;
-		selection.set(redo_buffer.back().selection_start, redo_buffer.back().selection_length);
+		cursor_pos = replace_text(info.start, text_end(info.start, info.removed), info.inserted);
+		selection.reset();
 
-		redo_buffer.pop_back();
+		undo_buffer.push_back(info);
+		needs_new_undo_step = true;
 
 		textfield->set_needs_render();
-		*/
 	}
 
-	void TextAreaBaseViewImpl::save_undo()
+	void TextAreaBaseViewImpl::replace(Vec2i start, Vec2i end, const std::string &new_text)
 	{
-		/*
+		if (start == end && new_text.empty())
+			return;
+
+		std::string removed = get_text(start, end);
+
 		redo_buffer.clear();
 
-		if (undo_buffer.empty() || needs_new_undo_step)
+		// Typing and repeated backspace or delete extend the last undo step until the cursor is moved
+		bool merged = false;
+		if (!needs_new_undo_step && !undo_buffer.empty())
+		{
+			UndoInfo &last = undo_buffer.back();
+			if (removed.empty() && last.removed.empty() && start == last_edit_end)
+			{
+				last.inserted += new_text;
+				merged = true;
+			}
+			else if (new_text.empty() && last.inserted.empty() && end == last.start)
+			{
+				last.start = start;
+				last.removed = removed + last.removed;
+				merged = true;
+			}
+			else if (new_text.empty() && last.inserted.empty() && start == last.start)
+			{
+				last.removed += removed;
+				merged = true;
+			}
+		}
+
+		if (!merged)
 		{
 			UndoInfo info;
-			info.text = text;
+			info.start = start;
+			info.removed = std::move(removed);
+			info.inserted = new_text;
 			info.cursor_pos = cursor_pos;
-			info.selection_start = selection.start();
-			info.selection_length = selection.length();
-			undo_buffer.push_back(info);
-			needs_new_undo_step = false;
+			undo_buffer.push_back(std::move(info));
 		}
-		*/
+		needs_new_undo_step = false;
+
+		cursor_pos = replace_text(start, end, new_text);
+		last_edit_end = cursor_pos;
+		selection.reset();
+
+		textfield->set_needs_render();
 	}
 
-	void TextAreaBaseViewImpl::add(std::string new_text)
+	Vec2i TextAreaBaseViewImpl::replace_text(Vec2i start, Vec2i end, const std::string &new_text)
 	{
-		if (selection.start() != selection.end())
-			del();
+		std::string text_after = text_lines[end.y].substr(end.x);
+		text_lines.edit(start.y).resize(start.x);
+		if (end.y > start.y)
+			text_lines.erase(start.y + 1, end.y + 1);
 
-		save_undo();
-
-		size_t start = 0;
+		Vec2i pos = start;
+		size_t text_start = 0;
 		while (true)
 		{
-			size_t end = new_text.find('\n', start);
-			if (end == std::string::npos)
-				end = new_text.size();
-
-			text_lines[cursor_pos.y] = text_lines[cursor_pos.y].substr(0, cursor_pos.x) + new_text.substr(start, end - start) + text_lines[cursor_pos.y].substr(cursor_pos.x);
-			cursor_pos.x += end - start;
-
-			if (end == new_text.size())
-				break;
-			start = end + 1;
+			size_t text_end = new_text.find('\n', text_start);
+			if (text_end == std::string::npos)
+			{
+				std::string &line = text_lines.edit(pos.y);
+				line.append(new_text, text_start, std::string::npos);
+				pos.x = line.length();
+				line += text_after;
+				return pos;
+			}
 
-			text_lines.insert(text_lines.begin() + cursor_pos.y + 1, text_lines[cursor_pos.y].substr(cursor_pos.x));
-			text_lines[cursor_pos.y].resize(cursor_pos.x);
-			cursor_pos = Vec2i(0, cursor_pos.y + 1);
+			text_lines.edit(pos.y).append(new_text, text_start, text_end - text_start);
+			pos.y++;
+			text_lines.insert(pos.y, std::string());
+			text_start = text_end + 1;
 		}
+	}
 
-		textfield->set_needs_render();
+	Vec2i TextAreaBaseViewImpl::text_end(Vec2i start, const std::string &text)
+	{
+		size_t last_newline = text.rfind('\n');
+		if (last_newline == std::string::npos)
+			return Vec2i(start.x + (int)text.length(), start.y);
+		return Vec2i((int)(text.length() - last_newline - 1), start.y + (int)std::count(text.begin(), text.end(), '\n'));
+	}
+
+	void TextAreaBaseViewImpl::add(std::string new_text)
+	{
+		if (selection.start() != selection.end())
+			replace(selection.start(), selection.end(), new_text);
+		else
+			replace(cursor_pos, cursor_pos, new_text);
 	}
 
 	std::string TextAreaBaseViewImpl::get_all_selected_text() const
 	{
-		Vec2i start = selection.start();
-		Vec2i end = selection.end();
+		return get_text(selection.start(), selection.end());
+	}
 
+	std::string TextAreaBaseViewImpl::get_text(Vec2i start, Vec2i end) const
+	{
 		if (start.y == end.y)
 		{
 			return text_lines[start.y].substr(start.x, end.x - start.x);
 		}
 		else
 		{
-			size_t length = text_lines[start.y].length() - start.x + text_lines[end.y].length() - end.x + 1;
+			size_t length = text_lines[start.y].length() - start.x + end.x + 1;
 			for (auto y = start.y + 1; y < end.y; y++)
 				length += text_lines[y].length() + 1;
 
 			std::string result;
 			result.reserve(length);
-			result += text_lines[start.y].substr(start.x);
+			result.append(text_lines[start.y], start.x, std::string::npos);
 			result.push_back('\n');
 			for (auto y = start.y + 1; y < end.y; y++)
 			{
 				result += text_lines[y];
 				result.push_back('\n');
 			}
-			result += text_lines[end.y].substr(0, end.x);
+			result.append(text_lines[end.y], 0, end.x);
 			return result;
 		}
 	}
 
-	std::string TextAreaBaseViewImpl::get_text_before_selection(size_t line_index) const
-	{
-		Vec2i start = selection.start();
-
-		if ((size_t)start.y == line_index)
-			return text_lines[line_index].substr(0, start.x);
-		else if ((size_t)start.y > line_index)
-			return text_lines[line_index];
-		else
-			return std::string();
-	}
-
-	std::string TextAreaBaseViewImpl::get_selected_text(size_t line_index) const
-	{
-		Vec2i start = selection.start();
-		Vec2i end = selection.end();
-
-		if (start.y == line_index && end.y == line_index)
-			return text_lines[line_index].substr(start.x, end.x - start.x);
-		else if ((size_t)start.y > line_index || (size_t)end.y < line_index)
-			return std::string();
-		else if (start.y == line_index)
-			return text_lines[line_index].substr(start.x);
-		else if (end.y == line_index)
-			return text_lines[line_index].substr(0, end.x);
-		else
-			return text_lines[line_index];
-	}
-
-	std::string TextAreaBaseViewImpl::get_text_after_selection(size_t line_index) const
-	{
-		Vec2i end = selection.end();
-
-		if ((size_t)end.y == line_index)
-			return text_lines[line_index].substr(end.x);
-		else if ((size_t)end.y < line_index)
-			return text_lines[line_index];
-		else
-			return std::string();
-	}
-
 	int TextAreaBaseViewImpl::find_next_break_character(int search_start, int line) const
 	{
 		if (search_start == text_lines[line].size())
@@ -1064,21 +1056,100 @@ namespace uicore
 
 	Vec2i TextAreaBaseViewImpl::get_character_index(const Pointf &pos)
 	{
-		return Vec2i();
-		/*
-		if (last_measured_rects.empty())
+		ViewTree *tree = textfield->view_tree();
+		CanvasPtr canvas = tree ? tree->canvas() : nullptr;
+		if (!canvas)
 			return Vec2i();
 
-		for (unsigned int cnt = 0; cnt < last_measured_rects.size(); cnt++)
+		FontPtr font = get_font(canvas);
+		float line_height = font->font_metrics(canvas).line_height();
+
+		// Only the line under the pointer is measured
+		int line = (int)std::floor((pos.y + scroll_pos.y) / line_height);
+		line = std::max(std::min(line, (int)text_lines.size() - 1), 0);
+
+		const std::vector<Rectf> &boxes = glyph_boxes(canvas, font, line);
+		float x = pos.x + scroll_pos.x;
+		size_t character = 0;
+		while (character < boxes.size() && (boxes[character].left + boxes[character].right) * 0.5f < x)
+			character++;
+
+		const std::string &text = text_lines[line];
+		UTF8_Reader utf8_reader(text.data(), text.length());
+		for (size_t i = 0; i < character && !utf8_reader.is_end(); i++)
+			utf8_reader.next();
+		return Vec2i((int)utf8_reader.position(), line);
+	}
+
+	const std::string TextAreaBaseViewImpl::break_characters = " ::;,.-";
+
+	/////////////////////////////////////////////////////////////////////////
+
+	void TextAreaLines::insert(size_t index, std::string text)
+	{
+		if (gap_start == gap_end)
 		{
-			if ((last_measured_rects[cnt].left <= pos.x) && (last_measured_rects[cnt].right > pos.x))
-				return cnt + 1;
+			size_t tail_length = lines.size() - gap_end;
+			size_t new_gap_length = std::max(lines.size(), (size_t)16);
+			lines.resize(lines.size() + new_gap_length);
+			std::move_backward(lines.begin() + gap_end, lines.begin() + gap_end + tail_length, lines.end());
+			gap_end += new_gap_length;
 		}
-		if (last_measured_rects[0].left >= pos.x)
-			return 0;
-		return last_measured_rects.size();
-		*/
+
+		move_gap(index);
+
+		TextAreaLine &line = lines[gap_start++];
+		line.text = std::move(text);
+		line.measured = false;
 	}
 
-	const std::string TextAreaBaseViewImpl::break_characters = " ::;,.-";
+	void TextAreaLines::erase(size_t first, size_t last)
+	{
+		move_gap(first);
+		for (size_t i = gap_end; i < gap_end + last - first; i++)
+			lines[i] = TextAreaLine();
+		gap_end += last - first;
+	}
+
+	void TextAreaLines::assign(std::vector<std::string> new_lines)
+	{
+		lines.clear();
+		lines.resize(new_lines.size());
+		for (size_t i = 0; i < new_lines.size(); i++)
+			lines[i].text = std::move(new_lines[i]);
+		gap_start = lines.size();
+		gap_end = lines.size();
+	}
+
+	void TextAreaLines::invalidate_measurements()
+	{
+		for (auto &line : lines)
+		{
+			line.measured = false;
+			line.glyph_boxes.clear();
+		}
+	}
+
+	void TextAreaLines::move_gap(size_t index)
+	{
+		if (gap_start == gap_end)
+		{
+			// An empty gap can be placed anywhere without moving lines
+			gap_start = index;
+			gap_end = index;
+		}
+		else if (index < gap_start)
+		{
+			std::move_backward(lines.begin() + index, lines.begin() + gap_start, lines.begin() + gap_end);
+			gap_end -= gap_start - index;
+			gap_start = index;
+		}
+		else if (index > gap_start)
+		{
+			size_t count = index - gap_start;
+			std::move(lines.begin() + gap_end, lines.begin() + gap_end + count, lines.begin() + gap_start);
+			gap_start += count;
+			gap_end += count;
+		}
+	}
 }
@@ -81,6 +81,57 @@ namespace uicore
 		Vec2i selection_tail;
 	};
 
+	/// Line of text in a text area
+	class TextAreaLine
+	{
+	public:
+		std::string text;
+
+		/// Glyph boxes of the line, valid while measured is set
+		std::vector<Rectf> glyph_boxes;
+		bool measured = false;
+	};
+
+	/// Lines of a text area stored in a gap buffer
+	///
+	/// Edits happen around the cursor, so inserting and removing lines there only moves the lines between the gap and
+	/// the cursor instead of the rest of the document.
+	class TextAreaLines
+	{
+	public:
+		size_t size() const { return lines.size() - gap_length(); }
+
+		const std::string &operator[](size_t index) const { return line(index).text; }
+		const std::string &front() const { return line(0).text; }
+		const std::string &back() const { return line(size() - 1).text; }
+
+		TextAreaLine &line(size_t index) { return lines[index < gap_start ? index : index + gap_length()]; }
+		const TextAreaLine &line(size_t index) const { return lines[index < gap_start ? index : index + gap_length()]; }
+
+		/// Text of a line for modification. Discards the cached measurement of the line
+		std::string &edit(size_t index)
+		{
+			TextAreaLine &l = line(index);
+			l.measured = false;
+			return l.text;
+		}
+
+		void insert(size_t index, std::string text);
+		void erase(size_t first, size_t last);
+		void assign(std::vector<std::string> new_lines);
+
+		/// Discards the cached measurement of all lines
+		void invalidate_measurements();
+
+	private:
+		size_t gap_length() const { return gap_end - gap_start; }
+		void move_gap(size_t index);
+
+		std::vector<TextAreaLine> lines;
+		size_t gap_start = 0;
+		size_t gap_end = 0;
+	};
+
 	class TextAreaBaseViewImpl
 	{
 	public:
@@ -111,7 +162,9 @@ namespace uicore
 		void start_blink();
 		void stop_blink();
 
-		void save_undo();
+		void replace(Vec2i start, Vec2i end, const std::string &new_text);
+		Vec2i replace_text(Vec2i start, Vec2i end, const std::string &new_text);
+		static Vec2i text_end(Vec2i start, const std::string &text);
 
 		TextAreaBaseView *textfield = nullptr;
 
@@ -119,9 +172,13 @@ namespace uicore
 
 		FontPtr &get_font(const CanvasPtr &canvas);
 		FontPtr font; // Do not use directly. Use get_font.
+		FontPtr measured_font;
+
+		const std::vector<Rectf> &glyph_boxes(const CanvasPtr &canvas, const FontPtr &font, int line);
+		float advance(const CanvasPtr &canvas, const FontPtr &font, Vec2i pos);
 
 		Size preferred_size = Size(20, 5);
-		std::vector<std::string> text_lines;
+		TextAreaLines text_lines;
 		std::string placeholder;
 
 		bool readonly = false;
@@ -139,31 +196,28 @@ namespace uicore
 		bool ignore_mouse_events = false;
 		bool mouse_selecting = false;
 
+		/// Edit that replaced the removed text at start with the inserted text
 		struct UndoInfo
 		{
-			std::string text;
-			size_t selection_start = 0;
-			size_t selection_length = 0;
-			size_t cursor_pos = 0;
+			Vec2i start;
+			std::string removed;
+			std::string inserted;
+			Vec2i cursor_pos;
 		};
 
 		std::vector<UndoInfo> undo_buffer;
 		std::vector<UndoInfo> redo_buffer;
 		bool needs_new_undo_step = true;
+		Vec2i last_edit_end;
 
 		static const std::string break_characters;
 
-		std::vector<Rectf> last_measured_rects;
-
 		Signal<void(KeyEvent *)> sig_before_edit_changed;
 		Signal<void(KeyEvent *)> sig_after_edit_changed;
 		Signal<void(KeyEvent *)> sig_enter_pressed;
 
 		std::string get_all_selected_text() const;
-
-		std::string get_text_before_selection(size_t line_index) const;
-		std::string get_selected_text(size_t line_index) const;
-		std::string get_text_after_selection(size_t line_index) const;
+		std::string get_text(Vec2i start, Vec2i end) const;
 
 		int find_next_break_character(int search_start, int line) const;
 		int find_previous_break_character(int search_start, int line) const;
@@ -40,6 +40,7 @@
 #include "Properties/outline.h"
 #include "Properties/padding.h"
 #include "Properties/text_and_font.h"
+#include <list>
 
 namespace uicore
 {
@@ -62,7 +63,64 @@ namespace uicore
 		}
 	} style_force_link;
 
-	Style::Style() : impl(new StyleImpl())
+	class StyleParseCache
+	{
+	public:
+		static bool &enabled()
+		{
+			static bool enabled = false;
+			return enabled;
+		}
+
+		static const StyleParsedProperties &get(const std::string &properties)
+		{
+			auto &cache = instance();
+
+			// Move the entry to the front of the list, so that the least recently used entry is always at the back
+			auto it = cache.lookup.find(properties);
+			if (it != cache.lookup.end())
+			{
+				cache.entries.splice(cache.entries.begin(), cache.entries, it->second);
+				return *it->second->second;
+			}
+
+			std::unique_ptr<StyleParsedProperties> parsed(new StyleParsedProperties(properties));
+			cache.entries.emplace_front(properties, std::move(parsed));
+			cache.lookup[properties] = cache.entries.begin();
+
+			// Styles that were set from an evicted string keep their values, as they hold their own reference to them
+			if (cache.entries.size() > max_entries)
+			{
+				cache.lookup.erase(cache.entries.back().first);
+				cache.entries.pop_back();
+			}
+
+			return *cache.entries.front().second;
+		}
+
+		static void clear()
+		{
+			auto &cache = instance();
+			cache.lookup.clear();
+			cache.entries.clear();
+		}
+
+	private:
+		typedef std::list<std::pair<std::string, std::unique_ptr<StyleParsedProperties>>> EntryList;
+
+		static StyleParseCache &instance()
+		{
+			static StyleParseCache cache;
+			return cache;
+		}
+
+		EntryList entries;
+		std::unordered_map<std::string, EntryList::iterator> lookup;
+
+		static const size_t max_entries = 4096;
+	};
+
+	Style::Style() : impl(std::make_shared<StyleImpl>())
 	{
 	}
 
@@ -72,42 +130,82 @@ namespace uicore
 
 	void Style::set(const std::string &properties)
 	{
-		StyleProperty::parse(impl.get(), properties);
+		if (!StyleParseCache::enabled())
+		{
+			detach();
+			StyleProperty::parse(impl.get(), properties);
+			return;
+		}
+
+		const StyleParsedProperties &parsed = StyleParseCache::get(properties);
+		if (impl->values.empty())
+		{
+			impl = parsed.style;
+			StyleImpl::last_generation++;	// Make cascades compare their style generations again
+		}
+		else
+		{
+			detach();
+			parsed.apply(impl.get());
+		}
+	}
+
+	void Style::set_parse_cache_enabled(bool enable)
+	{
+		StyleParseCache::enabled() = enable;
+		if (!enable)
+			StyleParseCache::clear();
+	}
+
+	void Style::detach()
+	{
+		if (impl.use_count() > 1)
+			impl = std::make_shared<StyleImpl>(*impl);
+	}
+
+	unsigned int Style::generation() const
+	{
+		return impl->generation;
+	}
+
+	StyleGetValue Style::declared_value(const char *property_name) const
+	{
+		StylePropertyId id = StyleProperty::find_id(property_name);
+		return id != -1 ? declared_value(id) : StyleGetValue();
 	}
 
-	StyleGetValue Style::declared_value(const char *property_name_str) const
+	StyleGetValue Style::declared_value(StylePropertyId id) const
 	{
-		StyleString property_name = property_name_str;
-		const auto it = impl->prop_type.find(property_name);
-		if (it != impl->prop_type.end())
+		const StyleSetValue *value = impl->find_value(id);
+		if (value)
 		{
-			switch (it->second)
+			switch (value->type)
 			{
 				default:
 				case StyleValueType::undefined:
 					return StyleGetValue();
 				case StyleValueType::keyword:
-					return StyleGetValue::from_keyword(impl->prop_text.find(property_name)->second.c_str());
+					return StyleGetValue::from_keyword(value->text.c_str());
 				case StyleValueType::string:
-					return StyleGetValue::from_string(impl->prop_text.find(property_name)->second.c_str());
+					return StyleGetValue::from_string(value->text.c_str());
 				case StyleValueType::url:
-					return StyleGetValue::from_url(impl->prop_text.find(property_name)->second.c_str());
+					return StyleGetValue::from_url(value->text.c_str());
 				case StyleValueType::length:
-					return StyleGetValue::from_length(impl->prop_number.find(property_name)->second, impl->prop_dimension.find(property_name)->second);
+					return StyleGetValue::from_length(value->number, value->dimension);
 				case StyleValueType::angle:
-					return StyleGetValue::from_angle(impl->prop_number.find(property_name)->second, impl->prop_dimension.find(property_name)->second);
+					return StyleGetValue::from_angle(value->number, value->dimension);
 				case StyleValueType::time:
-					return StyleGetValue::from_time(impl->prop_number.find(property_name)->second, impl->prop_dimension.find(property_name)->second);
+					return StyleGetValue::from_time(value->number, value->dimension);
 				case StyleValueType::frequency:
-					return StyleGetValue::from_frequency(impl->prop_number.find(property_name)->second, impl->prop_dimension.find(property_name)->second);
+					return StyleGetValue::from_frequency(value->number, value->dimension);
 				case StyleValueType::resolution:
-					return StyleGetValue::from_resolution(impl->prop_number.find(property_name)->second, impl->prop_dimension.find(property_name)->second);
+					return StyleGetValue::from_resolution(value->number, value->dimension);
 				case StyleValueType::percentage:
-					return StyleGetValue::from_percentage(impl->prop_number.find(property_name)->second);
+					return StyleGetValue::from_percentage(value->number);
 				case StyleValueType::number:
-					return StyleGetValue::from_number(impl->prop_number.find(property_name)->second);
+					return StyleGetValue::from_number(value->number);
 				case StyleValueType::color:
-					return StyleGetValue::from_color(impl->prop_color.find(property_name)->second);
+					return StyleGetValue::from_color(value->color);
 			}
 		}
 		return StyleGetValue();
@@ -37,14 +37,21 @@
 #include "style_background_renderer.h"
 #include "style_border_image_renderer.h"
 #include "style_impl.h"
+#include <algorithm>
 
 namespace uicore
 {
 	StyleGetValue StyleCascade::cascade_value(const char *property_name) const
+	{
+		StylePropertyId id = StyleProperty::find_id(property_name);
+		return id != -1 ? cascade_value(id) : StyleGetValue();
+	}
+
+	StyleGetValue StyleCascade::cascade_value(StylePropertyId property_id) const
 	{
 		for (Style *style : cascade)
 		{
-			StyleGetValue value = style->declared_value(property_name);
+			StyleGetValue value = style->declared_value(property_id);
 			if (!value.is_undefined())
 				return value;
 		}
@@ -53,15 +60,21 @@ namespace uicore
 
 	StyleGetValue StyleCascade::specified_value(const char *property_name) const
 	{
-		StyleGetValue value = cascade_value(property_name);
-		bool inherit = (value.is_undefined() && StyleProperty::is_inherited(property_name)) || value.is_keyword("inherit");
+		StylePropertyId id = StyleProperty::find_id(property_name);
+		return id != -1 ? specified_value(id) : StyleGetValue();
+	}
+
+	StyleGetValue StyleCascade::specified_value(StylePropertyId property_id) const
+	{
+		StyleGetValue value = cascade_value(property_id);
+		bool inherit = (value.is_undefined() && StyleProperty::is_inherited(property_id)) || value.is_keyword("inherit");
 		if (inherit && parent)
 		{
-			return parent->computed_value(property_name);
+			return parent->computed_value(property_id);
 		}
 		else if (value.is_undefined() || value.is_keyword("initial") || value.is_keyword("inherit"))
 		{
-			return StyleProperty::default_value(property_name);
+			return StyleProperty::default_value(property_id);
 		}
 		else
 		{
@@ -70,10 +83,69 @@ namespace uicore
 	}
 
 	StyleGetValue StyleCascade::computed_value(const char *property_name) const
+	{
+		// Properties without an id have never been set or given a default value
+		StylePropertyId id = StyleProperty::find_id(property_name);
+		return id != -1 ? computed_value(id) : StyleGetValue();
+	}
+
+	StyleGetValue StyleCascade::computed_value(StylePropertyId property_id) const
+	{
+		validate_computed_values();
+
+		const StyleGetValue *cached_value = computed_cache.find(property_id);
+		if (cached_value)
+			return *cached_value;
+
+		StyleGetValue value = compute_value(property_id);
+		computed_cache.insert(property_id, value);
+		return value;
+	}
+
+	void StyleCascade::validate_computed_values() const
+	{
+		// Only compare the styles of the cascade and its ancestors when some style changed since the last check
+		if (!computed_cache.styles_recorded || computed_cache.checked_generation != StyleImpl::last_generation)
+		{
+			if (parent)
+				parent->validate_computed_values();
+
+			bool changed = computed_cache.style_generations.size() != cascade.size();
+			for (size_t i = 0; !changed && i < cascade.size(); i++)
+				changed = computed_cache.style_generations[i] != cascade[i]->generation();
+
+			if (changed)
+			{
+				if (computed_cache.styles_recorded)
+					invalidate_computed_values();
+
+				computed_cache.style_generations.resize(cascade.size());
+				for (size_t i = 0; i < cascade.size(); i++)
+					computed_cache.style_generations[i] = cascade[i]->generation();
+			}
+
+			computed_cache.styles_recorded = true;
+			computed_cache.checked_generation = StyleImpl::last_generation;
+		}
+
+		unsigned int parent_version = parent ? parent->computed_cache.version : 0;
+		if (computed_cache.parent_version != parent_version)
+		{
+			invalidate_computed_values();
+			computed_cache.parent_version = parent_version;
+		}
+	}
+
+	void StyleCascade::invalidate_computed_values() const
+	{
+		computed_cache.clear();
+	}
+
+	StyleGetValue StyleCascade::compute_value(StylePropertyId property_id) const
 	{
 		// To do: pass on to property compute functions
 
-		StyleGetValue specified = specified_value(property_name);
+		StyleGetValue specified = specified_value(property_id);
 		switch (specified.type())
 		{
 		case StyleValueType::length:
@@ -91,6 +163,12 @@ namespace uicore
 		}
 	}
 
+	StylePropertyId StyleCascade::font_size_id()
+	{
+		static StylePropertyId id = StyleProperty::id("font-size");
+		return id;
+	}
+
 	StyleGetValue StyleCascade::compute_length(const StyleGetValue &length) const
 	{
 		switch (length.dimension())
@@ -109,9 +187,9 @@ namespace uicore
 		case StyleDimension::pc:
 			return StyleGetValue::from_length(length.number() * (float)(12.0 * 96.0 / 72.0));
 		case StyleDimension::em:
-			return StyleGetValue::from_length(computed_value("font-size").number() * length.number());
+			return StyleGetValue::from_length(computed_value(font_size_id()).number() * length.number());
 		case StyleDimension::ex:
-			return StyleGetValue::from_length(computed_value("font-size").number() * length.number() * 0.5f);
+			return StyleGetValue::from_length(computed_value(font_size_id()).number() * length.number() * 0.5f);
 		}
 	}
 
@@ -233,18 +311,46 @@ namespace uicore
 
 	int StyleCascade::array_size(const char *property_name) const
 	{
+		StylePropertyId id = StyleProperty::find_id(property_name);
+		if (id == -1)
+			return 0;
+
 		int size = 0;
-		while (true)
-		{
-			StyleString prop_name;
-			prop_name.append(property_name);
-			prop_name.append("[");
-			prop_name.append(Text::to_string(size));
-			prop_name.append("]");
-			if (specified_value(prop_name).is_undefined())
-				break;
+		while (!specified_value(StyleProperty::array_id(id, size)).is_undefined())
 			size++;
-		}
 		return size;
 	}
+
+	const StyleGetValue *StyleComputedValueCache::find(StylePropertyId id) const
+	{
+		if (id < (StylePropertyId)slots.size() && slots[id] != 0)
+		{
+			const Entry &entry = entries[slots[id] - 1];
+			if (entry.version == version)
+				return &entry.value;
+		}
+		return nullptr;
+	}
+
+	void StyleComputedValueCache::insert(StylePropertyId id, const StyleGetValue &value)
+	{
+		if (id >= (StylePropertyId)slots.size())
+			slots.resize(id + 1);
+
+		if (slots[id] == 0)
+		{
+			entries.push_back(Entry());
+			slots[id] = (unsigned int)entries.size();
+		}
+
+		Entry &entry = entries[slots[id] - 1];
+		entry.value = value;
+		entry.version = version;
+	}
+
+	void StyleComputedValueCache::clear()
+	{
+		version++;
+		styles_recorded = false;
+	}
 }
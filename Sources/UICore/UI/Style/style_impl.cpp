@@ -33,86 +33,91 @@
 
 namespace uicore
 {
+	unsigned int StyleImpl::last_generation = 0;
+
 	void StyleImpl::set_value(const std::string &name, const StyleSetValue &value)
 	{
-		auto type_it = prop_type.find(name);
-		if (type_it != prop_type.end() && type_it->second != value.type)
+		set_value(StyleProperty::id(name), value);
+	}
+
+	void StyleImpl::set_value(StylePropertyId id, const StyleSetValue &value)
+	{
+		generation = ++last_generation;
+
+		if (id >= (StylePropertyId)value_index.size())
 		{
-			switch (type_it->second)
-			{
-			default:
-			case StyleValueType::undefined:
-				break;
-			case StyleValueType::keyword:
-			case StyleValueType::string:
-			case StyleValueType::url:
-				prop_text.erase(prop_text.find(name));
-				break;
-			case StyleValueType::length:
-			case StyleValueType::angle:
-			case StyleValueType::time:
-			case StyleValueType::frequency:
-			case StyleValueType::resolution:
-				prop_dimension.erase(prop_dimension.find(name));
-				prop_number.erase(prop_number.find(name));
-				break;
-			case StyleValueType::percentage:
-			case StyleValueType::number:
-				prop_number.erase(prop_number.find(name));
-				break;
-			case StyleValueType::color:
-				prop_color.erase(prop_color.find(name));
-				break;
-			}
+			if (value.is_undefined())
+				return;
+			value_index.resize(id + 1);
 		}
 
-		if (value.type != StyleValueType::undefined)
-			prop_type[name] = value.type;
-		else if (type_it != prop_type.end())
-			prop_type.erase(type_it);
-
-		switch (value.type)
+		if (value_index[id] != 0)
+		{
+			values[value_index[id] - 1] = value;
+		}
+		else if (!value.is_undefined())
 		{
-		default:
-		case StyleValueType::undefined:
-			break;
-		case StyleValueType::keyword:
-		case StyleValueType::string:
-		case StyleValueType::url:
-			prop_text[name] = value.text;
-			break;
-		case StyleValueType::length:
-		case StyleValueType::angle:
-		case StyleValueType::time:
-		case StyleValueType::frequency:
-		case StyleValueType::resolution:
-			prop_dimension[name] = value.dimension;
-			prop_number[name] = value.number;
-			break;
-		case StyleValueType::percentage:
-		case StyleValueType::number:
-			prop_number[name] = value.number;
-			break;
-		case StyleValueType::color:
-			prop_color[name] = value.color;
-			break;
+			values.push_back(value);
+			value_index[id] = (unsigned int)values.size();
 		}
 	}
 
 	void StyleImpl::set_value_array(const std::string &name, const std::vector<StyleSetValue> &value_array)
+	{
+		set_value_array(StyleProperty::id(name), value_array);
+	}
+
+	void StyleImpl::set_value_array(StylePropertyId id, const std::vector<StyleSetValue> &value_array)
 	{
 		for (size_t i = 0; i < value_array.size(); i++)
 		{
-			set_value(name + "[" + Text::to_string((int)i) + "]", value_array[i]);
+			set_value(StyleProperty::array_id(id, (int)i), value_array[i]);
 		}
 
 		size_t i = value_array.size();
 		while (true)
 		{
-			auto index_name = name + "[" + Text::to_string((int)i) + "]";
-			if (prop_type.find(index_name) == prop_type.end())
+			StylePropertyId element_id = StyleProperty::array_id(id, (int)i);
+			if (!find_value(element_id))
 				break;
-			set_value(index_name, StyleSetValue());
+			set_value(element_id, StyleSetValue());
+		}
+	}
+
+	/////////////////////////////////////////////////////////////////////////
+
+	StyleParsedProperties::StyleParsedProperties(const std::string &properties) : style(std::make_shared<StyleImpl>())
+	{
+		StyleProperty::parse(this, properties);
+		apply(style.get());
+	}
+
+	void StyleParsedProperties::set_value(const std::string &name, const StyleSetValue &value)
+	{
+		Declaration declaration;
+		declaration.id = StyleProperty::id(name);
+		declaration.is_array = false;
+		declaration.values.push_back(value);
+		declarations.push_back(std::move(declaration));
+	}
+
+	void StyleParsedProperties::set_value_array(const std::string &name, const std::vector<StyleSetValue> &value_array)
+	{
+		Declaration declaration;
+		declaration.id = StyleProperty::id(name);
+		declaration.is_array = true;
+		declaration.values = value_array;
+		declarations.push_back(std::move(declaration));
+	}
+
+	void StyleParsedProperties::apply(StyleImpl *target) const
+	{
+		for (const auto &declaration : declarations)
+		{
+			if (declaration.is_array)
+				target->set_value_array(declaration.id, declaration.values);
+			else
+				target->set_value(declaration.id, declaration.values.front());
 		}
 	}
 }
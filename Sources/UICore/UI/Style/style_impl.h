@@ -32,6 +32,7 @@
 #include <memory>
 #include <string>
 #include <unordered_map>
+#include <deque>
 
 namespace uicore
 {
@@ -144,10 +145,56 @@ namespace uicore
 		void set_value(const std::string &name, const StyleSetValue &value) override;
 		void set_value_array(const std::string &name, const std::vector<StyleSetValue> &value_array) override;
 
-		std::unordered_map<StyleString, StyleValueType, StyleString::hash> prop_type;
-		std::unordered_map<StyleString, std::string, StyleString::hash> prop_text;
-		std::unordered_map<StyleString, float, StyleString::hash> prop_number;
-		std::unordered_map<StyleString, StyleDimension, StyleString::hash> prop_dimension;
-		std::unordered_map<StyleString, Colorf, StyleString::hash> prop_color;
+		void set_value(StylePropertyId id, const StyleSetValue &value);
+		void set_value_array(StylePropertyId id, const std::vector<StyleSetValue> &value_array);
+
+		/// Value set for a property, or null if the property is not set
+		const StyleSetValue *find_value(StylePropertyId id) const
+		{
+			if (id >= 0 && id < (StylePropertyId)value_index.size() && value_index[id] != 0)
+			{
+				const StyleSetValue &value = values[value_index[id] - 1];
+				if (!value.is_undefined())
+					return &value;
+			}
+			return nullptr;
+		}
+
+		/// Index into values plus one for each property id, or zero if the property was never set
+		std::vector<unsigned int> value_index;
+
+		/// Property values. A deque keeps existing values in place when new ones are added.
+		std::deque<StyleSetValue> values;
+
+		/// Stamp of the last change to the values, taken from last_generation so that no two changes share a stamp
+		unsigned int generation = 0;
+
+		/// Stamp of the most recent change to any style
+		static unsigned int last_generation;
+	};
+
+	/// Property values recorded from a parsed properties string, so that the same string only has to be parsed once
+	class StyleParsedProperties : public StylePropertySetter
+	{
+	public:
+		StyleParsedProperties(const std::string &properties);
+
+		void set_value(const std::string &name, const StyleSetValue &value) override;
+		void set_value_array(const std::string &name, const std::vector<StyleSetValue> &value_array) override;
+
+		/// Sets the recorded values in the same order as the parser did
+		void apply(StyleImpl *style) const;
+
+		/// Style with only these properties set. Must not be modified as it is shared by every Style set from the same string.
+		std::shared_ptr<StyleImpl> style;
+
+	private:
+		struct Declaration
+		{
+			StylePropertyId id;
+			bool is_array;
+			std::vector<StyleSetValue> values;
+		};
+		std::vector<Declaration> declarations;
 	};
 }
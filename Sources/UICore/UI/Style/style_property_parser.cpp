@@ -34,14 +34,85 @@
 #include "style_impl.h"
 #include <unordered_map>
 #include <map>
+#include <deque>
 
 namespace uicore
 {
-	std::unordered_map<StyleString, std::pair<StyleGetValue, bool>, StyleString::hash> &style_defaults()
+	class StylePropertyRegistry
 	{
-		static std::unordered_map<StyleString, std::pair<StyleGetValue, bool>, StyleString::hash> defaults;
-		return defaults;
-	}
+	public:
+		static StylePropertyRegistry &instance()
+		{
+			static StylePropertyRegistry registry;
+			return registry;
+		}
+
+		StylePropertyId find(const char *name) const
+		{
+			std::size_t hash = hash_name(name);
+			std::size_t mask = table.size() - 1;
+			for (std::size_t i = hash & mask; table[i] != -1; i = (i + 1) & mask)
+			{
+				StylePropertyId id = table[i];
+				if (hashes[id] == hash && names[id] == name)
+					return id;
+			}
+			return -1;
+		}
+
+		StylePropertyId add(const char *name)
+		{
+			StylePropertyId id = find(name);
+			if (id != -1)
+				return id;
+
+			id = (StylePropertyId)names.size();
+			names.push_back(name);
+			hashes.push_back(hash_name(name));
+			defaults.push_back({ StyleGetValue(), false });
+			array_ids.push_back(std::vector<StylePropertyId>());
+
+			// Keep the load factor at or below 50%
+			if (names.size() * 2 > table.size())
+			{
+				table.assign(table.size() * 2, -1);
+				for (StylePropertyId i = 0; i < (StylePropertyId)names.size(); i++)
+					insert_table(i);
+			}
+			else
+			{
+				insert_table(id);
+			}
+			return id;
+		}
+
+		std::vector<std::string> names;
+		std::vector<std::size_t> hashes;
+		std::deque<std::pair<StyleGetValue, bool>> defaults;	// A deque keeps the references returned by default_value valid when properties are added
+		std::vector<std::vector<StylePropertyId>> array_ids;
+
+	private:
+		StylePropertyRegistry() : table(512, -1) { }
+
+		void insert_table(StylePropertyId id)
+		{
+			std::size_t mask = table.size() - 1;
+			std::size_t i = hashes[id] & mask;
+			while (table[i] != -1)
+				i = (i + 1) & mask;
+			table[i] = id;
+		}
+
+		static std::size_t hash_name(const char *name)
+		{
+			std::size_t hash = 2166136261U;
+			for (const char *c = name; *c; c++)
+				hash = (hash ^ static_cast<unsigned char>(*c)) * 16777619U;
+			return hash;
+		}
+
+		std::vector<StylePropertyId> table;
+	};
 
 	std::unordered_map<StyleString, StylePropertyParser *, StyleString::hash> &style_parsers()
 	{
@@ -53,7 +124,8 @@ namespace uicore
 
 	StylePropertyDefault::StylePropertyDefault(const std::string &name, const StyleGetValue &value, bool inherit)
 	{
-		style_defaults()[name] = { value, inherit };
+		auto &registry = StylePropertyRegistry::instance();
+		registry.defaults[registry.add(name.c_str())] = { value, inherit };
 	}
 
 	/////////////////////////////////////////////////////////////////////////
@@ -1062,25 +1134,57 @@ namespace uicore
 
 	/////////////////////////////////////////////////////////////////////////
 
-	bool StyleProperty::is_inherited(const char *name)
+	StylePropertyId StyleProperty::id(const char *name)
 	{
-		auto it = style_defaults().find(name);
-		if (it != style_defaults().end())
-		{
-			return it->second.second;
-		}
-		else
+		return StylePropertyRegistry::instance().add(name);
+	}
+
+	StylePropertyId StyleProperty::find_id(const char *name)
+	{
+		return StylePropertyRegistry::instance().find(name);
+	}
+
+	StylePropertyId StyleProperty::array_id(StylePropertyId id, int index)
+	{
+		auto &registry = StylePropertyRegistry::instance();
+		if (registry.array_ids[id].size() <= (size_t)index)
 		{
-			return false;
+			for (int i = (int)registry.array_ids[id].size(); i <= index; i++)
+			{
+				StylePropertyId element_id = registry.add((registry.names[id] + "[" + Text::to_string(i) + "]").c_str());
+				registry.array_ids[id].push_back(element_id);
+			}
 		}
+		return registry.array_ids[id][index];
+	}
+
+	const std::string &StyleProperty::name(StylePropertyId id)
+	{
+		return StylePropertyRegistry::instance().names[id];
+	}
+
+	int StyleProperty::id_count()
+	{
+		return (int)StylePropertyRegistry::instance().names.size();
+	}
+
+	bool StyleProperty::is_inherited(const char *name)
+	{
+		StylePropertyId id = find_id(name);
+		return id != -1 ? is_inherited(id) : false;
+	}
+
+	bool StyleProperty::is_inherited(StylePropertyId id)
+	{
+		return StylePropertyRegistry::instance().defaults[id].second;
 	}
 	
 	const StyleGetValue &StyleProperty::default_value(const char *name)
 	{
-		auto it = style_defaults().find(name);
-		if (it != style_defaults().end())
+		StylePropertyId id = find_id(name);
+		if (id != -1)
 		{
-			return it->second.first;
+			return default_value(id);
 		}
 		else
 		{
@@ -1089,6 +1193,11 @@ namespace uicore
 		}
 	}
 
+	const StyleGetValue &StyleProperty::default_value(StylePropertyId id)
+	{
+		return StylePropertyRegistry::instance().defaults[id].first;
+	}
+
 	void StyleProperty::parse(StylePropertySetter *setter, const std::string &properties)
 	{
 		StyleTokenizer tokenizer(properties);
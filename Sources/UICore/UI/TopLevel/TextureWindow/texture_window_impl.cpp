@@ -71,14 +71,23 @@ namespace uicore
 		if (needs_render || always_render)
 		{
 			canvas->set_clip(canvas_rect);
+			needs_render = false;
 
-			if (clear_background_enable)
+			if (clear_background_enable && !always_render)
 			{
-				canvas->clear(background_color);
+				// The canvas keeps the previous rendering, so only the damaged areas have to be rendered again
+				window_view->render_damage(canvas, canvas_rect, background_color);
+			}
+			else
+			{
+				if (clear_background_enable)
+				{
+					canvas->clear(background_color);
+				}
+
+				window_view->render(canvas, canvas_rect);
 			}
 
-			needs_render = false;
-			window_view->render(canvas, canvas_rect);
 			canvas->reset_clip();
 		}
 	}
@@ -30,8 +30,8 @@
 #include "UICore/UI/TopLevel/view_tree.h"
 #include "UICore/UI/Events/event.h"
 #include "UICore/UI/Events/focus_change_event.h"
+#include "UICore/Display/2D/canvas.h"
 #include "../View/view_impl.h"
-#include "../View/positioned_layout.h"
 #include <algorithm>
 
 namespace uicore
@@ -51,8 +51,57 @@ namespace uicore
 
 		View *focus_view = nullptr;
 		std::shared_ptr<View> root;
+
+		void add_damage(Rectf box);
+
+		/// Damaged rectangles in root view coordinates. Overlapping rectangles are merged.
+		std::vector<Rectf> damage;
+		bool full_damage = true;
+		enum { max_damage_rects = 8 };
+
+		bool incremental_layout = false;
+		bool retained_rendering = false;
+		int layout_view_count = 0;
+		int layout_subtree_count = 0;
+		int layout_cache_hits = 0;
+		int layout_cache_misses = 0;
 	};
 
+	void ViewTreeImpl::add_damage(Rectf box)
+	{
+		if (full_damage || box.width() <= 0.0f || box.height() <= 0.0f)
+			return;
+
+		while (true)
+		{
+			auto it = std::find_if(damage.begin(), damage.end(), [&](const Rectf &rect) { return rect.is_overlapped(box); });
+			if (it == damage.end() && damage.size() < max_damage_rects)
+				break;
+
+			if (it == damage.end())
+			{
+				// List is full. Merge with the rectangle that grows the least.
+				float best_growth = 0.0f;
+				for (auto cur = damage.begin(); cur != damage.end(); ++cur)
+				{
+					Rectf merged = *cur;
+					merged.bounding_rect(box);
+					float growth = merged.width() * merged.height() - cur->width() * cur->height();
+					if (it == damage.end() || growth < best_growth)
+					{
+						it = cur;
+						best_growth = growth;
+					}
+				}
+			}
+
+			box.bounding_rect(*it);
+			damage.erase(it);
+		}
+
+		damage.push_back(box);
+	}
+
 	ViewTree::ViewTree() : impl(new ViewTreeImpl)
 	{
 		set_root_view(std::make_shared<View>());
@@ -79,6 +128,57 @@ namespace uicore
 		impl->root = view;
 		if (impl->root)
 			impl->root->impl->view_tree = this;
+		add_full_damage();
+	}
+
+	bool ViewTree::retained_rendering() const
+	{
+		return impl->retained_rendering;
+	}
+
+	void ViewTree::set_retained_rendering(bool enable)
+	{
+		if (impl->retained_rendering != enable)
+		{
+			impl->retained_rendering = enable;
+			if (impl->root)
+				impl->root->set_needs_render();
+		}
+	}
+
+	bool ViewTree::incremental_layout() const
+	{
+		return impl->incremental_layout;
+	}
+
+	void ViewTree::set_incremental_layout(bool enable)
+	{
+		if (impl->incremental_layout != enable)
+		{
+			impl->incremental_layout = enable;
+			if (impl->root)
+				impl->root->set_needs_layout();
+		}
+	}
+
+	int ViewTree::layout_view_count() const
+	{
+		return impl->layout_view_count;
+	}
+
+	int ViewTree::layout_subtree_count() const
+	{
+		return impl->layout_subtree_count;
+	}
+
+	int ViewTree::layout_cache_hits() const
+	{
+		return impl->layout_cache_hits;
+	}
+
+	int ViewTree::layout_cache_misses() const
+	{
+		return impl->layout_cache_misses;
 	}
 
 	void ViewTree::set_focus_view(View *new_focus_view)
@@ -115,17 +215,68 @@ namespace uicore
 	void ViewTree::render(const CanvasPtr &canvas, const Rectf &margin_box)
 	{
 		View *view = impl->root.get();
+		layout(canvas, margin_box);
 
-		view->set_geometry(ViewGeometry::from_margin_box(view->style_cascade(), margin_box));
+		impl->damage.clear();
+		impl->full_damage = false;
 
-		if (view->needs_layout())
+		view->impl->render(view, canvas, impl->retained_rendering);
+	}
+
+	void ViewTree::render_damage(const CanvasPtr &canvas, const Rectf &margin_box, const Colorf &background)
+	{
+		View *view = impl->root.get();
+		layout(canvas, margin_box);
+
+		std::vector<Rectf> regions;
+		if (impl->full_damage)
+			regions.push_back(margin_box);
+		else
+			regions.swap(impl->damage);
+
+		impl->damage.clear();
+		impl->full_damage = false;
+
+		const Mat4f &transform = canvas->transform();
+		for (const Rectf &region : regions)
 		{
-			view->layout_children(canvas);
-			PositionedLayout::layout_children(canvas, view);
+			// Note: canvas cliprects are in absolute coordinates and can only clip AABB
+			Vec4f tl_point = transform * Vec4f(region.left, region.top, 0.0f, 1.0f);
+			Vec4f br_point = transform * Vec4f(region.right, region.bottom, 0.0f, 1.0f);
+			canvas->push_clip(Rectf(std::min(tl_point.x, br_point.x), std::min(tl_point.y, br_point.y), std::max(tl_point.x, br_point.x), std::max(tl_point.y, br_point.y)));
+			canvas->clear(background);
+			view->impl->render(view, canvas, impl->retained_rendering);
+			canvas->pop_clip();
 		}
-		view->impl->needs_layout = false;
+	}
+
+	void ViewTree::layout(const CanvasPtr &canvas, const Rectf &margin_box)
+	{
+		View *view = impl->root.get();
+
+		view->set_geometry(ViewGeometry::from_margin_box(view->style_cascade(), margin_box));
+
+		impl->layout_view_count = 0;
+		impl->layout_subtree_count = 0;
+		unsigned int cache_hits = ViewLayoutWidthCache::hits;
+		unsigned int cache_misses = ViewLayoutWidthCache::misses;
+		if (view->needs_layout())
+			ViewImpl::layout_subtree(view, canvas, impl->layout_view_count, impl->layout_subtree_count);
+		else if (view->impl->descendant_needs_layout)
+			ViewImpl::layout_dirty_descendants(view, canvas, impl->layout_view_count, impl->layout_subtree_count);
+		impl->layout_cache_hits = (int)(ViewLayoutWidthCache::hits - cache_hits);
+		impl->layout_cache_misses = (int)(ViewLayoutWidthCache::misses - cache_misses);
+	}
 
-		view->impl->render(view, canvas);
+	void ViewTree::add_damage(const Rectf &box)
+	{
+		impl->add_damage(box);
+	}
+
+	void ViewTree::add_full_damage()
+	{
+		impl->full_damage = true;
+		impl->damage.clear();
 	}
 
 	void ViewTree::dispatch_activation_change(ActivationChangeType type)
@@ -36,6 +36,8 @@
 #include "UICore/Core/ErrorReporting/exception_dialog.h"
 #include "UICore/Core/IOData/path_help.h"
 #include "UICore/Core/IOData/directory.h"
+#include "UICore/Core/Zip/zip_archive.h"
+#include "UICore/Core/Text/text.h"
 #include "UICore/UI/Style/style.h"
 #include <map>
 
@@ -57,6 +59,7 @@ namespace uicore
 		}
 
 		std::string resource_path;
+		ZipArchivePtr resource_archive;
 		std::function<void(const std::exception_ptr &)> exception_handler;
 
 		std::map<std::string, FontFamilyPtr> font_families;
@@ -119,7 +122,21 @@ namespace uicore
 
 	void UIThread::set_resource_path(const std::string &path)
 	{
-		UIThreadImpl::instance()->resource_path = path;
+		auto impl = UIThreadImpl::instance();
+		if (impl->resource_archive)
+		{
+			ZipArchive::unmount(impl->resource_path);
+			impl->resource_archive.reset();
+		}
+
+		// Resources can be packed into a single zip file to avoid opening each file separately
+		if (Text::to_lower(FilePath::extension(path)) == "zip")
+		{
+			impl->resource_archive = ZipArchive::open(path);
+			ZipArchive::mount(path, impl->resource_archive);
+		}
+
+		impl->resource_path = path;
 	}
 
 	ImagePtr UIThread::image(const CanvasPtr &canvas, const std::string &name)
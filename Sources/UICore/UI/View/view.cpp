@@ -42,13 +42,16 @@
 #include "UICore/Display/2D/path.h"
 #include "UICore/Display/2D/pen.h"
 #include "UICore/Display/2D/brush.h"
+#include "UICore/UI/Style/style_property_parser.h"
 #include "UICore/Core/Text/text.h"
 #include "view_impl.h"
 #include "view_action_impl.h"
 #include "flex_layout.h"
 #include "custom_layout.h"
+#include "positioned_layout.h"
 #include <algorithm>
 #include <set>
+#include <unordered_map>
 
 namespace uicore
 {
@@ -84,54 +87,130 @@ namespace uicore
 
 		auto &style = impl->styles[state];
 		style = std::make_shared<Style>();
+
+		// The selector is split into state bits once so that matching is a mask test
+		ViewStyleSelector selector;
+		selector.style = style.get();
+		for (const auto &state_name : Text::split(state, " "))
+		{
+			selector.states.set(ViewStateBits::index(state_name), true);
+			selector.state_count++;
+		}
+		impl->style_selectors.push_back(selector);
+
 		impl->update_style_cascade();
 		return style;
 	}
 
 	bool View::state(const std::string &name) const
 	{
-		const auto it = impl->states.find(name);
-		if (it != impl->states.end())
-			return it->second.enabled;
-		else
-			return false;
+		int index = ViewStateBits::find_index(name);
+		return index != -1 && impl->states.test(index);
 	}
 	
 	void View::set_state(const std::string &name, bool value)
 	{
-		if (impl->states[name].enabled != value)
+		int index = ViewStateBits::index(name);
+		if (impl->states.test(index) != value)
 		{
-			impl->states[name] = ViewImpl::StyleState(false, value);
+			impl->states.set(index, value);
+			impl->explicit_states.set(index, true);
 			impl->update_style_cascade();
 			set_needs_layout();
 		}
 	}
 	void View::set_state_cascade(const std::string &name, bool value)
 	{
-		if (impl->states[name].enabled != value)
+		int index = ViewStateBits::index(name);
+		if (impl->states.test(index) != value)
 		{
-			impl->states[name] = ViewImpl::StyleState(false, value);
+			impl->states.set(index, value);
+			impl->explicit_states.set(index, true);
 			impl->update_style_cascade();
 			set_needs_layout();
-			impl->set_state_cascade_siblings(name, value);
+			impl->set_state_cascade_siblings(index, value);
 		}
 	}
 
-	void ViewImpl::set_state_cascade_siblings(const std::string &name, bool value)
+	void ViewImpl::set_state_cascade_siblings(int state_index, bool value)
 	{
 		for (auto view = _first_child; view != nullptr; view = view->next_sibling())
 		{
 			ViewImpl *impl = view->impl.get();
-			if (impl->states[name].inherited)
+			if (!impl->explicit_states.test(state_index))
 			{
-				impl->states[name] = ViewImpl::StyleState(true, value);
-				impl->update_style_cascade();
-				view->set_needs_layout();
-				impl->set_state_cascade_siblings(name, value);
+				if (impl->states.test(state_index) != value)
+				{
+					impl->states.set(state_index, value);
+					impl->update_style_cascade();
+					view->set_needs_layout();
+				}
+				impl->set_state_cascade_siblings(state_index, value);
 			}
 		}
 	}
 
+	void ViewStateBits::set(int index, bool value)
+	{
+		uint64_t *word = &bits;
+		if (index >= 64)
+		{
+			size_t overflow_word = (index - 64) / 64;
+			if (overflow_word >= overflow.size())
+			{
+				if (!value)
+					return;
+				overflow.resize(overflow_word + 1);
+			}
+			word = &overflow[overflow_word];
+		}
+
+		uint64_t mask = 1ULL << (index % 64);
+		if (value)
+			*word |= mask;
+		else
+			*word &= ~mask;
+	}
+
+	bool ViewStateBits::contains(const ViewStateBits &subset) const
+	{
+		if ((subset.bits & ~bits) != 0)
+			return false;
+
+		for (size_t i = 0; i < subset.overflow.size(); i++)
+		{
+			uint64_t word = i < overflow.size() ? overflow[i] : 0;
+			if ((subset.overflow[i] & ~word) != 0)
+				return false;
+		}
+		return true;
+	}
+
+	static std::unordered_map<std::string, int> &view_state_indexes()
+	{
+		static std::unordered_map<std::string, int> indexes;
+		return indexes;
+	}
+
+	int ViewStateBits::index(const std::string &state_name)
+	{
+		auto &indexes = view_state_indexes();
+		auto it = indexes.find(state_name);
+		if (it != indexes.end())
+			return it->second;
+
+		int index = (int)indexes.size();
+		indexes[state_name] = index;
+		return index;
+	}
+
+	int ViewStateBits::find_index(const std::string &state_name)
+	{
+		auto &indexes = view_state_indexes();
+		auto it = indexes.find(state_name);
+		return it != indexes.end() ? it->second : -1;
+	}
+
 	View *View::parent() const
 	{
 		return impl->_parent;
@@ -181,6 +260,7 @@ namespace uicore
 			impl->_first_child = new_child;
 
 		new_child->impl->_parent = this;
+		impl->hit_grid.dirty = true;
 		new_child->impl->update_style_cascade();
 		new_child->set_needs_layout();
 		set_needs_layout();
@@ -226,6 +306,7 @@ namespace uicore
 		}
 		
 		new_child->impl->_parent = this;
+		impl->hit_grid.dirty = true;
 		new_child->impl->update_style_cascade();
 		new_child->set_needs_layout();
 		set_needs_layout();
@@ -262,6 +343,7 @@ namespace uicore
 		old_child->impl->_prev_sibling.reset();
 		old_child->impl->_next_sibling.reset();
 		
+		impl->_parent->impl->hit_grid.dirty = true;
 		old_child->impl->_parent = nullptr;
 		
 		child_removed(old_child);
@@ -311,13 +393,75 @@ namespace uicore
 		impl->needs_layout = true;
 		impl->layout_cache.clear();
 
+		// Content setters only ask for a layout. The old content must not be replayed even if the geometry stays the same
+		impl->background_display_list.clear();
+		impl->content_display_list.clear();
+
 		View *super = parent();
 		if (super)
-			super->set_needs_layout();
+			super->impl->child_needs_layout(super);
 		else
 			set_needs_render();
 	}
 
+	void ViewImpl::child_needs_layout(View *self)
+	{
+		// Check the mode first, as is_layout_boundary has to compute style values
+		const ViewTree *tree = self->view_tree();
+		if (!tree || !tree->incremental_layout() || !is_layout_boundary(self))
+		{
+			self->set_needs_layout();
+			return;
+		}
+
+		// The size of a boundary does not depend on its content, so ancestors only need to find their way down to it
+		needs_layout = true;
+		layout_cache.clear();
+		for (View *ancestor = _parent; ancestor != nullptr; ancestor = ancestor->parent())
+			ancestor->impl->descendant_needs_layout = true;
+		add_damage(self);
+	}
+
+	bool ViewImpl::is_layout_boundary(View *self)
+	{
+		static StylePropertyId width_id = StyleProperty::id("width");
+		static StylePropertyId height_id = StyleProperty::id("height");
+		const StyleCascade &style = self->style_cascade();
+		return self->parent() && style.computed_value(width_id).is_length() && style.computed_value(height_id).is_length();
+	}
+
+	unsigned int ViewLayoutWidthCache::hits = 0;
+	unsigned int ViewLayoutWidthCache::misses = 0;
+
+	void ViewImpl::layout_subtree(View *self, const CanvasPtr &canvas, int &view_count, int &subtree_count)
+	{
+		self->layout_children(canvas);
+		PositionedLayout::layout_children(canvas, self);
+		subtree_count++;
+		clear_needs_layout(self, view_count);
+	}
+
+	void ViewImpl::layout_dirty_descendants(View *self, const CanvasPtr &canvas, int &view_count, int &subtree_count)
+	{
+		for (auto view = self->impl->_first_child; view != nullptr; view = view->next_sibling())
+		{
+			if (view->impl->needs_layout)
+				layout_subtree(view.get(), canvas, view_count, subtree_count);
+			else if (view->impl->descendant_needs_layout)
+				layout_dirty_descendants(view.get(), canvas, view_count, subtree_count);
+		}
+		self->impl->descendant_needs_layout = false;
+	}
+
+	void ViewImpl::clear_needs_layout(View *self, int &view_count)
+	{
+		self->impl->needs_layout = false;
+		self->impl->descendant_needs_layout = false;
+		view_count++;
+		for (auto view = self->impl->_first_child; view != nullptr; view = view->next_sibling())
+			clear_needs_layout(view.get(), view_count);
+	}
+
 	CanvasPtr View::canvas() const
 	{
 		const ViewTree *tree = view_tree();
@@ -329,9 +473,108 @@ namespace uicore
 
 	void View::set_needs_render()
 	{
-		ViewTree *tree = view_tree();
+		impl->background_display_list.clear();
+		impl->content_display_list.clear();
+		impl->add_damage(this);
+	}
+
+	void ViewImpl::add_damage(View *self)
+	{
+		ViewTree *tree = self->view_tree();
 		if (tree)
+		{
+			if (_parent)
+				tree->add_damage(render_box(self));
+			else
+				tree->add_full_damage();
 			tree->set_needs_render();
+		}
+	}
+
+	Rectf ViewImpl::render_box(View *self)
+	{
+		Rectf box = local_render_box(self);
+		Mat4f transform = self->parent() ? content_transform(self->parent()) : Mat4f::identity();
+
+		// Note: this code isn't correct for rotated transforms (AABB of two corners, same as in render)
+		Vec4f tl_point = transform * Vec4f(box.left, box.top, 0.0f, 1.0f);
+		Vec4f br_point = transform * Vec4f(box.right, box.bottom, 0.0f, 1.0f);
+		return Rectf(std::min(tl_point.x, br_point.x), std::min(tl_point.y, br_point.y), std::max(tl_point.x, br_point.x), std::max(tl_point.y, br_point.y));
+	}
+
+	Rectf ViewImpl::local_render_box(View *self) const
+	{
+		static StylePropertyId offset_x_id = StyleProperty::id("box-shadow-horizontal-offset");
+		static StylePropertyId offset_y_id = StyleProperty::id("box-shadow-vertical-offset");
+		static StylePropertyId blur_radius_id = StyleProperty::id("box-shadow-blur-radius");
+
+		Rectf box = _geometry.border_box();
+
+		// Box shadows are drawn outside the border box
+		float shadow_extent = 0.0f;
+		int num_shadows = style_cascade.array_size("box-shadow-style");
+		for (int index = 0; index < num_shadows; index++)
+		{
+			float offset_x = style_cascade.computed_value(StyleProperty::array_id(offset_x_id, index)).number();
+			float offset_y = style_cascade.computed_value(StyleProperty::array_id(offset_y_id, index)).number();
+			float blur_radius = style_cascade.computed_value(StyleProperty::array_id(blur_radius_id, index)).number();
+			shadow_extent = std::max(shadow_extent, std::abs(offset_x) + std::abs(offset_y) + blur_radius);
+		}
+		box.expand(shadow_extent);
+		return box;
+	}
+
+	Mat4f ViewImpl::content_transform(View *view)
+	{
+		// Same transforms as used by render() for the content boxes
+		Mat4f transform = Mat4f::identity();
+		for (; view != nullptr; view = view->parent())
+		{
+			Pointf translate = view->geometry().content_pos();
+			transform = Mat4f::translate(translate.x, translate.y, 0) * view->view_transform() * transform;
+		}
+		return transform;
+	}
+
+	void ViewImpl::add_children_damage(View *self)
+	{
+		ViewTree *tree = self->view_tree();
+		if (!tree)
+			return;
+
+		if (_parent)
+		{
+			Rectf box;
+			add_subtree_box(self, content_transform(self), box);
+			tree->add_damage(box);
+		}
+		else
+		{
+			tree->add_full_damage();
+		}
+		tree->set_needs_render();
+	}
+
+	void ViewImpl::add_subtree_box(View *view, const Mat4f &parent_transform, Rectf &box)
+	{
+		for (auto child = view->impl->_first_child; child != nullptr; child = child->next_sibling())
+		{
+			if (child->hidden())
+				continue;
+
+			// Note: this code isn't correct for rotated transforms (AABB of two corners, same as in render)
+			Rectf child_box = child->impl->local_render_box(child.get());
+			Vec4f tl_point = parent_transform * Vec4f(child_box.left, child_box.top, 0.0f, 1.0f);
+			Vec4f br_point = parent_transform * Vec4f(child_box.right, child_box.bottom, 0.0f, 1.0f);
+			Rectf transformed(std::min(tl_point.x, br_point.x), std::min(tl_point.y, br_point.y), std::max(tl_point.x, br_point.x), std::max(tl_point.y, br_point.y));
+			if (box.width() <= 0.0f || box.height() <= 0.0f)
+				box = transformed;
+			else
+				box.bounding_rect(transformed);
+
+			Pointf translate = child->geometry().content_pos();
+			add_subtree_box(child.get(), parent_transform * Mat4f::translate(translate.x, translate.y, 0) * child->view_transform(), box);
+		}
 	}
 
 	const ViewGeometry &View::geometry() const
@@ -341,11 +584,25 @@ namespace uicore
 
 	void View::set_geometry(const ViewGeometry &geometry)
 	{
-		if (impl->_geometry.content_box() != geometry.content_box())
-		{
-			impl->_geometry = geometry;
+		bool content_changed = impl->_geometry.content_box() != geometry.content_box();
+		bool border_changed = impl->_geometry.border_box() != geometry.border_box();
+		if (!content_changed && !border_changed)
+			return;
+
+		// The old area needs repainting too when the box shrinks or moves
+		if (border_changed)
+			impl->add_damage(this);
+
+		impl->_geometry = geometry;
+
+		// The parent hit grid buckets children by their border box
+		if (border_changed && impl->_parent)
+			impl->_parent->impl->hit_grid.dirty = true;
+
+		if (content_changed)
 			set_needs_layout();
-		}
+		else
+			set_needs_render();
 	}
 
 	void View::set_margin_geometry(const Rectf &margin_box)
@@ -374,8 +631,12 @@ namespace uicore
 
 	void View::set_view_transform(const Mat4f &transform)
 	{
+		// The transform only moves the descendants, so their areas before and after the change are damaged
+		impl->add_children_damage(this);
 		impl->view_transform = transform;
-		set_needs_render();
+		impl->identity_view_transform = transform == Mat4f::identity();
+		impl->inverse_view_transform = impl->identity_view_transform ? transform : Mat4f::inverse(transform);
+		impl->add_children_damage(this);
 	}
 
 	bool View::content_clipped() const
@@ -388,7 +649,7 @@ namespace uicore
 		if (impl->content_clipped != clipped)
 		{
 			impl->content_clipped = clipped;
-			set_needs_render();
+			impl->add_damage(this);
 		}
 	}
 
@@ -472,34 +733,34 @@ namespace uicore
 
 	float View::preferred_height(const CanvasPtr &canvas, float width)
 	{
-		auto it = impl->layout_cache.preferred_height.find(width);
-		if (it != impl->layout_cache.preferred_height.end())
-			return it->second;
+		float height = 0.0f;
+		if (impl->layout_cache.preferred_height.find(width, height))
+			return height;
 
-		float height = calculate_preferred_height(canvas, width);
-		impl->layout_cache.preferred_height[width] = height;
+		height = calculate_preferred_height(canvas, width);
+		impl->layout_cache.preferred_height.insert(width, height);
 		return height;
 	}
 
 	float View::first_baseline_offset(const CanvasPtr &canvas, float width)
 	{
-		auto it = impl->layout_cache.first_baseline_offset.find(width);
-		if (it != impl->layout_cache.first_baseline_offset.end())
-			return it->second;
+		float baseline_offset = 0.0f;
+		if (impl->layout_cache.first_baseline_offset.find(width, baseline_offset))
+			return baseline_offset;
 
-		float baseline_offset = calculate_first_baseline_offset(canvas, width);
-		impl->layout_cache.first_baseline_offset[width] = baseline_offset;
+		baseline_offset = calculate_first_baseline_offset(canvas, width);
+		impl->layout_cache.first_baseline_offset.insert(width, baseline_offset);
 		return baseline_offset;
 	}
 
 	float View::last_baseline_offset(const CanvasPtr &canvas, float width)
 	{
-		auto it = impl->layout_cache.last_baseline_offset.find(width);
-		if (it != impl->layout_cache.last_baseline_offset.end())
-			return it->second;
+		float baseline_offset = 0.0f;
+		if (impl->layout_cache.last_baseline_offset.find(width, baseline_offset))
+			return baseline_offset;
 
-		float baseline_offset = calculate_last_baseline_offset(canvas, width);
-		impl->layout_cache.last_baseline_offset[width] = baseline_offset;
+		baseline_offset = calculate_last_baseline_offset(canvas, width);
+		impl->layout_cache.last_baseline_offset.insert(width, baseline_offset);
 		return baseline_offset;
 	}
 
@@ -597,22 +858,137 @@ namespace uicore
 
 	std::shared_ptr<View> View::find_view_at(const Pointf &pos) const
 	{
-		// Search the children in reverse order, as we want to search the view that was "last drawn" first
-		for (auto child = last_child(); child != nullptr; child = child->previous_sibling())
+		View *child = nullptr;
+		if (impl->indexed_hit_testing)
 		{
+			child = impl->hit_grid.find(this, pos);
+		}
+		else
+		{
+			// Search the children in reverse order, as we want to search the view that was "last drawn" first
+			for (View *view = impl->_last_child.get(); view != nullptr; view = view->impl->_prev_sibling.lock().get())
+			{
+				if (view->geometry().border_box().contains(pos) && !view->hidden())
+				{
+					child = view;
+					break;
+				}
+			}
+		}
+
+		if (!child)
+			return std::shared_ptr<View>();
+
+		Pointf child_content_pos(pos.x - child->geometry().content_x, pos.y - child->geometry().content_y);
+		if (!child->impl->identity_view_transform)
+			child_content_pos = Vec2f(child->impl->inverse_view_transform * Vec4f(child_content_pos, 0.0f, 1.0f));
+
+		std::shared_ptr<View> view = child->find_view_at(child_content_pos);
+		if (view)
+			return view;
+		else
+			return child->shared_from_this();
+	}
+
+	bool View::indexed_hit_testing() const
+	{
+		return impl->indexed_hit_testing;
+	}
+
+	void View::set_indexed_hit_testing(bool enable)
+	{
+		impl->indexed_hit_testing = enable;
+		impl->hit_grid = ViewHitGrid();
+	}
+
+	View *ViewHitGrid::find(const View *container, const Pointf &pos)
+	{
+		if (dirty)
+			build(container);
+
+		int column, row;
+		if (!cell_at(pos, column, row))
+			return nullptr;
+
+		int cell = row * columns + column;
+		for (int i = cell_start[cell + 1]; i > cell_start[cell]; i--)
+		{
+			View *child = children[cell_items[i - 1]];
 			if (child->geometry().border_box().contains(pos) && !child->hidden())
+				return child;
+		}
+		return nullptr;
+	}
+
+	void ViewHitGrid::build(const View *container)
+	{
+		dirty = false;
+		children.clear();
+		cell_start.clear();
+		cell_items.clear();
+		columns = 0;
+		rows = 0;
+
+		for (auto child = container->first_child(); child != nullptr; child = child->next_sibling())
+		{
+			Rectf box = child->geometry().border_box();
+			bounds = children.empty() ? box : Rectf(std::min(bounds.left, box.left), std::min(bounds.top, box.top), std::max(bounds.right, box.right), std::max(bounds.bottom, box.bottom));
+			children.push_back(child.get());
+		}
+
+		if (children.empty() || bounds.width() <= 0.0f || bounds.height() <= 0.0f)
+			return;
+
+		// Aim for roughly one child per cell
+		float cells = (float)children.size();
+		columns = clamp((int)std::ceil(std::sqrt(cells * bounds.width() / bounds.height())), 1, 1024);
+		rows = clamp((int)std::ceil(cells / columns), 1, 1024);
+		cell_width = bounds.width() / columns;
+		cell_height = bounds.height() / rows;
+
+		// Count the children per cell, then fill the cells in z-order
+		cell_start.assign(columns * rows + 1, 0);
+		for (int pass = 0; pass < 2; pass++)
+		{
+			std::vector<int> fill_pos;
+			if (pass == 1)
 			{
-				Pointf child_content_pos(pos.x - child->geometry().content_x, pos.y - child->geometry().content_y);
-				child_content_pos = Vec2f(Mat4f::inverse(child->view_transform()) * Vec4f(child_content_pos, 0.0f, 1.0f));
-				std::shared_ptr<View> view = child->find_view_at(child_content_pos);
-				if (view)
-					return view;
-				else
-					return child;
+				for (size_t i = 1; i < cell_start.size(); i++)
+					cell_start[i] += cell_start[i - 1];
+				cell_items.resize(cell_start.back());
+				fill_pos.assign(cell_start.begin(), cell_start.end() - 1);
+			}
+
+			for (size_t index = 0; index < children.size(); index++)
+			{
+				Rectf box = children[index]->geometry().border_box();
+				int column0, row0, column1, row1;
+				if (box.width() <= 0.0f || box.height() <= 0.0f || !cell_at(box.top_left(), column0, row0) || !cell_at(box.bottom_right(), column1, row1))
+					continue;
+
+				for (int row = row0; row <= row1; row++)
+				{
+					for (int column = column0; column <= column1; column++)
+					{
+						int cell = row * columns + column;
+						if (pass == 0)
+							cell_start[cell + 1]++;
+						else
+							cell_items[fill_pos[cell]++] = (int)index;
+					}
+				}
 			}
 		}
+	}
+
+	bool ViewHitGrid::cell_at(const Pointf &pos, int &column, int &row) const
+	{
+		if (columns == 0 || pos.x < bounds.left || pos.x > bounds.right || pos.y < bounds.top || pos.y > bounds.bottom)
+			return false;
 
-		return std::shared_ptr<View>();
+		column = clamp((int)std::floor((pos.x - bounds.left) / cell_width), 0, columns - 1);
+		row = clamp((int)std::floor((pos.y - bounds.top) / cell_height), 0, rows - 1);
+		return true;
 	}
 
 	bool View::has_ancestor(const View *ancestor_view) const
@@ -825,11 +1201,47 @@ namespace uicore
 		if (e == nullptr)
 			e = &simple_event;
 
-		View *target = this;
+		if (!view_tree())
+			return;
 
-		if (!target->view_tree())
+		ViewImpl::dispatch_event(this, e, nullptr, no_propagation);
+	}
+
+	void View::dispatch_event(EventUI *e, const View *until_parent_view)
+	{
+		EventUI simple_event;
+		if (e == nullptr)
+			e = &simple_event;
+
+		if (this == until_parent_view)
+			return;
+
+		if (!view_tree())
 			return;
 
+		ViewImpl::dispatch_event(this, e, until_parent_view, false);
+	}
+
+	ViewEventPath::ViewEventPath(View *target, const View *until_parent_view)
+	{
+		for (View *view = target; view != nullptr && view != until_parent_view; view = view->parent())
+		{
+			if (count < inline_capacity)
+			{
+				inline_views[count] = view->shared_from_this();
+			}
+			else
+			{
+				if (count == inline_capacity)
+					overflow.assign(inline_views, inline_views + inline_capacity);
+				overflow.push_back(view->shared_from_this());
+			}
+			count++;
+		}
+	}
+
+	void ViewImpl::dispatch_event(View *target, EventUI *e, const View *until_parent_view, bool no_propagation)
+	{
 		// Make sure root view is not destroyed during event dispatching (needed for dismiss_popup)
 		auto pin_root = target->view_tree()->root_view();
 
@@ -839,27 +1251,39 @@ namespace uicore
 		{
 			e->_phase = EventUIPhase::at_target;
 			e->_current_target = e->_target;
-			e->_current_target->impl->process_event(e->_current_target.get(), e, true);
+			target->impl->process_event(target, e, true);
 			if (!e->propagation_stopped())
-				e->_current_target->impl->process_event(e->_current_target.get(), e, false);
+				target->impl->process_event(target, e, false);
 		}
 		else
 		{
-			target->impl->inverse_bubble(e, nullptr);
+			ViewEventPath path(target, until_parent_view);
+
+			for (size_t i = path.size() - 1; i > 0 && !e->propagation_stopped(); i--)
+			{
+				e->_phase = EventUIPhase::capturing;
+				e->_current_target = path[i];
+				path[i]->impl->process_event(path[i].get(), e, true);
+			}
 
 			if (!e->propagation_stopped())
 			{
 				e->_phase = EventUIPhase::at_target;
 				e->_current_target = e->_target;
-				e->_current_target->impl->process_event(e->_current_target.get(), e, true);
+				target->impl->process_event(target, e, true);
 				if (!e->propagation_stopped())
-					e->_current_target->impl->process_event(e->_current_target.get(), e, false);
+					target->impl->process_event(target, e, false);
 
-				while (e->_current_target->parent() && !e->propagation_stopped())
+				// Bubble through the current parents, as event handlers may have changed the tree
+				while (!e->propagation_stopped())
 				{
+					View *view = e->_current_target->parent();
+					if (view == nullptr || view == until_parent_view)
+						break;
+
 					e->_phase = EventUIPhase::bubbling;
-					e->_current_target = e->_current_target->parent()->shared_from_this();
-					e->_current_target->impl->process_event(e->_current_target.get(), e, false);
+					e->_current_target = view->shared_from_this();
+					view->impl->process_event(view, e, false);
 				}
 			}
 		}
@@ -868,47 +1292,6 @@ namespace uicore
 		e->_phase = EventUIPhase::none;
 	}
 
-	void View::dispatch_event(EventUI *e, const View *until_parent_view)
-	{
-		EventUI simple_event;
-		if (e == nullptr)
-			e = &simple_event;
-
-		View *target = this;
-
-		if (target == until_parent_view)
-			return;
-
-		if (!target->view_tree())
-			return;
-
-		// Make sure root view is not destroyed during event dispatching (needed for dismiss_popup)
-		auto pin_root = target->view_tree()->root_view();
-
-		e->_target = target->shared_from_this();
-
-		target->impl->inverse_bubble(e, until_parent_view);
-
-		if (!e->propagation_stopped())
-		{
-			e->_phase = EventUIPhase::at_target;
-			e->_current_target = e->_target;
-			e->_current_target->impl->process_event(e->_current_target.get(), e, true);
-			if (!e->propagation_stopped())
-				e->_current_target->impl->process_event(e->_current_target.get(), e, false);
-
-			while (e->_current_target->parent() && e->_current_target->parent() != until_parent_view && !e->propagation_stopped())
-			{
-				e->_phase = EventUIPhase::bubbling;
-				e->_current_target = e->_current_target->parent()->shared_from_this();
-				e->_current_target->impl->process_event(e->_current_target.get(), e, false);
-			}
-		}
-
-		e->_current_target.reset();
-		e->_phase = EventUIPhase::none;
-	}
-
 	View *View::common_parent(View *view1, View *view2)
 	{
 		std::set<View *> parents;
@@ -1012,13 +1395,38 @@ namespace uicore
 		}
 	}
 
-	void ViewImpl::render(View *self, const CanvasPtr &canvas)
+	bool ViewImpl::is_same_size(const ViewGeometry &a, const ViewGeometry &b)
 	{
-		style_cascade.render_background(canvas, _geometry);
-		style_cascade.render_border(canvas, _geometry);
+		return
+			a.content_width == b.content_width && a.content_height == b.content_height &&
+			a.padding_left == b.padding_left && a.padding_top == b.padding_top && a.padding_right == b.padding_right && a.padding_bottom == b.padding_bottom &&
+			a.border_left == b.border_left && a.border_top == b.border_top && a.border_right == b.border_right && a.border_bottom == b.border_bottom;
+	}
 
+	void ViewImpl::render(View *self, const CanvasPtr &canvas, bool retained)
+	{
 		Mat4f old_transform = canvas->transform();
 		Pointf translate = _geometry.content_pos();
+
+		// Display lists can be reused when the view moved, but not when its size changed
+		bool replay = retained && is_same_size(display_list_geometry, _geometry);
+		display_list_geometry = _geometry;
+
+		Mat4f background_origin = old_transform * Mat4f::translate(translate.x, translate.y, 0);
+		if (replay && background_display_list.can_replay(canvas, background_origin))
+		{
+			background_display_list.replay(canvas, background_origin);
+		}
+		else
+		{
+			if (retained)
+				background_display_list.begin_record(canvas, background_origin);
+			style_cascade.render_background(canvas, _geometry);
+			style_cascade.render_border(canvas, _geometry);
+			if (retained)
+				background_display_list.end_record(canvas);
+		}
+
 		canvas->set_transform(old_transform * Mat4f::translate(translate.x, translate.y, 0) * view_transform);
 
 		bool clipped = content_clipped;
@@ -1033,14 +1441,29 @@ namespace uicore
 
 		if (!self->render_exception_encountered())
 		{
-			bool success = UIThread::try_catch([&]
+			Mat4f content_origin = canvas->transform();
+			if (replay && content_display_list.can_replay(canvas, content_origin))
 			{
-				self->render_content(canvas);
-			});
-
-			if (!success)
+				content_display_list.replay(canvas, content_origin);
+			}
+			else
 			{
-				exception_encountered = true;
+				if (retained)
+					content_display_list.begin_record(canvas, content_origin);
+
+				bool success = UIThread::try_catch([&]
+				{
+					self->render_content(canvas);
+				});
+
+				if (retained)
+					content_display_list.end_record(canvas);
+
+				if (!success)
+				{
+					exception_encountered = true;
+					content_display_list.clear();
+				}
 			}
 		}
 
@@ -1064,7 +1487,7 @@ namespace uicore
 				Rectf transformed_border_box(std::min(tl_point.x, br_point.x), std::min(tl_point.y, br_point.y), std::max(tl_point.x, br_point.x), std::max(tl_point.y, br_point.y));
 				if (clip_box.is_overlapped(transformed_border_box))
 				{
-					view->impl->render(view.get(), canvas);
+					view->impl->render(view.get(), canvas, retained);
 				}
 			}
 		}
@@ -1078,24 +1501,12 @@ namespace uicore
 	void ViewImpl::update_style_cascade() const
 	{
 		std::vector<std::pair<Style *, size_t>> matches;
+		matches.reserve(style_selectors.size());
 
-		for (auto it : styles)
+		for (const auto &selector : style_selectors)
 		{
-			auto &style_list = it.first;
-			auto &style = it.second;
-
-			auto style_classes = Text::split(style_list, " ");
-
-			bool match = true;
-			for (const auto &state : style_classes)
-			{
-				auto search_it = states.find(state);
-				if (search_it == states.end() || !search_it->second.enabled)
-					match = false;
-			}
-
-			if (match)
-				matches.push_back({ style.get(), style_classes.size() });
+			if (states.contains(selector.states))
+				matches.push_back({ selector.style, selector.state_count });
 		}
 
 		std::stable_sort(matches.begin(), matches.end(), [](const std::pair<Style *, size_t> &a, const std::pair<Style *, size_t> &b) { return a.second != b.second ? a.second > b.second : a.first > b.first; });
@@ -1108,35 +1519,49 @@ namespace uicore
 		style_cascade.cascade.clear();
 		for (auto &match : matches)
 			style_cascade.cascade.push_back(match.first);
+
+		invalidate_computed_values();
 	}
 
-	void ViewImpl::process_event_handler(ViewEventHandler *handler, EventUI *e)
+	void ViewImpl::invalidate_computed_values() const
 	{
-		ActivationChangeEvent *activation_change = dynamic_cast<ActivationChangeEvent*>(e);
-		CloseEvent *close = dynamic_cast<CloseEvent*>(e);
-		ResizeEvent *resize = dynamic_cast<ResizeEvent*>(e);
-		FocusChangeEvent *focus_change = dynamic_cast<FocusChangeEvent*>(e);
-		PointerEvent *pointer = dynamic_cast<PointerEvent*>(e);
-		KeyEvent *key = dynamic_cast<KeyEvent*>(e);
+		// Descendants may have inherited values from this view
+		style_cascade.invalidate_computed_values();
+
+		// Recorded drawing was made using the old values
+		background_display_list.clear();
+		content_display_list.clear();
+		for (View *view = _first_child.get(); view != nullptr; view = view->impl->_next_sibling.get())
+			view->impl->invalidate_computed_values();
+	}
 
-		if (activation_change)
+	void ViewImpl::process_event_handler(ViewEventHandler *handler, EventUI *e)
+	{
+		switch (e->category())
+		{
+		case EventUICategory::activation_change:
 		{
+			ActivationChangeEvent *activation_change = static_cast<ActivationChangeEvent*>(e);
 			switch (activation_change->type())
 			{
 			case ActivationChangeType::activated: handler->activated(activation_change); break;
 			case ActivationChangeType::deactivated: handler->deactivated(activation_change); break;
 			}
+			break;
 		}
-		else if (focus_change)
+		case EventUICategory::focus_change:
 		{
+			FocusChangeEvent *focus_change = static_cast<FocusChangeEvent*>(e);
 			switch (focus_change->type())
 			{
 			case FocusChangeType::gained: handler->focus_gained(focus_change); break;
 			case FocusChangeType::lost: handler->focus_lost(focus_change); break;
 			}
+			break;
 		}
-		else if (pointer)
+		case EventUICategory::pointer:
 		{
+			PointerEvent *pointer = static_cast<PointerEvent*>(e);
 			switch (pointer->type())
 			{
 			case PointerEventType::enter: handler->pointer_enter(pointer); break;
@@ -1148,15 +1573,23 @@ namespace uicore
 			case PointerEventType::promixity_change: handler->pointer_proximity_change(pointer); break;
 			case PointerEventType::none: break;
 			}
+			break;
 		}
-		else if (key)
+		case EventUICategory::key:
 		{
+			KeyEvent *key = static_cast<KeyEvent*>(e);
 			switch (key->type())
 			{
 			case KeyEventType::none: break;
 			case KeyEventType::press: handler->key_press(key); break;
 			case KeyEventType::release: handler->key_release(key); break;
 			}
+			break;
+		}
+		case EventUICategory::close:
+		case EventUICategory::resize:
+		case EventUICategory::none:
+			break;
 		}
 	}
 
@@ -1186,22 +1619,6 @@ namespace uicore
 			process_event_handler(self, e);
 	}
 
-	void ViewImpl::inverse_bubble(EventUI *e, const View *until_parent_view)
-	{
-		if (_parent && _parent != until_parent_view)
-		{
-			std::shared_ptr<View> super = _parent->shared_from_this();
-			super->impl->inverse_bubble(e, until_parent_view);
-			if (!e->propagation_stopped())
-			{
-				e->_phase = EventUIPhase::capturing;
-				e->_current_target = super;
-				if (e->_current_target)
-					e->_current_target->impl->process_event(e->_current_target.get(), e, true);
-			}
-		}
-	}
-
 	unsigned int ViewImpl::find_next_tab_index(unsigned int start_index) const
 	{
 		unsigned int next_index = tab_index > start_index ? tab_index : 0;
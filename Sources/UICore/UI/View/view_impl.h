@@ -35,20 +35,84 @@
 #include "../Animation/animation_group.h"
 #include "view_layout.h"
 #include "flex_layout.h"
+#include "UICore/Display/2D/display_list.h"
 #include <map>
+#include <cstdint>
 
 namespace uicore
 {
 	class ViewLayout;
 
+	/// Layout values for the most recently used widths
+	///
+	/// The capacity is fixed so that memory stays flat while a window is resized. The least recently used width is replaced when full.
+	class ViewLayoutWidthCache
+	{
+	public:
+		bool find(float width, float &out_value)
+		{
+			for (int i = 0; i < count; i++)
+			{
+				if (widths[i] == width)
+				{
+					last_used[i] = ++use_counter;
+					out_value = values[i];
+					hits++;
+					return true;
+				}
+			}
+			misses++;
+			return false;
+		}
+
+		void insert(float width, float value)
+		{
+			int index = count;
+			if (count < capacity)
+			{
+				count++;
+			}
+			else
+			{
+				index = 0;
+				for (int i = 1; i < capacity; i++)
+				{
+					if (last_used[i] < last_used[index])
+						index = i;
+				}
+			}
+
+			widths[index] = width;
+			values[index] = value;
+			last_used[index] = ++use_counter;
+		}
+
+		void clear()
+		{
+			count = 0;
+		}
+
+		/// Lookups that found or did not find a cached value, counted for all views
+		static unsigned int hits;
+		static unsigned int misses;
+
+	private:
+		enum { capacity = 4 };
+		float widths[capacity];
+		float values[capacity];
+		unsigned int last_used[capacity];
+		unsigned int use_counter = 0;
+		int count = 0;
+	};
+
 	class ViewLayoutCache
 	{
 	public:
 		bool preferred_width_calculated = false;
 		float preferred_width = 0.0f;
-		std::map<float, float> preferred_height;
-		std::map<float, float> first_baseline_offset;
-		std::map<float, float> last_baseline_offset;
+		ViewLayoutWidthCache preferred_height;
+		ViewLayoutWidthCache first_baseline_offset;
+		ViewLayoutWidthCache last_baseline_offset;
 
 		bool definite_width_calculated = false;
 		bool is_width_definite = false;
@@ -74,15 +138,99 @@ namespace uicore
 		}
 	};
 
+	/// Set of view states, one bit per state name
+	class ViewStateBits
+	{
+	public:
+		bool test(int index) const
+		{
+			if (index < 64)
+				return (bits & (1ULL << index)) != 0;
+			size_t word = (index - 64) / 64;
+			return word < overflow.size() && (overflow[word] & (1ULL << (index % 64))) != 0;
+		}
+
+		void set(int index, bool value);
+
+		/// True if all states in subset are also in this set
+		bool contains(const ViewStateBits &subset) const;
+
+		/// Bit index for a state name, assigning a new one if the name has not been seen before
+		static int index(const std::string &state_name);
+
+		/// Bit index for a state name, or -1 if the name has never been used
+		static int find_index(const std::string &state_name);
+
+	private:
+		uint64_t bits = 0;
+		std::vector<uint64_t> overflow;
+	};
+
+	/// Style selector with its state names converted to bits
+	class ViewStyleSelector
+	{
+	public:
+		Style *style = nullptr;
+		ViewStateBits states;
+		size_t state_count = 0;
+	};
+
+	/// Uniform grid over the border boxes of the children of a view, used for hit testing
+	///
+	/// Each cell lists the children overlapping it in z-order. It is rebuilt on the next hit test after children were
+	/// added, removed or moved.
+	class ViewHitGrid
+	{
+	public:
+		/// Top-most visible child containing the position
+		View *find(const View *container, const Pointf &pos);
+
+		bool dirty = true;
+
+	private:
+		void build(const View *container);
+		bool cell_at(const Pointf &pos, int &column, int &row) const;
+
+		std::vector<View*> children;
+		Rectf bounds;
+		int columns = 0;
+		int rows = 0;
+		float cell_width = 0.0f;
+		float cell_height = 0.0f;
+
+		/// Children of cell i are cell_items[cell_start[i]] to cell_items[cell_start[i + 1] - 1]
+		std::vector<int> cell_start;
+		std::vector<int> cell_items;
+	};
+
+	/// Views an event propagates through, from the target view up to its top-most ancestor
+	///
+	/// The views are kept alive so that capturing can continue if an event handler removes one of them from the tree.
+	class ViewEventPath
+	{
+	public:
+		ViewEventPath(View *target, const View *until_parent_view);
+
+		size_t size() const { return count; }
+		const std::shared_ptr<View> &operator[](size_t index) const { return count <= inline_capacity ? inline_views[index] : overflow[index]; }
+
+	private:
+		static const size_t inline_capacity = 32;
+		std::shared_ptr<View> inline_views[inline_capacity];
+		std::vector<std::shared_ptr<View>> overflow;
+		size_t count = 0;
+	};
+
 	class ViewImpl
 	{
 	public:
 		ViewLayout *active_layout(View *self);
 
-		void render(View *self, const CanvasPtr &canvas);
+		void render(View *self, const CanvasPtr &canvas, bool retained = false);
 		void process_event(View *self, EventUI *e, bool use_capture);
 		void process_event_handler(ViewEventHandler *handler, EventUI *e);
 		void update_style_cascade() const;
+		void invalidate_computed_values() const;
 
 		unsigned int find_next_tab_index(unsigned int tab_index) const;
 		unsigned int find_prev_tab_index(unsigned int tab_index) const;
@@ -90,9 +238,41 @@ namespace uicore
 		View *find_next_with_tab_index(unsigned int tab_index, const ViewImpl *search_from = nullptr, bool also_search_ancestors = true) const;
 		View *find_prev_with_tab_index(unsigned int tab_index, const ViewImpl *search_from = nullptr, bool also_search_ancestors = true) const;
 
-		void set_state_cascade_siblings(const std::string &name, bool value);
+		void set_state_cascade_siblings(int state_index, bool value);
+
+		/// Marks the view as needing layout because the size or content of a child changed
+		void child_needs_layout(View *self);
+
+		/// Area the view renders to in root view coordinates
+		Rectf render_box(View *self);
+
+		/// Area the view renders to in the content coordinates of its parent
+		Rectf local_render_box(View *self) const;
+
+		/// Transform from the content coordinates of the view to root view coordinates
+		static Mat4f content_transform(View *view);
+
+		/// Adds the render box to the damaged area of the view tree
+		void add_damage(View *self);
+
+		/// Adds the area covered by all descendants to the damaged area of the view tree
+		void add_children_damage(View *self);
+		static void add_subtree_box(View *view, const Mat4f &parent_transform, Rectf &box);
+
+		/// Test if two geometries only differ by position
+		static bool is_same_size(const ViewGeometry &a, const ViewGeometry &b);
 
-		void inverse_bubble(EventUI *e, const View *until_parent_view);
+		/// Test if changes inside the view can not affect the layout of its ancestors
+		static bool is_layout_boundary(View *self);
+
+		/// Lays out the view and all its descendants
+		static void layout_subtree(View *self, const CanvasPtr &canvas, int &view_count, int &subtree_count);
+
+		/// Lays out the subtrees below the view that need layout
+		static void layout_dirty_descendants(View *self, const CanvasPtr &canvas, int &view_count, int &subtree_count);
+
+		/// Dispatches an event to the target view and, unless no_propagation is set, its ancestors below until_parent_view
+		static void dispatch_event(View *target, EventUI *e, const View *until_parent_view, bool no_propagation);
 
 		View *_parent = nullptr;
 		std::shared_ptr<View> _first_child, _last_child;
@@ -122,27 +302,29 @@ namespace uicore
 
 		mutable StyleCascade style_cascade;
 		mutable std::map<std::string, std::shared_ptr<Style>> styles;
+		mutable std::vector<ViewStyleSelector> style_selectors;
 
-		struct StyleState
-		{
-			StyleState(){}
-			StyleState(bool is_inherited, bool is_enabled) : inherited(is_inherited), enabled(is_enabled){}
-			bool inherited = true;	// Set to true by set_state_cascade(), else false
-			bool enabled = false;
-		};
+		/// Enabled states
+		ViewStateBits states;
 
-		std::map<std::string, StyleState> states;
+		/// States set on this view itself. Other states are inherited from set_state_cascade() on an ancestor.
+		ViewStateBits explicit_states;
 		
 		ViewGeometry _geometry;
 		bool hidden = false;
 
 		Mat4f view_transform = Mat4f::identity();
+		Mat4f inverse_view_transform = Mat4f::identity();
+		bool identity_view_transform = true;
 		bool content_clipped = false;
 
 		bool exception_encountered = false;
 
 		bool needs_layout = true;
 
+		/// Set when a view below a layout boundary in this subtree needs layout
+		bool descendant_needs_layout = false;
+
 		ViewTree *view_tree = nullptr;
 
 		AnimationGroup animation_group;
@@ -155,9 +337,19 @@ namespace uicore
 
 		ViewLayoutCache layout_cache;
 
+		/// Hit test index of the children, used when indexed hit testing is enabled
+		bool indexed_hit_testing = false;
+		ViewHitGrid hit_grid;
+
+		/// Drawing recorded by the last render, used when the view tree has retained rendering enabled
+		mutable DisplayList background_display_list;
+		mutable DisplayList content_display_list;
+		ViewGeometry display_list_geometry;
+
 		FlexLayout flex;
 
 	private:
+		static void clear_needs_layout(View *self, int &view_count);
 		unsigned int find_prev_tab_index_helper(unsigned int tab_index) const;
 	};
 }
@@ -0,0 +1,51 @@
+#include "precomp.h"
+#include "unit_test.h"
+#include "UICore/Core/Xml/block_allocator.h"
+
+using namespace uicore;
+
+UNIT_TEST(block_allocator_large_then_small)
+{
+	BlockAllocator allocator;
+
+	const int large_size = 512 * 1024;
+	char *large = static_cast<char*>(allocator.allocate(large_size));
+	memset(large, 'L', large_size);
+
+	for (int i = 0; i < 1000; i++)
+	{
+		char *small = static_cast<char*>(allocator.allocate(16));
+		memset(small, 'S', 16);
+	}
+
+	char *large2 = static_cast<char*>(allocator.allocate(large_size));
+	memset(large2, 'M', large_size);
+	char *small = static_cast<char*>(allocator.allocate(16));
+	memset(small, 'S', 16);
+
+	bool intact = true;
+	for (int i = 0; i < large_size; i++)
+		intact = intact && large[i] == 'L' && large2[i] == 'M';
+	TEST_CHECK(intact);
+}
+
+UNIT_TEST(block_allocator_first_block_size)
+{
+	BlockAllocator allocator;
+
+	// Just below the dedicated block limit, so it is served from the first block
+	const int size = 256 * 1024;
+	char *first = static_cast<char*>(allocator.allocate(size));
+	memset(first, 'F', size);
+	TEST_CHECK(allocator.memory_usage() <= 1024 * 1024);
+}
+
+UNIT_TEST(json_document_large_string)
+{
+	std::string big(300 * 1024, 'x');
+	auto document = JsonDocument::parse("[\"" + big + "\",\"small\",{\"a\":\"b\"}]");
+	JsonView root = document->root();
+	TEST_CHECK(root.at(0).to_string() == big);
+	TEST_CHECK(root.at(1).to_string() == "small");
+	TEST_CHECK(root.at(2)["a"].to_string() == "b");
+}
@@ -0,0 +1,25 @@
+#include "precomp.h"
+#include "unit_test.h"
+
+using namespace uicore;
+
+UNIT_TEST(json_writer_skips_undefined_values)
+{
+	JsonValue object = JsonValue::object();
+	object.prop("a") = JsonValue::undefined();
+	object.prop("b") = JsonValue::number(1);
+	object.prop("c");
+	TEST_CHECK(object.to_json() == "{\"b\":1}");
+
+	JsonValue array = JsonValue::array();
+	array.items().push_back(JsonValue::undefined());
+	array.items().push_back(JsonValue::string("x"));
+	array.items().push_back(JsonValue::undefined());
+	array.items().push_back(object);
+	TEST_CHECK(array.to_json() == "[\"x\",{\"b\":1}]");
+
+	JsonValue only_undefined = JsonValue::object();
+	only_undefined.prop("a") = JsonValue::undefined();
+	TEST_CHECK(only_undefined.to_json() == "{}");
+	TEST_CHECK(JsonValue::parse(array.to_json()).items().size() == 2);
+}
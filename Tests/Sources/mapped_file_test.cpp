@@ -0,0 +1,36 @@
+#include "precomp.h"
+#include "unit_test.h"
+
+using namespace uicore;
+
+UNIT_TEST(mapped_file_views_are_independent)
+{
+	std::string filename = "mapped_file_test.tmp";
+	std::string contents(300 * 1024, 'a');
+	contents[0] = 'b';
+	contents[200 * 1024] = 'c';
+	File::write_all_text(filename, contents);
+
+	{
+		auto file = MappedFile::open(filename);
+		auto first = file->buffer();
+		auto second = file->view(200 * 1024, 100 * 1024);
+		auto small = file->view(0, 16);
+
+		// Writes to one view must not show up in the file, the other views or the device reads
+		first->data()[0] = 'x';
+		first->data()[200 * 1024] = 'y';
+		small->data()[1] = 'z';
+		TEST_CHECK(second->data()[0] == 'c');
+		TEST_CHECK(file->data()[0] == 'b');
+		TEST_CHECK(small->data()[0] == 'b');
+		TEST_CHECK(file->read_uint8() == 'b');
+		TEST_CHECK(file->buffer()->data()[200 * 1024] == 'c');
+
+		second->set_size(second->size() + 1);
+		TEST_CHECK(second->data()[0] == 'c');
+	}
+
+	TEST_CHECK(File::read_all_text(filename) == contents);
+	File::remove(filename);
+}
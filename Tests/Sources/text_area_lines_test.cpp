@@ -0,0 +1,49 @@
+#include "precomp.h"
+#include "unit_test.h"
+#include "UICore/UI/StandardViews/TextAreaView/text_area_view_impl.h"
+
+using namespace uicore;
+
+static std::string joined(const TextAreaLines &lines)
+{
+	std::string text;
+	for (size_t i = 0; i < lines.size(); i++)
+		text += "[" + lines[i] + "]";
+	return text;
+}
+
+UNIT_TEST(text_area_lines_erase_after_assign)
+{
+	TextAreaLines lines;
+	lines.assign({ "line0", "line1", "line2", "line3" });
+	lines.erase(1, 2);
+	TEST_CHECK(joined(lines) == "[line0][line2][line3]");
+	lines.erase(0, 1);
+	TEST_CHECK(joined(lines) == "[line2][line3]");
+}
+
+UNIT_TEST(text_area_lines_insert_after_assign)
+{
+	TextAreaLines lines;
+	lines.assign({ "line0", "line1", "line2" });
+	lines.insert(1, "new");
+	TEST_CHECK(joined(lines) == "[line0][new][line1][line2]");
+	lines.insert(4, "end");
+	lines.insert(0, "start");
+	TEST_CHECK(joined(lines) == "[start][line0][new][line1][line2][end]");
+}
+
+UNIT_TEST(text_area_lines_mixed_edits)
+{
+	TextAreaLines lines;
+	lines.assign({ "a", "b", "c", "d", "e" });
+	lines.erase(3, 5);
+	lines.insert(1, "x");
+	lines.erase(0, 1);
+	lines.insert(3, "y");
+	lines.edit(0) += "!";
+	TEST_CHECK(joined(lines) == "[x!][b][c][y]");
+	lines.assign({ "p", "q" });
+	lines.erase(0, 1);
+	TEST_CHECK(joined(lines) == "[q]");
+}
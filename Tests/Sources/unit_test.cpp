@@ -0,0 +1,41 @@
+#include "precomp.h"
+#include "unit_test.h"
+#include <cstdio>
+
+using namespace uicore;
+
+UnitTest::UnitTest(const char *name, void(*func)()) : name(name), func(func)
+{
+	tests().push_back(this);
+}
+
+int UnitTest::run_all()
+{
+	int failed = 0;
+	for (UnitTest *test : tests())
+	{
+		try
+		{
+			test->func();
+		}
+		catch (const Exception &e)
+		{
+			printf("%s failed: %s\n", test->name, e.message.c_str());
+			failed++;
+		}
+	}
+	printf("%d of %d tests passed\n", (int)tests().size() - failed, (int)tests().size());
+	return failed;
+}
+
+void UnitTest::check(bool condition, const char *expression, const char *file, int line)
+{
+	if (!condition)
+		throw Exception(string_format("%1 (%2 line %3)", expression, file, line));
+}
+
+std::vector<UnitTest *> &UnitTest::tests()
+{
+	static std::vector<UnitTest *> list;
+	return list;
+}
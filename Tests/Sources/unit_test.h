@@ -0,0 +1,22 @@
+#pragma once
+
+/// Self-checking test, run by UnitTest::run_all from the UnitTest console program
+class UnitTest
+{
+public:
+	UnitTest(const char *name, void(*func)());
+
+	/// Runs all registered tests and prints each failure. Returns the number of failed tests
+	static int run_all();
+
+	static void check(bool condition, const char *expression, const char *file, int line);
+
+private:
+	const char *name;
+	void(*func)();
+
+	static std::vector<UnitTest *> &tests();
+};
+
+#define UNIT_TEST(name) static void name(); static UnitTest name##_registration(#name, &name); static void name()
+#define TEST_CHECK(expression) UnitTest::check((expression), #expression, __FILE__, __LINE__)
@@ -0,0 +1,7 @@
+#include "precomp.h"
+#include "unit_test.h"
+
+int main()
+{
+	return UnitTest::run_all() == 0 ? 0 : 1;
+}
@@ -0,0 +1,20 @@
+#include "precomp.h"
+#include "unit_test.h"
+
+using namespace uicore;
+
+UNIT_TEST(xml_document_large_values)
+{
+	std::string big_attribute(300 * 1024, 'a');
+	std::string big_text(400 * 1024, 't');
+	std::string xml = "<root big=\"" + big_attribute + "\" small=\"value\"><item>" + big_text + "</item><item>short</item></root>";
+
+	auto document = XmlDocument::load(MemoryDevice::open(DataBuffer::create(xml.data(), xml.size())));
+	XmlNodePtr root = document->document_element();
+	TEST_CHECK(root->attribute("big") == big_attribute);
+	TEST_CHECK(root->attribute("small") == "value");
+
+	XmlNodePtr item = root->first_child();
+	TEST_CHECK(item->text() == big_text);
+	TEST_CHECK(item->next_sibling()->text() == "short");
+}